@@ -1,7 +1,6 @@
 #include "EventEvaluatorEIC.h"
 
 #include "g4eval/CaloEvalStack.h"
-#include "g4eval/CaloRawClusterEval.h"
 #include "g4eval/CaloRawTowerEval.h"
 #include "g4eval/CaloTruthEval.h"
 
@@ -47,36 +46,51 @@
 #include <phool/getClass.h>
 #include <phool/phool.h>
 
+#ifdef HAVE_RNTUPLE
+#include <ROOT/RNTuple.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#endif
+
+#include <TBranch.h>
 #include <TFile.h>
+#include <TLeaf.h>
 #include <TNtuple.h>
+#include <TROOT.h>
 #include <TTree.h>
 
 #include <CLHEP/Vector/ThreeVector.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <set>
+#include <type_traits>
 #include <utility>
 // #include <fstream>
 
 using namespace std;
 
+#ifdef HAVE_RNTUPLE
+namespace
+{
+  //! RNTuple field for a scalar event tree branch, the returned function copies the branch value to it
+  template <typename T>
+  std::function<void()> makeNtupleValue(ROOT::Experimental::RNTupleModel& model, const std::string& name, const char* address)
+  {
+    std::shared_ptr<T> value = model.MakeField<T>(name);
+    return [value, address]() { std::memcpy(value.get(), address, sizeof(T)); };
+  }
+}  // namespace
+#endif
+
 EventEvaluatorEIC::EventEvaluatorEIC(const string& name, const string& filename)
   : SubsysReco(name)
   , _do_store_event_info(false)
-  , _do_FHCAL(false)
-  , _do_BECAL(false)
-  , _do_HCALIN(false)
-  , _do_HCALOUT(false)
-  , _do_EHCAL(false)
-  , _do_FEMC(false)
-  , _do_CEMC(false)
-  , _do_EEMC(false)
-  , _do_EEMCG(false)
-  , _do_DRCALO(false)
-  , _do_FOCAL(false)
-  , _do_LFHCAL(false)
   , _do_HITS(false)
   , _do_HITS_ABSORBER(false)
   , _do_HITS_CALO(false)
@@ -93,151 +107,6 @@ EventEvaluatorEIC::EventEvaluatorEIC(const string& name, const string& filename)
   , _event_weight(0)
   , _n_generator_accepted(0)
   , _nHitsLayers(0)
-  , _hits_layerID(0)
-  , _hits_trueID(0)
-  , _hits_x(0)
-  , _hits_y(0)
-  , _hits_z(0)
-  , _hits_x2(0)
-  , _hits_y2(0)
-  , _hits_z2(0)
-  , _hits_t(0)
-  , _hits_edep(0)
-  , _hits_lightyield(0)
-  , _hits_isAbsorber(0)
-
-  , _nTowers_FHCAL(0)
-  , _tower_FHCAL_E(0)
-  , _tower_FHCAL_iEta(0)
-  , _tower_FHCAL_iPhi(0)
-  , _tower_FHCAL_trueID(0)
-
-  , _nTowers_BECAL(0)
-  , _tower_BECAL_E(0)
-  , _tower_BECAL_iEta(0)
-  , _tower_BECAL_iPhi(0)
-  , _tower_BECAL_trueID(0)
-
-  , _nTowers_HCALIN(0)
-  , _tower_HCALIN_E(0)
-  , _tower_HCALIN_iEta(0)
-  , _tower_HCALIN_iPhi(0)
-  , _tower_HCALIN_trueID(0)
-
-  , _nTowers_HCALOUT(0)
-  , _tower_HCALOUT_E(0)
-  , _tower_HCALOUT_iEta(0)
-  , _tower_HCALOUT_iPhi(0)
-  , _tower_HCALOUT_trueID(0)
-
-  , _nTowers_EHCAL(0)
-  , _tower_EHCAL_E(0)
-  , _tower_EHCAL_iEta(0)
-  , _tower_EHCAL_iPhi(0)
-  , _tower_EHCAL_trueID(0)
-
-  , _nTowers_DRCALO(0)
-  , _tower_DRCALO_E(0)
-  , _tower_DRCALO_NScint(0)
-  , _tower_DRCALO_NCerenkov(0)
-  , _tower_DRCALO_iEta(0)
-  , _tower_DRCALO_iPhi(0)
-  , _tower_DRCALO_trueID(0)
-
-  , _nTowers_FOCAL(0)
-  , _tower_FOCAL_E(0)
-  , _tower_FOCAL_NScint(0)
-  , _tower_FOCAL_NCerenkov(0)
-  , _tower_FOCAL_iEta(0)
-  , _tower_FOCAL_iPhi(0)
-  , _tower_FOCAL_trueID(0)
-
-  , _nTowers_LFHCAL(0)
-  , _tower_LFHCAL_E(0)
-  , _tower_LFHCAL_iEta(0)
-  , _tower_LFHCAL_iPhi(0)
-  , _tower_LFHCAL_iL(0)
-  , _tower_LFHCAL_trueID(0)
-
-  , _nTowers_FEMC(0)
-  , _tower_FEMC_E(0)
-  , _tower_FEMC_iEta(0)
-  , _tower_FEMC_iPhi(0)
-  , _tower_FEMC_trueID(0)
-
-  , _nTowers_EEMC(0)
-  , _tower_EEMC_E(0)
-  , _tower_EEMC_iEta(0)
-  , _tower_EEMC_iPhi(0)
-  , _tower_EEMC_trueID(0)
-
-  , _nTowers_EEMCG(0)
-  , _tower_EEMCG_E(0)
-  , _tower_EEMCG_iEta(0)
-  , _tower_EEMCG_iPhi(0)
-  , _tower_EEMCG_trueID(0)
-
-  , _nTowers_CEMC(0)
-  , _tower_CEMC_E(0)
-  , _tower_CEMC_iEta(0)
-  , _tower_CEMC_iPhi(0)
-  , _tower_CEMC_trueID(0)
-
-  , _nclusters_FHCAL(0)
-  , _cluster_FHCAL_E(0)
-  , _cluster_FHCAL_Eta(0)
-  , _cluster_FHCAL_Phi(0)
-  , _cluster_FHCAL_NTower(0)
-  , _cluster_FHCAL_trueID(0)
-
-  , _nclusters_HCALIN(0)
-  , _cluster_HCALIN_E(0)
-  , _cluster_HCALIN_Eta(0)
-  , _cluster_HCALIN_Phi(0)
-  , _cluster_HCALIN_NTower(0)
-  , _cluster_HCALIN_trueID(0)
-
-  , _nclusters_HCALOUT(0)
-  , _cluster_HCALOUT_E(0)
-  , _cluster_HCALOUT_Eta(0)
-  , _cluster_HCALOUT_Phi(0)
-  , _cluster_HCALOUT_NTower(0)
-  , _cluster_HCALOUT_trueID(0)
-
-  , _nclusters_EHCAL(0)
-  , _cluster_EHCAL_E(0)
-  , _cluster_EHCAL_Eta(0)
-  , _cluster_EHCAL_Phi(0)
-  , _cluster_EHCAL_NTower(0)
-  , _cluster_EHCAL_trueID(0)
-
-  , _nclusters_FEMC(0)
-  , _cluster_FEMC_E(0)
-  , _cluster_FEMC_Eta(0)
-  , _cluster_FEMC_Phi(0)
-  , _cluster_FEMC_NTower(0)
-  , _cluster_FEMC_trueID(0)
-
-  , _nclusters_CEMC(0)
-  , _cluster_CEMC_E(0)
-  , _cluster_CEMC_Eta(0)
-  , _cluster_CEMC_Phi(0)
-  , _cluster_CEMC_NTower(0)
-  , _cluster_CEMC_trueID(0)
-
-  , _nclusters_EEMC(0)
-  , _cluster_EEMC_E(0)
-  , _cluster_EEMC_Eta(0)
-  , _cluster_EEMC_Phi(0)
-  , _cluster_EEMC_NTower(0)
-  , _cluster_EEMC_trueID(0)
-
-  , _nclusters_EEMCG(0)
-  , _cluster_EEMCG_E(0)
-  , _cluster_EEMCG_Eta(0)
-  , _cluster_EEMCG_Phi(0)
-  , _cluster_EEMCG_NTower(0)
-  , _cluster_EEMCG_trueID(0)
 
   , _vertex_x(0)
   , _vertex_y(0)
@@ -248,47 +117,9 @@ EventEvaluatorEIC::EventEvaluatorEIC(const string& name, const string& filename)
   , _vertex_true_z(0)
 
   , _nTracks(0)
-  , _track_ID(0)
-  , _track_charge(0)
-  , _track_px(0)
-  , _track_py(0)
-  , _track_pz(0)
-  , _track_x(0)
-  , _track_y(0)
-  , _track_z(0)
-  , _track_ndf(0)
-  , _track_chi2(0)
-  , _track_dca(0)
-  , _track_dca_2d(0)
-  , _track_trueID(0)
-  , _track_source(0)
   , _nProjections(0)
-  , _track_ProjTrackID(0)
-  , _track_ProjLayer(0)
-  , _track_TLP_x(0)
-  , _track_TLP_y(0)
-  , _track_TLP_z(0)
-  , _track_TLP_t(0)
-  , _track_TLP_px(0)
-  , _track_TLP_py(0)
-  , _track_TLP_pz(0)
-  , _track_TLP_true_x(0)
-  , _track_TLP_true_y(0)
-  , _track_TLP_true_z(0)
-  , _track_TLP_true_t(0)
 
   , _nMCPart(0)
-  , _mcpart_ID(0)
-  , _mcpart_ID_parent(0)
-  , _mcpart_PDG(0)
-  , _mcpart_E(0)
-  , _mcpart_px(0)
-  , _mcpart_py(0)
-  , _mcpart_pz(0)
-  , _mcpart_x(0)
-  , _mcpart_y(0)
-  , _mcpart_z(0)
-  , _mcpart_BCID(0)
 
   , _nHepmcp(0)
   , _hepmcp_procid(0)
@@ -301,43 +132,12 @@ EventEvaluatorEIC::EventEvaluatorEIC(const string& name, const string& filename)
   , _hepmcp_vtx_t(NAN)
 
   //  , _hepmcp_ID_parent(0)
-  , _hepmcp_status(0)
-  , _hepmcp_PDG(0)
-  , _hepmcp_E(0)
-  , _hepmcp_px(0)
-  , _hepmcp_py(0)
-  , _hepmcp_pz(0)
-  , _hepmcp_m1(0)
-  , _hepmcp_m2(0)
-  , _hepmcp_BCID(0)
 
   , _calo_ID(0)
   , _calo_towers_N(0)
-  , _calo_towers_iEta(0)
-  , _calo_towers_iPhi(0)
-  , _calo_towers_iL(0)
-  , _calo_towers_Eta(0)
-  , _calo_towers_Phi(0)
-  , _calo_towers_x(0)
-  , _calo_towers_y(0)
-  , _calo_towers_z(0)
-  , _geometry_done(0)
-
-  , _reco_e_threshold(0)
+
   , _reco_e_thresholdMC(0.001)
   , _depth_MCstack(0)
-  , _caloevalstackFHCAL(nullptr)
-  , _caloevalstackBECAL(nullptr)
-  , _caloevalstackHCALIN(nullptr)
-  , _caloevalstackHCALOUT(nullptr)
-  , _caloevalstackEHCAL(nullptr)
-  , _caloevalstackDRCALO(nullptr)
-  , _caloevalstackFOCAL(nullptr)
-  , _caloevalstackLFHCAL(nullptr)
-  , _caloevalstackFEMC(nullptr)
-  , _caloevalstackCEMC(nullptr)
-  , _caloevalstackEEMC(nullptr)
-  , _caloevalstackEEMCG(nullptr)
   , _strict(false)
   , _event_tree(nullptr)
   , _geometry_tree(nullptr)
@@ -345,471 +145,659 @@ EventEvaluatorEIC::EventEvaluatorEIC(const string& name, const string& filename)
   , _tfile(nullptr)
   , _tfile_geometry(nullptr)
 {
-  _reco_e_threshold = new float[_maxNCalo];
-  _reco_e_threshold[kFHCAL] = 0.05;
-  _reco_e_threshold[kFEMC] = 0.005;
-  _reco_e_threshold[kDRCALO] = 0.0;
-  _reco_e_threshold[kFOCAL] = 0.0;
-  _reco_e_threshold[kEEMC] = 0.005;
-  _reco_e_threshold[kCEMC] = 0.01;
-  _reco_e_threshold[kEHCAL] = 0.05;
-  _reco_e_threshold[kHCALIN] = 0.01;
-  _reco_e_threshold[kHCALOUT] = 0.05;
-  _reco_e_threshold[kLFHCAL] = 0.001;
-  _reco_e_threshold[kEEMCG] = 0.005;
-  _reco_e_threshold[kBECAL] = 0.001;
-
-  _hits_layerID = new int[_maxNHits];
-  _hits_trueID = new int[_maxNHits];
-  _hits_x = new float[_maxNHits];
-  _hits_y = new float[_maxNHits];
-  _hits_z = new float[_maxNHits];
-  _hits_x2 = new float[_maxNHits];
-  _hits_y2 = new float[_maxNHits];
-  _hits_z2 = new float[_maxNHits];
-  _hits_t = new float[_maxNHits];
-  _hits_edep = new float[_maxNHits];
-  _hits_lightyield = new float[_maxNHits];
-  _hits_isAbsorber = new int[_maxNHits];
-
-  _tower_FHCAL_E = new float[_maxNTowers];
-  _tower_FHCAL_iEta = new int[_maxNTowers];
-  _tower_FHCAL_iPhi = new int[_maxNTowers];
-  _tower_FHCAL_trueID = new int[_maxNTowers];
-  _cluster_FHCAL_E = new float[_maxNclusters];
-  _cluster_FHCAL_Eta = new float[_maxNclusters];
-  _cluster_FHCAL_Phi = new float[_maxNclusters];
-  _cluster_FHCAL_NTower = new int[_maxNclusters];
-  _cluster_FHCAL_trueID = new int[_maxNclusters];
-
-  _tower_BECAL_E = new float[_maxNTowers];
-  _tower_BECAL_iEta = new int[_maxNTowers];
-  _tower_BECAL_iPhi = new int[_maxNTowers];
-  _tower_BECAL_trueID = new int[_maxNTowers];
-
-  _tower_HCALIN_E = new float[_maxNTowersCentral];
-  _tower_HCALIN_iEta = new int[_maxNTowersCentral];
-  _tower_HCALIN_iPhi = new int[_maxNTowersCentral];
-  _tower_HCALIN_trueID = new int[_maxNTowersCentral];
-  _cluster_HCALIN_E = new float[_maxNclusters];
-  _cluster_HCALIN_Eta = new float[_maxNclusters];
-  _cluster_HCALIN_Phi = new float[_maxNclusters];
-  _cluster_HCALIN_NTower = new int[_maxNclusters];
-  _cluster_HCALIN_trueID = new int[_maxNclusters];
-
-  _tower_HCALOUT_E = new float[_maxNTowersCentral];
-  _tower_HCALOUT_iEta = new int[_maxNTowersCentral];
-  _tower_HCALOUT_iPhi = new int[_maxNTowersCentral];
-  _tower_HCALOUT_trueID = new int[_maxNTowersCentral];
-  _cluster_HCALOUT_E = new float[_maxNclusters];
-  _cluster_HCALOUT_Eta = new float[_maxNclusters];
-  _cluster_HCALOUT_Phi = new float[_maxNclusters];
-  _cluster_HCALOUT_NTower = new int[_maxNclusters];
-  _cluster_HCALOUT_trueID = new int[_maxNclusters];
-
-  _tower_EHCAL_E = new float[_maxNTowers];
-  _tower_EHCAL_iEta = new int[_maxNTowers];
-  _tower_EHCAL_iPhi = new int[_maxNTowers];
-  _tower_EHCAL_trueID = new int[_maxNTowers];
-  _cluster_EHCAL_E = new float[_maxNclusters];
-  _cluster_EHCAL_Eta = new float[_maxNclusters];
-  _cluster_EHCAL_Phi = new float[_maxNclusters];
-  _cluster_EHCAL_NTower = new int[_maxNclusters];
-  _cluster_EHCAL_trueID = new int[_maxNclusters];
-
-  _tower_DRCALO_E = new float[_maxNTowersDR];
-  _tower_DRCALO_NScint = new int[_maxNTowersDR];
-  _tower_DRCALO_NCerenkov = new int[_maxNTowersDR];
-  _tower_DRCALO_iEta = new int[_maxNTowersDR];
-  _tower_DRCALO_iPhi = new int[_maxNTowersDR];
-  _tower_DRCALO_trueID = new int[_maxNTowersDR];
-
-  _tower_FOCAL_E = new float[_maxNTowersDR];
-  _tower_FOCAL_NScint = new int[_maxNTowersDR];
-  _tower_FOCAL_NCerenkov = new int[_maxNTowersDR];
-  _tower_FOCAL_iEta = new int[_maxNTowersDR];
-  _tower_FOCAL_iPhi = new int[_maxNTowersDR];
-  _tower_FOCAL_trueID = new int[_maxNTowersDR];
-
-  _tower_LFHCAL_E = new float[_maxNTowers];
-  _tower_LFHCAL_iEta = new int[_maxNTowers];
-  _tower_LFHCAL_iPhi = new int[_maxNTowers];
-  _tower_LFHCAL_iL = new int[_maxNTowers];
-  _tower_LFHCAL_trueID = new int[_maxNTowers];
-
-  _tower_FEMC_E = new float[_maxNTowers];
-  _tower_FEMC_iEta = new int[_maxNTowers];
-  _tower_FEMC_iPhi = new int[_maxNTowers];
-  _tower_FEMC_trueID = new int[_maxNTowers];
-  _cluster_FEMC_E = new float[_maxNclusters];
-  _cluster_FEMC_Eta = new float[_maxNclusters];
-  _cluster_FEMC_Phi = new float[_maxNclusters];
-  _cluster_FEMC_NTower = new int[_maxNclusters];
-  _cluster_FEMC_trueID = new int[_maxNclusters];
-
-  _tower_CEMC_E = new float[_maxNTowersCentral];
-  _tower_CEMC_iEta = new int[_maxNTowersCentral];
-  _tower_CEMC_iPhi = new int[_maxNTowersCentral];
-  _tower_CEMC_trueID = new int[_maxNTowersCentral];
-  _cluster_CEMC_E = new float[_maxNclustersCentral];
-  _cluster_CEMC_Eta = new float[_maxNclustersCentral];
-  _cluster_CEMC_Phi = new float[_maxNclustersCentral];
-  _cluster_CEMC_NTower = new int[_maxNclustersCentral];
-  _cluster_CEMC_trueID = new int[_maxNclustersCentral];
-
-  _tower_EEMC_E = new float[_maxNTowers];
-  _tower_EEMC_iEta = new int[_maxNTowers];
-  _tower_EEMC_iPhi = new int[_maxNTowers];
-  _tower_EEMC_trueID = new int[_maxNTowers];
-  _cluster_EEMC_E = new float[_maxNclusters];
-  _cluster_EEMC_Eta = new float[_maxNclusters];
-  _cluster_EEMC_Phi = new float[_maxNclusters];
-  _cluster_EEMC_NTower = new int[_maxNclusters];
-  _cluster_EEMC_trueID = new int[_maxNclusters];
-
-  _tower_EEMCG_E = new float[_maxNTowers];
-  _tower_EEMCG_iEta = new int[_maxNTowers];
-  _tower_EEMCG_iPhi = new int[_maxNTowers];
-  _tower_EEMCG_trueID = new int[_maxNTowers];
-  _cluster_EEMCG_E = new float[_maxNclusters];
-  _cluster_EEMCG_Eta = new float[_maxNclusters];
-  _cluster_EEMCG_Phi = new float[_maxNclusters];
-  _cluster_EEMCG_NTower = new int[_maxNclusters];
-  _cluster_EEMCG_trueID = new int[_maxNclusters];
-
-  _track_ID = new float[_maxNTracks];
-  _track_charge = new short[_maxNTracks];
-  _track_trueID = new float[_maxNTracks];
-  _track_px = new float[_maxNTracks];
-  _track_py = new float[_maxNTracks];
-  _track_pz = new float[_maxNTracks];
-  _track_x = new float[_maxNTracks];
-  _track_y = new float[_maxNTracks];
-  _track_z = new float[_maxNTracks];
-  _track_ndf = new float[_maxNTracks];
-  _track_chi2 = new float[_maxNTracks];
-  _track_dca = new float[_maxNTracks];
-  _track_dca_2d = new float[_maxNTracks];
-  _track_source = new unsigned short[_maxNTracks];
-  _track_ProjTrackID = new float[_maxNProjections];
-  _track_ProjLayer = new int[_maxNProjections];
-  _track_TLP_x = new float[_maxNProjections];
-  _track_TLP_y = new float[_maxNProjections];
-  _track_TLP_z = new float[_maxNProjections];
-  _track_TLP_t = new float[_maxNProjections];
-  _track_TLP_px = new float[_maxNProjections];
-  _track_TLP_py = new float[_maxNProjections];
-  _track_TLP_pz = new float[_maxNProjections];
-  _track_TLP_true_x = new float[_maxNProjections];
-  _track_TLP_true_y = new float[_maxNProjections];
-  _track_TLP_true_z = new float[_maxNProjections];
-  _track_TLP_true_t = new float[_maxNProjections];
-  _track_pion_LL.resize(_maxNTracks, -100);
-  _track_kaon_LL.resize(_maxNTracks, -100);
-  _track_proton_LL.resize(_maxNTracks, -100);
-
-  _mcpart_ID = new int[_maxNMCPart];
-  _mcpart_ID_parent = new int[_maxNMCPart];
-  _mcpart_PDG = new int[_maxNMCPart];
-  _mcpart_E = new float[_maxNMCPart];
-  _mcpart_px = new float[_maxNMCPart];
-  _mcpart_py = new float[_maxNMCPart];
-  _mcpart_pz = new float[_maxNMCPart];
-  _mcpart_x = new float[_maxNMCPart];
-  _mcpart_y = new float[_maxNMCPart];
-  _mcpart_z = new float[_maxNMCPart];
-  _mcpart_BCID = new int[_maxNMCPart];
-
-  _hepmcp_BCID = new int[_maxNHepmcp];
-  //  _hepmcp_ID_parent = new float[_maxNHepmcp];
-  _hepmcp_status = new int[_maxNHepmcp];
-  _hepmcp_PDG = new int[_maxNHepmcp];
-  _hepmcp_E = new float[_maxNHepmcp];
-  _hepmcp_px = new float[_maxNHepmcp];
-  _hepmcp_py = new float[_maxNHepmcp];
-  _hepmcp_pz = new float[_maxNHepmcp];
-  _hepmcp_m1 = new int[_maxNHepmcp];
-  _hepmcp_m2 = new int[_maxNHepmcp];
-
-  _calo_towers_iEta = new int[_maxNTowersCalo];
-  _calo_towers_iPhi = new int[_maxNTowersCalo];
-  _calo_towers_iL = new int[_maxNTowersCalo];
-  _calo_towers_Eta = new float[_maxNTowersCalo];
-  _calo_towers_Phi = new float[_maxNTowersCalo];
-  _calo_towers_x = new float[_maxNTowersCalo];
-  _calo_towers_y = new float[_maxNTowersCalo];
-  _calo_towers_z = new float[_maxNTowersCalo];
-  _geometry_done = new int[20];
-  for (int igem = 0; igem < 20; igem++) _geometry_done[igem] = 0;
+  // the output arrays start small and grow with the events up to these limits
+  _hitArrays = OutputArrays("hits", _maxNHits, "hits");
+  _trackArrays = OutputArrays("tracks", _maxNTracks, "tracks");
+  _projectionArrays = OutputArrays("track projections", _maxNProjections, "projections");
+  _mcpartArrays = OutputArrays("MC particles", _maxNMCPart, "mcpart");
+  _hepmcpArrays = OutputArrays("HepMC particles", _maxNHepmcp, "hepmcp");
+  _geometryArrays = OutputArrays("geometry towers", _maxNTowersCalo);
+
+  // calorimeters in output order: calotype, branch name, node name, reco energy threshold,
+  // most towers and clusters per event and the optional fields
+  _calos = {
+      CaloDescriptor(kFHCAL, "FHCAL", "FHCAL", 0.05, _maxNTowers, _maxNclusters),
+      CaloDescriptor(kBECAL, "BECAL", "BECAL", 0.001, _maxNTowers, 0),
+      CaloDescriptor(kHCALIN, "HCALIN", "HCALIN", 0.01, _maxNTowersCentral, _maxNclusters),
+      CaloDescriptor(kHCALOUT, "HCALOUT", "HCALOUT", 0.05, _maxNTowersCentral, _maxNclusters),
+      CaloDescriptor(kEHCAL, "EHCAL", "EHCAL", 0.05, _maxNTowers, _maxNclusters),
+      CaloDescriptor(kDRCALO, "DRCALO", "DRCALO", 0.0, _maxNTowersDR, 0, kTowerPhotons),
+      CaloDescriptor(kFOCAL, "FOCAL", "FOCAL", 0.0, _maxNTowersDR, 0, kTowerPhotons),
+      CaloDescriptor(kLFHCAL, "LFHCAL", "LFHCAL", 0.001, _maxNTowers, 0, kTowerLayer),
+      CaloDescriptor(kFEMC, "FEMC", "FEMC", 0.005, _maxNTowers, _maxNclusters),
+      CaloDescriptor(kCEMC, "CEMC", "CEMC", 0.01, _maxNTowersCentral, _maxNclustersCentral),
+      CaloDescriptor(kEEMC, "EEMC", "EEMC", 0.005, _maxNTowers, _maxNclusters),
+      CaloDescriptor(kEEMCG, "EEMCG", "EEMC_glass", 0.005, _maxNTowers, _maxNclusters, kClusterEtaVertexOnly),
+  };
+
+  // default projection layers, matched in this order against the track state names,
+  // add_projection_layer puts further layers in front of these
+  _projection_layers = {
+      {"FTTL_0", 0, kHits},
+      {"FTTL_1", 1, kHits},
+      {"FTTL_2", 2, kHits},
+      {"ETTL_0", 3, kHits},
+      {"ETTL_1", 4, kHits},
+      {"LFHCAL", 5, kCaloHits},
+      {"FEMC", 6, kCaloHits},
+      {"CTTL_0", 7, kHits},
+      {"CTTL_1", 8, kHits},
+      {"LBLVTX_CENTRAL_10", 10, kHits},
+      {"LBLVTX_CENTRAL_11", 11, kHits},
+      {"LBLVTX_CENTRAL_12", 12, kHits},
+      {"LBLVTX_CENTRAL_13", 13, kHits},
+      {"LBLVTX_CENTRAL_14", 14, kHits},
+      {"LBLVTX_CENTRAL_15", 15, kHits},
+      {"LBLVTX_FORWARD_20", 20, kHits},
+      {"LBLVTX_FORWARD_21", 21, kHits},
+      {"LBLVTX_FORWARD_22", 22, kHits},
+      {"LBLVTX_FORWARD_23", 23, kHits},
+      {"LBLVTX_FORWARD_24", 24, kHits},
+      {"LBLVTX_BACKWARD_30", 30, kHits},
+      {"LBLVTX_BACKWARD_31", 31, kHits},
+      {"LBLVTX_BACKWARD_32", 32, kHits},
+      {"LBLVTX_BACKWARD_33", 33, kHits},
+      {"LBLVTX_BACKWARD_34", 34, kHits},
+      {"BARREL_0", 40, kHits},
+      {"BARREL_1", 41, kHits},
+      {"BARREL_2", 42, kHits},
+      {"BARREL_3", 43, kHits},
+      {"BARREL_4", 44, kHits},
+      {"BARREL_5", 45, kHits},
+      {"EFST_0", 100, kHits},
+      {"EFST_1", 101, kHits},
+      {"EFST_2", 102, kHits},
+      {"EFST_3", 103, kHits},
+      {"EFST_4", 104, kHits},
+      {"EFST_5", 105, kHits},
+      {"EFST_6", 106, kNoHits},
+      {"FST_0", 50, kHits},
+      {"FST_1", 51, kHits},
+      {"FST_2", 52, kHits},
+      {"FST_3", 53, kHits},
+      {"FST_4", 54, kHits},
+      {"FST_5", 55, kHits},
+      {"FST_6", 56, kHits},
+      {"EHCAL", 60, kCaloHits},
+      {"EEMC", 61, kCaloHits},
+      {"HCALIN", 62, kCaloHits},
+      {"HCALOUT", 63, kCaloHits},
+      {"CEMC", 64, kNoHits},
+      {"EEMC_glass", 65, kCaloHits},
+      {"BECAL", 66, kCaloHits},
+      {"ZDCsurrogate", 70, kHits},
+      {"rpTruth", 71, kHits},
+      {"b0Truth", 72, kHits},
+      {"rpTruth2", 73, kHits},
+      {"offMomTruth", 74, kHits},
+      {"BH_1", 90, kBlackHoleHits},
+      {"BH_FORWARD_PLUS", 91, kBlackHoleHits},
+      {"BH_FORWARD_NEG", 92, kBlackHoleHits},
+      {"RWELL_0", 110, kHits},
+      {"RWELL_1", 111, kHits},
+      {"RWELL_2", 112, kHits},
+      {"EST_0", 113, kNoHits},
+      {"EST_1", 114, kNoHits},
+      {"EST_2", 115, kNoHits},
+      {"EST_3", 116, kNoHits},
+      {"EST_4", 117, kNoHits},
+      {"EST_5", 118, kNoHits},
+      {"EST_6", 119, kNoHits},
+      {"FGEM_0", 120, kHits},
+      {"FGEM_1", 121, kHits},
+      {"EGEM_0", 130, kHits},
+      {"EGEM_1", 131, kHits},
+      {"LFHCAL_0", 140, kCaloHits},
+      {"LFHCAL_1", 141, kCaloHits},
+      {"LFHCAL_2", 142, kCaloHits},
+      {"LFHCAL_3", 143, kCaloHits},
+      {"LFHCAL_4", 144, kCaloHits},
+      {"LFHCAL_5", 145, kCaloHits},
+      {"LFHCAL_6", 146, kCaloHits},
+      {"LFHCAL_7", 147, kCaloHits},
+      {"BARR_0", 150, kHits},
+      {"BARR_1", 151, kHits},
+      {"BARR_2", 152, kHits},
+      {"BARR_3", 153, kHits},
+      {"BARR_4", 154, kHits},
+      {"SVTX_0", 155, kNoHits},
+      {"SVTX_1", 156, kNoHits},
+      {"SVTX_2", 157, kNoHits},
+      {"SVTX_3", 158, kNoHits},
+      {"SVTX_4", 159, kNoHits},
+      {"BARR", 160, kHits},
+      {"SVTX", 161, kNoHits},
+  };
 }
 
-int EventEvaluatorEIC::Init(PHCompositeNode* topNode)
+EventEvaluatorEIC::~EventEvaluatorEIC()
 {
-  _ievent = 0;
+  // End was not called, do not leave the writer and fill threads running
+  stopWriter();
+  stopFillWorkers();
+}
 
-  _tfile = new TFile(_filename.c_str(), "RECREATE");
+template <typename T>
+void EventEvaluatorEIC::addOutputArray(OutputArrays& arrays, std::vector<T>& buffer, TTree* tree, const std::string& branchname, const std::string& leaflist, const typename std::vector<T>::value_type init)
+{
+  if (arrays.resize.empty())
+  {
+    arrays.size = std::min(_minNOutput, arrays.maxSize);
+  }
+  buffer.assign(arrays.size, init);
+  if (tree)
+  {
+    tree->Branch(branchname.c_str(), buffer.data(), leaflist.c_str());
+  }
+#ifdef HAVE_RNTUPLE
+  if (tree && tree == _event_tree && !_rntuple_filename.empty())
+  {
+    if (!arrays.counter)
+    {
+      const std::string countername = leaflist.substr(leaflist.find('[') + 1, leaflist.find(']') - leaflist.find('[') - 1);
+      arrays.counter = reinterpret_cast<const int*>(tree->GetBranch(countername.c_str())->GetAddress());
+    }
+    // tower_FHCAL_E becomes E in collection tower_FHCAL, 16 bit types are
+    // stored as int, not all RNTuple versions have 16 bit columns
+    typedef typename std::conditional<(sizeof(T) < sizeof(int)), int, T>::type FieldT;
+    const std::string prefix = arrays.ntupleName + "_";
+    const std::string fieldname = (branchname.compare(0, prefix.size(), prefix) == 0) ? branchname.substr(prefix.size()) : branchname;
+    arrays.fields.push_back([&buffer, fieldname](ROOT::Experimental::RNTupleModel& model) -> std::function<void(int)> {
+      std::shared_ptr<FieldT> value = model.MakeField<FieldT>(fieldname);
+      return [value, &buffer](const int i) { *value = buffer[i]; };
+    });
+  }
+#endif
+  if (tree && tree == _event_tree && _async_depth > 0)
+  {
+    // the writer thread owns the branch addresses, it gets the entries written in this event
+    // (at least one, so that the branch never points to an empty record)
+    _output_branches.push_back(OutputBranch{tree->GetBranch(branchname.c_str()), [&buffer, &arrays]() {
+                                              return std::make_pair(reinterpret_cast<const char*>(buffer.data()), std::max(arrays.used, 1) * sizeof(T));
+                                            }});
+    tree = nullptr;
+  }
+  // the branch has to follow the buffer when it is reallocated
+  arrays.resize.push_back([&buffer, tree, branchname, init](const int n) {
+    buffer.resize(n, init);
+    if (tree)
+    {
+      tree->GetBranch(branchname.c_str())->SetAddress(buffer.data());
+    }
+  });
+}
 
-  _event_tree = new TTree("event_tree", "event_tree");
-  if (_do_store_event_info)
+bool EventEvaluatorEIC::growOutputArrays(OutputArrays& arrays, const int n)
+{
+  if (n >= arrays.size)
   {
-    // Event level info. This isn't the most efficient way to store this info, but it's straightforward
-    // within the structure of the class, so the size is small compared to the rest of the output.
-    _event_tree->Branch("cross_section", &_cross_section, "cross_section/F");
-    _event_tree->Branch("event_weight", &_event_weight, "event_weight/F");
-    _event_tree->Branch("n_generator_accepted", &_n_generator_accepted, "n_generator_accepted/I");
+    // the arrays belong to one fill task, but the branches are in one tree and the report goes to one stream
+    std::lock_guard<std::mutex> lock(_output_mutex);
+    if (n >= arrays.maxSize)
+    {
+      // report once per event, the caller stops filling these arrays
+      if (arrays.lastOverflowEvent != (int) _ievent)
+      {
+        cout << PHWHERE << " ERROR: more than " << arrays.maxSize << " " << arrays.name
+             << " in event " << _ievent << ", the remaining ones are not saved" << endl;
+        arrays.lastOverflowEvent = _ievent;
+        arrays.nOverflowEvents++;
+      }
+      return false;
+    }
+    const int size = std::min(std::max(n + 1, 2 * arrays.size), arrays.maxSize);
+    for (auto& resize : arrays.resize)
+    {
+      resize(size);
+    }
+    arrays.size = size;
   }
-  // tracks and hits
-  if (_do_HITS)
+  // resetBuffer only has to clean up to here
+  if (n >= arrays.used)
   {
-    _event_tree->Branch("nHits", &_nHitsLayers, "nHits/I");
-    _event_tree->Branch("hits_layerID", _hits_layerID, "hits_layerID[nHits]/I");
-    _event_tree->Branch("hits_trueID", _hits_trueID, "hits_trueID[nHits]/I");
-    _event_tree->Branch("hits_x", _hits_x, "hits_x[nHits]/F");
-    _event_tree->Branch("hits_y", _hits_y, "hits_y[nHits]/F");
-    _event_tree->Branch("hits_z", _hits_z, "hits_z[nHits]/F");
-    _event_tree->Branch("hits_x2", _hits_x2, "hits_x2[nHits]/F");
-    _event_tree->Branch("hits_y2", _hits_y2, "hits_y2[nHits]/F");
-    _event_tree->Branch("hits_z2", _hits_z2, "hits_z2[nHits]/F");
-    _event_tree->Branch("hits_t", _hits_t, "hits_t[nHits]/F");
-    _event_tree->Branch("hits_edep", _hits_edep, "hits_edep[nHits]/F");
-    _event_tree->Branch("hits_lightyield", _hits_lightyield, "hits_lightyield[nHits]/F");
-    _event_tree->Branch("hits_isAbsorber", _hits_isAbsorber, "hits_isAbsorber[nHits]/I");
+    arrays.used = n + 1;
   }
+  return true;
+}
 
-  if (_do_TRACKS)
+void EventEvaluatorEIC::startWriter()
+{
+  // the scalar branches are copied from the addresses they were created with
+  std::set<TBranch*> arrayBranches;
+  for (const auto& outputBranch : _output_branches)
   {
-    _event_tree->Branch("nTracks", &_nTracks, "nTracks/I");
-    _event_tree->Branch("tracks_ID", _track_ID, "tracks_ID[nTracks]/F");
-    _event_tree->Branch("tracks_charge", _track_charge, "tracks_charge[nTracks]/S");
-    _event_tree->Branch("tracks_px", _track_px, "tracks_px[nTracks]/F");
-    _event_tree->Branch("tracks_py", _track_py, "tracks_py[nTracks]/F");
-    _event_tree->Branch("tracks_pz", _track_pz, "tracks_pz[nTracks]/F");
-    _event_tree->Branch("tracks_x", _track_x, "tracks_x[nTracks]/F");
-    _event_tree->Branch("tracks_y", _track_y, "tracks_y[nTracks]/F");
-    _event_tree->Branch("tracks_z", _track_z, "tracks_z[nTracks]/F");
-    _event_tree->Branch("tracks_ndf", _track_ndf, "tracks_ndf[nTracks]/F");
-    _event_tree->Branch("tracks_chi2", _track_chi2, "tracks_chi2[nTracks]/F");
-    _event_tree->Branch("tracks_dca", _track_dca, "tracks_dca[nTracks]/F");
-    _event_tree->Branch("tracks_dca_2d", _track_dca_2d, "tracks_dca_2d[nTracks]/F");
-    _event_tree->Branch("tracks_trueID", _track_trueID, "tracks_trueID[nTracks]/F");
-    _event_tree->Branch("tracks_source", _track_source, "tracks_source[nTracks]/s");
-
-    if (_do_PID_LogLikelihood)
+    arrayBranches.insert(outputBranch.branch);
+  }
+  TIter nextBranch(_event_tree->GetListOfBranches());
+  while (TBranch* branch = static_cast<TBranch*>(nextBranch()))
+  {
+    if (arrayBranches.count(branch))
+    {
+      continue;
+    }
+    const char* address = branch->GetAddress();
+    size_t bytes = 0;
+    TIter nextLeaf(branch->GetListOfLeaves());
+    while (TLeaf* leaf = static_cast<TLeaf*>(nextLeaf()))
     {
-      // save hadron PID log likelihood
-      _event_tree->Branch("track_pion_LL", _track_pion_LL.data(), "track_pion_LL[nTracks]/F");
-      _event_tree->Branch("track_kaon_LL", _track_kaon_LL.data(), "track_kaon_LL[nTracks]/F");
-      _event_tree->Branch("track_proton_LL", _track_proton_LL.data(), "track_proton_LL[nTracks]/F");
+      bytes += leaf->GetLenType() * leaf->GetLenStatic();
     }
+    _output_branches.push_back(OutputBranch{branch, [address, bytes]() { return std::make_pair(address, bytes); }});
   }
-  if (_do_PROJECTIONS)
+
+  _records.assign(_async_depth, EventRecord(_output_branches.size()));
+  _free_records.clear();
+  for (auto& record : _records)
   {
-    _event_tree->Branch("nProjections", &_nProjections, "nProjections/I");
-    _event_tree->Branch("track_ProjTrackID", _track_ProjTrackID, "track_ProjTrackID[nProjections]/F");
-    _event_tree->Branch("track_ProjLayer", _track_ProjLayer, "track_ProjLayer[nProjections]/I");
-    _event_tree->Branch("track_TLP_x", _track_TLP_x, "track_TLP_x[nProjections]/F");
-    _event_tree->Branch("track_TLP_y", _track_TLP_y, "track_TLP_y[nProjections]/F");
-    _event_tree->Branch("track_TLP_z", _track_TLP_z, "track_TLP_z[nProjections]/F");
-    _event_tree->Branch("track_TLP_t", _track_TLP_t, "track_TLP_t[nProjections]/F");
-    _event_tree->Branch("track_TLP_px", _track_TLP_px, "track_TLP_px[nProjections]/F");
-    _event_tree->Branch("track_TLP_py", _track_TLP_py, "track_TLP_py[nProjections]/F");
-    _event_tree->Branch("track_TLP_pz", _track_TLP_pz, "track_TLP_pz[nProjections]/F");
-    _event_tree->Branch("track_TLP_true_x", _track_TLP_true_x, "track_TLP_true_x[nProjections]/F");
-    _event_tree->Branch("track_TLP_true_y", _track_TLP_true_y, "track_TLP_true_y[nProjections]/F");
-    _event_tree->Branch("track_TLP_true_z", _track_TLP_true_z, "track_TLP_true_z[nProjections]/F");
-    _event_tree->Branch("track_TLP_true_t", _track_TLP_true_t, "track_TLP_true_t[nProjections]/F");
+    _free_records.push_back(&record);
   }
-  if (_do_FHCAL)
+  _queued_records.clear();
+  _writer_stop = false;
+
+  // the event tree baskets are written to the output file on the writer thread
+  ROOT::EnableThreadSafety();
+  _writer = std::thread(&EventEvaluatorEIC::writerLoop, this);
+}
+
+void EventEvaluatorEIC::queueEvent()
+{
+  EventRecord* record = nullptr;
   {
-    // towers FHCAL
-    _event_tree->Branch("tower_FHCAL_N", &_nTowers_FHCAL, "tower_FHCAL_N/I");
-    _event_tree->Branch("tower_FHCAL_E", _tower_FHCAL_E, "tower_FHCAL_E[tower_FHCAL_N]/F");
-    _event_tree->Branch("tower_FHCAL_iEta", _tower_FHCAL_iEta, "tower_FHCAL_iEta[tower_FHCAL_N]/I");
-    _event_tree->Branch("tower_FHCAL_iPhi", _tower_FHCAL_iPhi, "tower_FHCAL_iPhi[tower_FHCAL_N]/I");
-    _event_tree->Branch("tower_FHCAL_trueID", _tower_FHCAL_trueID, "tower_FHCAL_trueID[tower_FHCAL_N]/I");
-    if (_do_CLUSTERS)
+    std::unique_lock<std::mutex> lock(_writer_mutex);
+    if (_free_records.empty())
     {
-      // clusters FHCAL
-      _event_tree->Branch("cluster_FHCAL_N", &_nclusters_FHCAL, "cluster_FHCAL_N/I");
-      _event_tree->Branch("cluster_FHCAL_E", _cluster_FHCAL_E, "cluster_FHCAL_E[cluster_FHCAL_N]/F");
-      _event_tree->Branch("cluster_FHCAL_Eta", _cluster_FHCAL_Eta, "cluster_FHCAL_Eta[cluster_FHCAL_N]/F");
-      _event_tree->Branch("cluster_FHCAL_Phi", _cluster_FHCAL_Phi, "cluster_FHCAL_Phi[cluster_FHCAL_N]/F");
-      _event_tree->Branch("cluster_FHCAL_NTower", _cluster_FHCAL_NTower, "cluster_FHCAL_NTower[cluster_FHCAL_N]/I");
-      _event_tree->Branch("cluster_FHCAL_trueID", _cluster_FHCAL_trueID, "cluster_FHCAL_trueID[cluster_FHCAL_N]/I");
+      auto start = std::chrono::steady_clock::now();
+      _cv_free.wait(lock, [this] { return !_free_records.empty(); });
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      _stallTime += elapsed.count();
+      _nStalls++;
     }
+    record = _free_records.back();
+    _free_records.pop_back();
   }
-  if (_do_BECAL)
+
+  // only this thread uses a record between taking it from the free ones and queueing it
+  for (unsigned int iBranch = 0; iBranch < _output_branches.size(); iBranch++)
+  {
+    std::pair<const char*, size_t> data = _output_branches[iBranch].data();
+    (*record)[iBranch].assign(data.first, data.first + data.second);
+  }
+
   {
-    // towers BECAL
-    _event_tree->Branch("tower_BECAL_N", &_nTowers_BECAL, "tower_BECAL_N/I");
-    _event_tree->Branch("tower_BECAL_E", _tower_BECAL_E, "tower_BECAL_E[tower_BECAL_N]/F");
-    _event_tree->Branch("tower_BECAL_iEta", _tower_BECAL_iEta, "tower_BECAL_iEta[tower_BECAL_N]/I");
-    _event_tree->Branch("tower_BECAL_iPhi", _tower_BECAL_iPhi, "tower_BECAL_iPhi[tower_BECAL_N]/I");
-    _event_tree->Branch("tower_BECAL_trueID", _tower_BECAL_trueID, "tower_BECAL_trueID[tower_BECAL_N]/I");
+    std::lock_guard<std::mutex> lock(_writer_mutex);
+    _queued_records.push_back(record);
+    _nQueued++;
+    _maxQueued = std::max(_maxQueued, (unsigned int) _queued_records.size());
+    _sumQueued += _queued_records.size();
   }
-  if (_do_HCALIN)
+  _cv_queued.notify_one();
+}
+
+void EventEvaluatorEIC::writerLoop()
+{
+  while (true)
   {
-    // towers HCAL-in
-    _event_tree->Branch("tower_HCALIN_N", &_nTowers_HCALIN, "tower_HCALIN_N/I");
-    _event_tree->Branch("tower_HCALIN_E", _tower_HCALIN_E, "tower_HCALIN_E[tower_HCALIN_N]/F");
-    _event_tree->Branch("tower_HCALIN_iEta", _tower_HCALIN_iEta, "tower_HCALIN_iEta[tower_HCALIN_N]/I");
-    _event_tree->Branch("tower_HCALIN_iPhi", _tower_HCALIN_iPhi, "tower_HCALIN_iPhi[tower_HCALIN_N]/I");
-    _event_tree->Branch("tower_HCALIN_trueID", _tower_HCALIN_trueID, "tower_HCALIN_trueID[tower_HCALIN_N]/I");
-    if (_do_CLUSTERS)
+    EventRecord* record = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(_writer_mutex);
+      _cv_queued.wait(lock, [this] { return _writer_stop || !_queued_records.empty(); });
+      if (_queued_records.empty())
+      {
+        // stopped and everything is written
+        return;
+      }
+      record = _queued_records.front();
+      _queued_records.pop_front();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int iBranch = 0; iBranch < _output_branches.size(); iBranch++)
     {
-      // clusters HCAL-in
-      _event_tree->Branch("cluster_HCALIN_N", &_nclusters_HCALIN, "cluster_HCALIN_N/I");
-      _event_tree->Branch("cluster_HCALIN_E", _cluster_HCALIN_E, "cluster_HCALIN_E[cluster_HCALIN_N]/F");
-      _event_tree->Branch("cluster_HCALIN_Eta", _cluster_HCALIN_Eta, "cluster_HCALIN_Eta[cluster_HCALIN_N]/F");
-      _event_tree->Branch("cluster_HCALIN_Phi", _cluster_HCALIN_Phi, "cluster_HCALIN_Phi[cluster_HCALIN_N]/F");
-      _event_tree->Branch("cluster_HCALIN_NTower", _cluster_HCALIN_NTower, "cluster_HCALIN_NTower[cluster_HCALIN_N]/I");
-      _event_tree->Branch("cluster_HCALIN_trueID", _cluster_HCALIN_trueID, "cluster_HCALIN_trueID[cluster_HCALIN_N]/I");
+      _output_branches[iBranch].branch->SetAddress((*record)[iBranch].data());
     }
+    _event_tree->Fill();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    _writeTime += elapsed.count();
+
+    {
+      std::lock_guard<std::mutex> lock(_writer_mutex);
+      _free_records.push_back(record);
+    }
+    _cv_free.notify_one();
+  }
+}
+
+void EventEvaluatorEIC::stopWriter()
+{
+  if (!_writer.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_writer_mutex);
+    _writer_stop = true;
+  }
+  _cv_queued.notify_one();
+  _writer.join();
+}
+
+void EventEvaluatorEIC::startFillWorkers()
+{
+  unsigned int nthreads = (_fill_threads > 0) ? _fill_threads : std::thread::hardware_concurrency();
+  if (nthreads <= 1)
+  {
+    return;
+  }
+  // the detector sections fill their output arrays on the workers
+  ROOT::EnableThreadSafety();
+  _fill_stop = false;
+  // the thread calling runFillTasks takes tasks as well
+  for (unsigned int ithread = 1; ithread < nthreads; ithread++)
+  {
+    _fill_workers.emplace_back(&EventEvaluatorEIC::fillWorkerLoop, this);
   }
-  if (_do_HCALOUT)
+}
+
+bool EventEvaluatorEIC::runFillTasks(const std::vector<std::function<bool()>>& tasks)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(_fill_mutex);
+  _fill_tasks = &tasks;
+  _fill_next = 0;
+  _fill_pending = tasks.size();
+  _fill_ok = true;
+  _fill_generation++;
+  if (!_fill_workers.empty())
+  {
+    _cv_fill_start.notify_all();
+  }
+  takeFillTasks(lock);
+  _cv_fill_done.wait(lock, [this] { return _fill_pending == 0; });
+  _fill_tasks = nullptr;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  _fillTime += elapsed.count();
+  _nFilled++;
+  return _fill_ok;
+}
+
+void EventEvaluatorEIC::takeFillTasks(std::unique_lock<std::mutex>& lock)
+{
+  while (_fill_tasks && _fill_next < _fill_tasks->size())
   {
-    // towers HCAL-out
-    _event_tree->Branch("tower_HCALOUT_N", &_nTowers_HCALOUT, "tower_HCALOUT_N/I");
-    _event_tree->Branch("tower_HCALOUT_E", _tower_HCALOUT_E, "tower_HCALOUT_E[tower_HCALOUT_N]/F");
-    _event_tree->Branch("tower_HCALOUT_iEta", _tower_HCALOUT_iEta, "tower_HCALOUT_iEta[tower_HCALOUT_N]/I");
-    _event_tree->Branch("tower_HCALOUT_iPhi", _tower_HCALOUT_iPhi, "tower_HCALOUT_iPhi[tower_HCALOUT_N]/I");
-    _event_tree->Branch("tower_HCALOUT_trueID", _tower_HCALOUT_trueID, "tower_HCALOUT_trueID[tower_HCALOUT_N]/I");
-    if (_do_CLUSTERS)
+    const std::function<bool()>& task = (*_fill_tasks)[_fill_next++];
+    lock.unlock();
+    auto start = std::chrono::steady_clock::now();
+    const bool ok = task();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    lock.lock();
+    _fillTaskTime += elapsed.count();
+    _fill_ok = _fill_ok && ok;
+    if (--_fill_pending == 0)
     {
-      // clusters HCAL-out
-      _event_tree->Branch("cluster_HCALOUT_N", &_nclusters_HCALOUT, "cluster_HCALOUT_N/I");
-      _event_tree->Branch("cluster_HCALOUT_E", _cluster_HCALOUT_E, "cluster_HCALOUT_E[cluster_HCALOUT_N]/F");
-      _event_tree->Branch("cluster_HCALOUT_Eta", _cluster_HCALOUT_Eta, "cluster_HCALOUT_Eta[cluster_HCALOUT_N]/F");
-      _event_tree->Branch("cluster_HCALOUT_Phi", _cluster_HCALOUT_Phi, "cluster_HCALOUT_Phi[cluster_HCALOUT_N]/F");
-      _event_tree->Branch("cluster_HCALOUT_NTower", _cluster_HCALOUT_NTower, "cluster_HCALOUT_NTower[cluster_HCALOUT_N]/I");
-      _event_tree->Branch("cluster_HCALOUT_trueID", _cluster_HCALOUT_trueID, "cluster_HCALOUT_trueID[cluster_HCALOUT_N]/I");
+      _cv_fill_done.notify_one();
     }
   }
-  if (_do_EHCAL)
+}
+
+void EventEvaluatorEIC::fillWorkerLoop()
+{
+  unsigned long generation = 0;
+  std::unique_lock<std::mutex> lock(_fill_mutex);
+  while (true)
   {
-    // towers EHCAL
-    _event_tree->Branch("tower_EHCAL_N", &_nTowers_EHCAL, "tower_EHCAL_N/I");
-    _event_tree->Branch("tower_EHCAL_E", _tower_EHCAL_E, "tower_EHCAL_E[tower_EHCAL_N]/F");
-    _event_tree->Branch("tower_EHCAL_iEta", _tower_EHCAL_iEta, "tower_EHCAL_iEta[tower_EHCAL_N]/I");
-    _event_tree->Branch("tower_EHCAL_iPhi", _tower_EHCAL_iPhi, "tower_EHCAL_iPhi[tower_EHCAL_N]/I");
-    _event_tree->Branch("tower_EHCAL_trueID", _tower_EHCAL_trueID, "tower_EHCAL_trueID[tower_EHCAL_N]/I");
-    if (_do_CLUSTERS)
+    _cv_fill_start.wait(lock, [this, generation] { return _fill_stop || _fill_generation != generation; });
+    if (_fill_stop)
     {
-      // clusters EHCAL
-      _event_tree->Branch("cluster_EHCAL_N", &_nclusters_EHCAL, "cluster_EHCAL_N/I");
-      _event_tree->Branch("cluster_EHCAL_E", _cluster_EHCAL_E, "cluster_EHCAL_E[cluster_EHCAL_N]/F");
-      _event_tree->Branch("cluster_EHCAL_Eta", _cluster_EHCAL_Eta, "cluster_EHCAL_Eta[cluster_EHCAL_N]/F");
-      _event_tree->Branch("cluster_EHCAL_Phi", _cluster_EHCAL_Phi, "cluster_EHCAL_Phi[cluster_EHCAL_N]/F");
-      _event_tree->Branch("cluster_EHCAL_NTower", _cluster_EHCAL_NTower, "cluster_EHCAL_NTower[cluster_EHCAL_N]/I");
-      _event_tree->Branch("cluster_EHCAL_trueID", _cluster_EHCAL_trueID, "cluster_EHCAL_trueID[cluster_EHCAL_N]/I");
+      return;
     }
+    generation = _fill_generation;
+    takeFillTasks(lock);
+  }
+}
+
+void EventEvaluatorEIC::stopFillWorkers()
+{
+  if (_fill_workers.empty())
+  {
+    return;
   }
-  if (_do_DRCALO)
   {
-    // towers DRCALO
-    _event_tree->Branch("tower_DRCALO_N", &_nTowers_DRCALO, "tower_DRCALO_N/I");
-    _event_tree->Branch("tower_DRCALO_E", _tower_DRCALO_E, "tower_DRCALO_E[tower_DRCALO_N]/F");
-    _event_tree->Branch("tower_DRCALO_NScint", _tower_DRCALO_NScint, "tower_DRCALO_NScint[tower_DRCALO_N]/I");
-    _event_tree->Branch("tower_DRCALO_NCerenkov", _tower_DRCALO_NCerenkov, "tower_DRCALO_NCerenkov[tower_DRCALO_N]/I");
-    _event_tree->Branch("tower_DRCALO_iEta", _tower_DRCALO_iEta, "tower_DRCALO_iEta[tower_DRCALO_N]/I");
-    _event_tree->Branch("tower_DRCALO_iPhi", _tower_DRCALO_iPhi, "tower_DRCALO_iPhi[tower_DRCALO_N]/I");
-    _event_tree->Branch("tower_DRCALO_trueID", _tower_DRCALO_trueID, "tower_DRCALO_trueID[tower_DRCALO_N]/I");
+    std::lock_guard<std::mutex> lock(_fill_mutex);
+    _fill_stop = true;
   }
-  if (_do_FOCAL)
+  _cv_fill_start.notify_all();
+  for (auto& worker : _fill_workers)
+  {
+    worker.join();
+  }
+  _fill_workers.clear();
+}
+
+void EventEvaluatorEIC::set_rntuple_output(const std::string& filename)
+{
+#ifdef HAVE_RNTUPLE
+  _rntuple_filename = filename;
+#else
+  cout << PHWHERE << " ERROR: this build has no RNTuple support (configure found no compatible ROOT RNTuple API), "
+       << filename << " is not written" << endl;
+#endif
+}
+
+#ifdef HAVE_RNTUPLE
+void EventEvaluatorEIC::startNtuple()
+{
+  auto model = ROOT::Experimental::RNTupleModel::Create();
+
+  std::vector<OutputArrays*> allArrays = {&_hitArrays, &_trackArrays, &_projectionArrays, &_mcpartArrays, &_hepmcpArrays};
+  for (auto& calo : _calos)
   {
-    // towers FOCAL
-    _event_tree->Branch("tower_FOCAL_N", &_nTowers_FOCAL, "tower_FOCAL_N/I");
-    _event_tree->Branch("tower_FOCAL_E", _tower_FOCAL_E, "tower_FOCAL_E[tower_FOCAL_N]/F");
-    _event_tree->Branch("tower_FOCAL_NScint", _tower_FOCAL_NScint, "tower_FOCAL_NScint[tower_FOCAL_N]/I");
-    _event_tree->Branch("tower_FOCAL_NCerenkov", _tower_FOCAL_NCerenkov, "tower_FOCAL_NCerenkov[tower_FOCAL_N]/I");
-    _event_tree->Branch("tower_FOCAL_iEta", _tower_FOCAL_iEta, "tower_FOCAL_iEta[tower_FOCAL_N]/I");
-    _event_tree->Branch("tower_FOCAL_iPhi", _tower_FOCAL_iPhi, "tower_FOCAL_iPhi[tower_FOCAL_N]/I");
-    _event_tree->Branch("tower_FOCAL_trueID", _tower_FOCAL_trueID, "tower_FOCAL_trueID[tower_FOCAL_N]/I");
+    allArrays.push_back(&calo.towerArrays);
+    allArrays.push_back(&calo.clusterArrays);
   }
-  if (_do_LFHCAL)
+
+  // the scalar branches are per event fields, except for the counters which are the collection sizes
+  std::set<const char*> counters;
+  for (const auto* arrays : allArrays)
   {
-    // towers LFHCALO
-    _event_tree->Branch("tower_LFHCAL_N", &_nTowers_LFHCAL, "tower_LFHCAL_N/I");
-    _event_tree->Branch("tower_LFHCAL_E", _tower_LFHCAL_E, "tower_LFHCAL_E[tower_LFHCAL_N]/F");
-    _event_tree->Branch("tower_LFHCAL_iEta", _tower_LFHCAL_iEta, "tower_LFHCAL_iEta[tower_LFHCAL_N]/I");
-    _event_tree->Branch("tower_LFHCAL_iPhi", _tower_LFHCAL_iPhi, "tower_LFHCAL_iPhi[tower_LFHCAL_N]/I");
-    _event_tree->Branch("tower_LFHCAL_iL", _tower_LFHCAL_iL, "tower_LFHCAL_iL[tower_LFHCAL_N]/I");
-    _event_tree->Branch("tower_LFHCAL_trueID", _tower_LFHCAL_trueID, "tower_LFHCAL_trueID[tower_LFHCAL_N]/I");
+    if (arrays->counter)
+    {
+      counters.insert(reinterpret_cast<const char*>(arrays->counter));
+    }
   }
-  if (_do_FEMC)
+  _ntuple_values.clear();
+  TIter nextBranch(_event_tree->GetListOfBranches());
+  while (TBranch* branch = static_cast<TBranch*>(nextBranch()))
   {
-    // towers FEMC
-    _event_tree->Branch("tower_FEMC_N", &_nTowers_FEMC, "tower_FEMC_N/I");
-    _event_tree->Branch("tower_FEMC_E", _tower_FEMC_E, "tower_FEMC_E[tower_FEMC_N]/F");
-    _event_tree->Branch("tower_FEMC_iEta", _tower_FEMC_iEta, "tower_FEMC_iEta[tower_FEMC_N]/I");
-    _event_tree->Branch("tower_FEMC_iPhi", _tower_FEMC_iPhi, "tower_FEMC_iPhi[tower_FEMC_N]/I");
-    _event_tree->Branch("tower_FEMC_trueID", _tower_FEMC_trueID, "tower_FEMC_trueID[tower_FEMC_N]/I");
-    if (_do_CLUSTERS)
+    TLeaf* leaf = static_cast<TLeaf*>(branch->GetListOfLeaves()->At(0));
+    if (leaf->GetLeafCount() || counters.count(branch->GetAddress()))
     {
-      // clusters FEMC
-      _event_tree->Branch("cluster_FEMC_N", &_nclusters_FEMC, "cluster_FEMC_N/I");
-      _event_tree->Branch("cluster_FEMC_E", _cluster_FEMC_E, "cluster_FEMC_E[cluster_FEMC_N]/F");
-      _event_tree->Branch("cluster_FEMC_Eta", _cluster_FEMC_Eta, "cluster_FEMC_Eta[cluster_FEMC_N]/F");
-      _event_tree->Branch("cluster_FEMC_Phi", _cluster_FEMC_Phi, "cluster_FEMC_Phi[cluster_FEMC_N]/F");
-      _event_tree->Branch("cluster_FEMC_NTower", _cluster_FEMC_NTower, "cluster_FEMC_NTower[cluster_FEMC_N]/I");
-      _event_tree->Branch("cluster_FEMC_trueID", _cluster_FEMC_trueID, "cluster_FEMC_trueID[cluster_FEMC_N]/I");
+      continue;
+    }
+    const std::string type = leaf->GetTypeName();
+    if (type == "Float_t")
+    {
+      _ntuple_values.push_back(makeNtupleValue<float>(*model, branch->GetName(), branch->GetAddress()));
+    }
+    else if (type == "Int_t")
+    {
+      _ntuple_values.push_back(makeNtupleValue<int>(*model, branch->GetName(), branch->GetAddress()));
+    }
+    else
+    {
+      cout << PHWHERE << " WARNING: " << branch->GetName() << " of type " << type << " is not written to " << _rntuple_filename << endl;
     }
   }
-  if (_do_CEMC)
+
+  _ntuple_collections.clear();
+  for (auto* arrays : allArrays)
   {
-    // towers CEMC
-    _event_tree->Branch("tower_CEMC_N", &_nTowers_CEMC, "tower_CEMC_N/I");
-    _event_tree->Branch("tower_CEMC_E", _tower_CEMC_E, "tower_CEMC_E[tower_CEMC_N]/F");
-    _event_tree->Branch("tower_CEMC_iEta", _tower_CEMC_iEta, "tower_CEMC_iEta[tower_CEMC_N]/I");
-    _event_tree->Branch("tower_CEMC_iPhi", _tower_CEMC_iPhi, "tower_CEMC_iPhi[tower_CEMC_N]/I");
-    _event_tree->Branch("tower_CEMC_trueID", _tower_CEMC_trueID, "tower_CEMC_trueID[tower_CEMC_N]/I");
-    if (_do_CLUSTERS)
+    if (arrays->fields.empty())
     {
-      // clusters CEMC
-      _event_tree->Branch("cluster_CEMC_N", &_nclusters_CEMC, "cluster_CEMC_N/I");
-      _event_tree->Branch("cluster_CEMC_E", _cluster_CEMC_E, "cluster_CEMC_E[cluster_CEMC_N]/F");
-      _event_tree->Branch("cluster_CEMC_Eta", _cluster_CEMC_Eta, "cluster_CEMC_Eta[cluster_CEMC_N]/F");
-      _event_tree->Branch("cluster_CEMC_Phi", _cluster_CEMC_Phi, "cluster_CEMC_Phi[cluster_CEMC_N]/F");
-      _event_tree->Branch("cluster_CEMC_NTower", _cluster_CEMC_NTower, "cluster_CEMC_NTower[cluster_CEMC_N]/I");
-      _event_tree->Branch("cluster_CEMC_trueID", _cluster_CEMC_trueID, "cluster_CEMC_trueID[cluster_CEMC_N]/I");
+      continue;
     }
+    auto entryModel = ROOT::Experimental::RNTupleModel::Create();
+    arrays->copy.clear();
+    for (const auto& makeField : arrays->fields)
+    {
+      arrays->copy.push_back(makeField(*entryModel));
+    }
+    auto collection = model->MakeCollection(arrays->ntupleName, std::move(entryModel));
+    arrays->fill = [collection]() { collection->Fill(); };
+    _ntuple_collections.push_back(arrays);
+  }
+
+  _ntuple_writer = ROOT::Experimental::RNTupleWriter::Recreate(std::move(model), "event_ntuple", _rntuple_filename);
+}
+
+void EventEvaluatorEIC::fillNtuple()
+{
+  for (const auto& copyValue : _ntuple_values)
+  {
+    copyValue();
   }
-  if (_do_EEMC)
+  for (auto* arrays : _ntuple_collections)
   {
-    // towers EEMC
-    _event_tree->Branch("tower_EEMC_N", &_nTowers_EEMC, "tower_EEMC_N/I");
-    _event_tree->Branch("tower_EEMC_E", _tower_EEMC_E, "tower_EEMC_E[tower_EEMC_N]/F");
-    _event_tree->Branch("tower_EEMC_iEta", _tower_EEMC_iEta, "tower_EEMC_iEta[tower_EEMC_N]/I");
-    _event_tree->Branch("tower_EEMC_iPhi", _tower_EEMC_iPhi, "tower_EEMC_iPhi[tower_EEMC_N]/I");
-    _event_tree->Branch("tower_EEMC_trueID", _tower_EEMC_trueID, "tower_EEMC_trueID[tower_EEMC_N]/I");
-    if (_do_CLUSTERS)
+    for (int iEntry = 0; iEntry < *arrays->counter; iEntry++)
     {
-      // clusters EEMC
-      _event_tree->Branch("cluster_EEMC_N", &_nclusters_EEMC, "cluster_EEMC_N/I");
-      _event_tree->Branch("cluster_EEMC_E", _cluster_EEMC_E, "cluster_EEMC_E[cluster_EEMC_N]/F");
-      _event_tree->Branch("cluster_EEMC_Eta", _cluster_EEMC_Eta, "cluster_EEMC_Eta[cluster_EEMC_N]/F");
-      _event_tree->Branch("cluster_EEMC_Phi", _cluster_EEMC_Phi, "cluster_EEMC_Phi[cluster_EEMC_N]/F");
-      _event_tree->Branch("cluster_EEMC_NTower", _cluster_EEMC_NTower, "cluster_EEMC_NTower[cluster_EEMC_N]/I");
-      _event_tree->Branch("cluster_EEMC_trueID", _cluster_EEMC_trueID, "cluster_EEMC_trueID[cluster_EEMC_N]/I");
+      for (const auto& copyEntry : arrays->copy)
+      {
+        copyEntry(iEntry);
+      }
+      arrays->fill();
     }
   }
-  if (_do_EEMCG)
+  _ntuple_writer->Fill();
+}
+#endif
+
+int EventEvaluatorEIC::Init(PHCompositeNode* topNode)
+{
+  _ievent = 0;
+  _output_branches.clear();
+
+  // hit containers saved in the hits branches, in the order of their layer ids,
+  // a layer added by add_projection_layer replaces a default one of the same name
+  _hit_layers.clear();
+  set<string> layerNames;
+  for (const auto& layer : _projection_layers)
   {
-    // towers EEMCG
-    _event_tree->Branch("tower_EEMCG_N", &_nTowers_EEMCG, "tower_EEMCG_N/I");
-    _event_tree->Branch("tower_EEMCG_E", _tower_EEMCG_E, "tower_EEMCG_E[tower_EEMCG_N]/F");
-    _event_tree->Branch("tower_EEMCG_iEta", _tower_EEMCG_iEta, "tower_EEMCG_iEta[tower_EEMCG_N]/I");
-    _event_tree->Branch("tower_EEMCG_iPhi", _tower_EEMCG_iPhi, "tower_EEMCG_iPhi[tower_EEMCG_N]/I");
-    _event_tree->Branch("tower_EEMCG_trueID", _tower_EEMCG_trueID, "tower_EEMCG_trueID[tower_EEMCG_N]/I");
-    if (_do_CLUSTERS)
+    if (!layerNames.insert(layer.name).second)
     {
-      // clusters EEMCG
-      _event_tree->Branch("cluster_EEMCG_N", &_nclusters_EEMCG, "cluster_EEMCG_N/I");
-      _event_tree->Branch("cluster_EEMCG_E", _cluster_EEMCG_E, "cluster_EEMCG_E[cluster_EEMCG_N]/F");
-      _event_tree->Branch("cluster_EEMCG_Eta", _cluster_EEMCG_Eta, "cluster_EEMCG_Eta[cluster_EEMCG_N]/F");
-      _event_tree->Branch("cluster_EEMCG_Phi", _cluster_EEMCG_Phi, "cluster_EEMCG_Phi[cluster_EEMCG_N]/F");
-      _event_tree->Branch("cluster_EEMCG_NTower", _cluster_EEMCG_NTower, "cluster_EEMCG_NTower[cluster_EEMCG_N]/I");
-      _event_tree->Branch("cluster_EEMCG_trueID", _cluster_EEMCG_trueID, "cluster_EEMCG_trueID[cluster_EEMCG_N]/I");
+      continue;
+    }
+    if (layer.hits == kHits || (layer.hits == kCaloHits && _do_HITS_CALO) || (layer.hits == kBlackHoleHits && _do_BLACKHOLE))
+    {
+      _hit_layers.push_back(HitLayer{layer.id, layer.name, "G4HIT_" + layer.name, "G4HIT_ABSORBER_" + layer.name});
+    }
+  }
+  std::stable_sort(_hit_layers.begin(), _hit_layers.end(), [](const HitLayer& a, const HitLayer& b) { return a.id < b.id; });
+  _hit_buffers.assign(_hit_layers.size(), std::vector<HitEntry>());
+  _track_states.clear();
+
+  _tfile = new TFile(_filename.c_str(), "RECREATE");
+
+  _event_tree = new TTree("event_tree", "event_tree");
+  if (_do_store_event_info)
+  {
+    // Event level info. This isn't the most efficient way to store this info, but it's straightforward
+    // within the structure of the class, so the size is small compared to the rest of the output.
+    _event_tree->Branch("cross_section", &_cross_section, "cross_section/F");
+    _event_tree->Branch("event_weight", &_event_weight, "event_weight/F");
+    _event_tree->Branch("n_generator_accepted", &_n_generator_accepted, "n_generator_accepted/I");
+  }
+  // tracks and hits
+  if (_do_HITS)
+  {
+    _event_tree->Branch("nHits", &_nHitsLayers, "nHits/I");
+    addOutputArray(_hitArrays, _hits_layerID, _event_tree, "hits_layerID", "hits_layerID[nHits]/I");
+    addOutputArray(_hitArrays, _hits_trueID, _event_tree, "hits_trueID", "hits_trueID[nHits]/I");
+    addOutputArray(_hitArrays, _hits_x, _event_tree, "hits_x", "hits_x[nHits]/F");
+    addOutputArray(_hitArrays, _hits_y, _event_tree, "hits_y", "hits_y[nHits]/F");
+    addOutputArray(_hitArrays, _hits_z, _event_tree, "hits_z", "hits_z[nHits]/F");
+    addOutputArray(_hitArrays, _hits_x2, _event_tree, "hits_x2", "hits_x2[nHits]/F");
+    addOutputArray(_hitArrays, _hits_y2, _event_tree, "hits_y2", "hits_y2[nHits]/F");
+    addOutputArray(_hitArrays, _hits_z2, _event_tree, "hits_z2", "hits_z2[nHits]/F");
+    addOutputArray(_hitArrays, _hits_t, _event_tree, "hits_t", "hits_t[nHits]/F");
+    addOutputArray(_hitArrays, _hits_edep, _event_tree, "hits_edep", "hits_edep[nHits]/F");
+    addOutputArray(_hitArrays, _hits_lightyield, _event_tree, "hits_lightyield", "hits_lightyield[nHits]/F");
+    addOutputArray(_hitArrays, _hits_isAbsorber, _event_tree, "hits_isAbsorber", "hits_isAbsorber[nHits]/I");
+  }
+
+  if (_do_TRACKS)
+  {
+    _event_tree->Branch("nTracks", &_nTracks, "nTracks/I");
+    addOutputArray(_trackArrays, _track_ID, _event_tree, "tracks_ID", "tracks_ID[nTracks]/F");
+    addOutputArray(_trackArrays, _track_charge, _event_tree, "tracks_charge", "tracks_charge[nTracks]/S");
+    addOutputArray(_trackArrays, _track_px, _event_tree, "tracks_px", "tracks_px[nTracks]/F");
+    addOutputArray(_trackArrays, _track_py, _event_tree, "tracks_py", "tracks_py[nTracks]/F");
+    addOutputArray(_trackArrays, _track_pz, _event_tree, "tracks_pz", "tracks_pz[nTracks]/F");
+    addOutputArray(_trackArrays, _track_x, _event_tree, "tracks_x", "tracks_x[nTracks]/F");
+    addOutputArray(_trackArrays, _track_y, _event_tree, "tracks_y", "tracks_y[nTracks]/F");
+    addOutputArray(_trackArrays, _track_z, _event_tree, "tracks_z", "tracks_z[nTracks]/F");
+    addOutputArray(_trackArrays, _track_ndf, _event_tree, "tracks_ndf", "tracks_ndf[nTracks]/F");
+    addOutputArray(_trackArrays, _track_chi2, _event_tree, "tracks_chi2", "tracks_chi2[nTracks]/F");
+    addOutputArray(_trackArrays, _track_dca, _event_tree, "tracks_dca", "tracks_dca[nTracks]/F");
+    addOutputArray(_trackArrays, _track_dca_2d, _event_tree, "tracks_dca_2d", "tracks_dca_2d[nTracks]/F");
+    addOutputArray(_trackArrays, _track_trueID, _event_tree, "tracks_trueID", "tracks_trueID[nTracks]/F");
+    addOutputArray(_trackArrays, _track_source, _event_tree, "tracks_source", "tracks_source[nTracks]/s");
+
+    // hadron PID log likelihood, only saved with _do_PID_LogLikelihood but always sized like the tracks
+    TTree* pidtree = _do_PID_LogLikelihood ? _event_tree : nullptr;
+    addOutputArray(_trackArrays, _track_pion_LL, pidtree, "track_pion_LL", "track_pion_LL[nTracks]/F", -100);
+    addOutputArray(_trackArrays, _track_kaon_LL, pidtree, "track_kaon_LL", "track_kaon_LL[nTracks]/F", -100);
+    addOutputArray(_trackArrays, _track_proton_LL, pidtree, "track_proton_LL", "track_proton_LL[nTracks]/F", -100);
+  }
+  if (_do_PROJECTIONS)
+  {
+    _event_tree->Branch("nProjections", &_nProjections, "nProjections/I");
+    addOutputArray(_projectionArrays, _track_ProjTrackID, _event_tree, "track_ProjTrackID", "track_ProjTrackID[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_ProjLayer, _event_tree, "track_ProjLayer", "track_ProjLayer[nProjections]/I", -1);
+    addOutputArray(_projectionArrays, _track_TLP_x, _event_tree, "track_TLP_x", "track_TLP_x[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_y, _event_tree, "track_TLP_y", "track_TLP_y[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_z, _event_tree, "track_TLP_z", "track_TLP_z[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_t, _event_tree, "track_TLP_t", "track_TLP_t[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_px, _event_tree, "track_TLP_px", "track_TLP_px[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_py, _event_tree, "track_TLP_py", "track_TLP_py[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_pz, _event_tree, "track_TLP_pz", "track_TLP_pz[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_true_x, _event_tree, "track_TLP_true_x", "track_TLP_true_x[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_true_y, _event_tree, "track_TLP_true_y", "track_TLP_true_y[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_true_z, _event_tree, "track_TLP_true_z", "track_TLP_true_z[nProjections]/F");
+    addOutputArray(_projectionArrays, _track_TLP_true_t, _event_tree, "track_TLP_true_t", "track_TLP_true_t[nProjections]/F");
+  }
+  for (auto& calo : _calos)
+  {
+    if (!calo.enabled)
+    {
+      continue;
+    }
+    // towers, the optional fields in the order of the former per calorimeter branches
+    const string tower = "tower_" + calo.name;
+    const string ntower = "[" + tower + "_N]";
+    _event_tree->Branch((tower + "_N").c_str(), &calo.nTowers, (tower + "_N/I").c_str());
+    addOutputArray(calo.towerArrays, calo.towerE, _event_tree, tower + "_E", tower + "_E" + ntower + "/F");
+    if (calo.fields & kTowerPhotons)
+    {
+      addOutputArray(calo.towerArrays, calo.towerNScint, _event_tree, tower + "_NScint", tower + "_NScint" + ntower + "/I");
+      addOutputArray(calo.towerArrays, calo.towerNCerenkov, _event_tree, tower + "_NCerenkov", tower + "_NCerenkov" + ntower + "/I");
+    }
+    addOutputArray(calo.towerArrays, calo.towerIEta, _event_tree, tower + "_iEta", tower + "_iEta" + ntower + "/I");
+    addOutputArray(calo.towerArrays, calo.towerIPhi, _event_tree, tower + "_iPhi", tower + "_iPhi" + ntower + "/I");
+    if (calo.fields & kTowerLayer)
+    {
+      addOutputArray(calo.towerArrays, calo.towerIL, _event_tree, tower + "_iL", tower + "_iL" + ntower + "/I");
+    }
+    addOutputArray(calo.towerArrays, calo.towerTrueID, _event_tree, tower + "_trueID", tower + "_trueID" + ntower + "/I");
+    if (_do_CLUSTERS && calo.clusterArrays.maxSize > 0)
+    {
+      // clusters
+      const string cluster = "cluster_" + calo.name;
+      const string ncluster = "[" + cluster + "_N]";
+      _event_tree->Branch((cluster + "_N").c_str(), &calo.nClusters, (cluster + "_N/I").c_str());
+      addOutputArray(calo.clusterArrays, calo.clusterE, _event_tree, cluster + "_E", cluster + "_E" + ncluster + "/F");
+      addOutputArray(calo.clusterArrays, calo.clusterEta, _event_tree, cluster + "_Eta", cluster + "_Eta" + ncluster + "/F");
+      addOutputArray(calo.clusterArrays, calo.clusterPhi, _event_tree, cluster + "_Phi", cluster + "_Phi" + ncluster + "/F");
+      addOutputArray(calo.clusterArrays, calo.clusterNTower, _event_tree, cluster + "_NTower", cluster + "_NTower" + ncluster + "/I");
+      addOutputArray(calo.clusterArrays, calo.clusterTrueID, _event_tree, cluster + "_trueID", cluster + "_trueID" + ncluster + "/I");
     }
   }
   if (_do_VERTEX)
@@ -827,17 +815,17 @@ int EventEvaluatorEIC::Init(PHCompositeNode* topNode)
   {
     // MC particles
     _event_tree->Branch("nMCPart", &_nMCPart, "nMCPart/I");
-    _event_tree->Branch("mcpart_ID", _mcpart_ID, "mcpart_ID[nMCPart]/I");
-    _event_tree->Branch("mcpart_ID_parent", _mcpart_ID_parent, "mcpart_ID_parent[nMCPart]/I");
-    _event_tree->Branch("mcpart_PDG", _mcpart_PDG, "mcpart_PDG[nMCPart]/I");
-    _event_tree->Branch("mcpart_E", _mcpart_E, "mcpart_E[nMCPart]/F");
-    _event_tree->Branch("mcpart_px", _mcpart_px, "mcpart_px[nMCPart]/F");
-    _event_tree->Branch("mcpart_py", _mcpart_py, "mcpart_py[nMCPart]/F");
-    _event_tree->Branch("mcpart_pz", _mcpart_pz, "mcpart_pz[nMCPart]/F");
-    _event_tree->Branch("mcpart_x", _mcpart_x, "mcpart_x[nMCPart]/F");
-    _event_tree->Branch("mcpart_y", _mcpart_y, "mcpart_y[nMCPart]/F");
-    _event_tree->Branch("mcpart_z", _mcpart_z, "mcpart_z[nMCPart]/F");
-    _event_tree->Branch("mcpart_BCID", _mcpart_BCID, "mcpart_BCID[nMCPart]/I");
+    addOutputArray(_mcpartArrays, _mcpart_ID, _event_tree, "mcpart_ID", "mcpart_ID[nMCPart]/I");
+    addOutputArray(_mcpartArrays, _mcpart_ID_parent, _event_tree, "mcpart_ID_parent", "mcpart_ID_parent[nMCPart]/I");
+    addOutputArray(_mcpartArrays, _mcpart_PDG, _event_tree, "mcpart_PDG", "mcpart_PDG[nMCPart]/I");
+    addOutputArray(_mcpartArrays, _mcpart_E, _event_tree, "mcpart_E", "mcpart_E[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_px, _event_tree, "mcpart_px", "mcpart_px[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_py, _event_tree, "mcpart_py", "mcpart_py[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_pz, _event_tree, "mcpart_pz", "mcpart_pz[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_x, _event_tree, "mcpart_x", "mcpart_x[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_y, _event_tree, "mcpart_y", "mcpart_y[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_z, _event_tree, "mcpart_z", "mcpart_z[nMCPart]/F");
+    addOutputArray(_mcpartArrays, _mcpart_BCID, _event_tree, "mcpart_BCID", "mcpart_BCID[nMCPart]/I", -10);
   }
   if (_do_HEPMC)
   {
@@ -853,15 +841,15 @@ int EventEvaluatorEIC::Init(PHCompositeNode* topNode)
     _event_tree->Branch("hepmcp_vtx_t", &_hepmcp_vtx_t, "hepmcp_vtx_t/F");
 
     //    _event_tree->Branch("hepmcp_ID_parent", _hepmcp_ID_parent, "hepmcp_ID_parent[nHepmcp]/F");
-    _event_tree->Branch("hepmcp_status", _hepmcp_status, "hepmcp_status[nHepmcp]/I");
-    _event_tree->Branch("hepmcp_PDG", _hepmcp_PDG, "hepmcp_PDG[nHepmcp]/I");
-    _event_tree->Branch("hepmcp_E", _hepmcp_E, "hepmcp_E[nHepmcp]/F");
-    _event_tree->Branch("hepmcp_px", _hepmcp_px, "hepmcp_px[nHepmcp]/F");
-    _event_tree->Branch("hepmcp_py", _hepmcp_py, "hepmcp_py[nHepmcp]/F");
-    _event_tree->Branch("hepmcp_pz", _hepmcp_pz, "hepmcp_pz[nHepmcp]/F");
-    _event_tree->Branch("hepmcp_BCID", _hepmcp_BCID, "hepmcp_BCID[nHepmcp]/I");
-    _event_tree->Branch("hepmcp_m1", _hepmcp_m1, "hepmcp_m1[nHepmcp]/I");
-    _event_tree->Branch("hepmcp_m2", _hepmcp_m2, "hepmcp_m2[nHepmcp]/I");
+    addOutputArray(_hepmcpArrays, _hepmcp_status, _event_tree, "hepmcp_status", "hepmcp_status[nHepmcp]/I", -10);
+    addOutputArray(_hepmcpArrays, _hepmcp_PDG, _event_tree, "hepmcp_PDG", "hepmcp_PDG[nHepmcp]/I");
+    addOutputArray(_hepmcpArrays, _hepmcp_E, _event_tree, "hepmcp_E", "hepmcp_E[nHepmcp]/F");
+    addOutputArray(_hepmcpArrays, _hepmcp_px, _event_tree, "hepmcp_px", "hepmcp_px[nHepmcp]/F");
+    addOutputArray(_hepmcpArrays, _hepmcp_py, _event_tree, "hepmcp_py", "hepmcp_py[nHepmcp]/F");
+    addOutputArray(_hepmcpArrays, _hepmcp_pz, _event_tree, "hepmcp_pz", "hepmcp_pz[nHepmcp]/F");
+    addOutputArray(_hepmcpArrays, _hepmcp_BCID, _event_tree, "hepmcp_BCID", "hepmcp_BCID[nHepmcp]/I");
+    addOutputArray(_hepmcpArrays, _hepmcp_m1, _event_tree, "hepmcp_m1", "hepmcp_m1[nHepmcp]/I");
+    addOutputArray(_hepmcpArrays, _hepmcp_m2, _event_tree, "hepmcp_m2", "hepmcp_m2[nHepmcp]/I");
   }
 
   if (_do_GEOMETRY)
@@ -872,15 +860,27 @@ int EventEvaluatorEIC::Init(PHCompositeNode* topNode)
     // tracks and hits
     _geometry_tree->Branch("calo", &_calo_ID, "nHits/I");
     _geometry_tree->Branch("calo_towers_N", &_calo_towers_N, "calo_towers_N/I");
-    _geometry_tree->Branch("calo_towers_iEta", _calo_towers_iEta, "calo_towers_iEta[calo_towers_N]/I");
-    _geometry_tree->Branch("calo_towers_iPhi", _calo_towers_iPhi, "calo_towers_iPhi[calo_towers_N]/I");
-    _geometry_tree->Branch("calo_towers_iL", _calo_towers_iL, "calo_towers_iL[calo_towers_N]/I");
-    _geometry_tree->Branch("calo_towers_Eta", _calo_towers_Eta, "calo_towers_Eta[calo_towers_N]/F");
-    _geometry_tree->Branch("calo_towers_Phi", _calo_towers_Phi, "calo_towers_Phi[calo_towers_N]/F");
-    _geometry_tree->Branch("calo_towers_x", _calo_towers_x, "calo_towers_x[calo_towers_N]/F");
-    _geometry_tree->Branch("calo_towers_y", _calo_towers_y, "calo_towers_y[calo_towers_N]/F");
-    _geometry_tree->Branch("calo_towers_z", _calo_towers_z, "calo_towers_z[calo_towers_N]/F");
+    addOutputArray(_geometryArrays, _calo_towers_iEta, _geometry_tree, "calo_towers_iEta", "calo_towers_iEta[calo_towers_N]/I");
+    addOutputArray(_geometryArrays, _calo_towers_iPhi, _geometry_tree, "calo_towers_iPhi", "calo_towers_iPhi[calo_towers_N]/I");
+    addOutputArray(_geometryArrays, _calo_towers_iL, _geometry_tree, "calo_towers_iL", "calo_towers_iL[calo_towers_N]/I");
+    addOutputArray(_geometryArrays, _calo_towers_Eta, _geometry_tree, "calo_towers_Eta", "calo_towers_Eta[calo_towers_N]/F");
+    addOutputArray(_geometryArrays, _calo_towers_Phi, _geometry_tree, "calo_towers_Phi", "calo_towers_Phi[calo_towers_N]/F");
+    addOutputArray(_geometryArrays, _calo_towers_x, _geometry_tree, "calo_towers_x", "calo_towers_x[calo_towers_N]/F");
+    addOutputArray(_geometryArrays, _calo_towers_y, _geometry_tree, "calo_towers_y", "calo_towers_y[calo_towers_N]/F");
+    addOutputArray(_geometryArrays, _calo_towers_z, _geometry_tree, "calo_towers_z", "calo_towers_z[calo_towers_N]/F");
+  }
+
+#ifdef HAVE_RNTUPLE
+  if (!_rntuple_filename.empty())
+  {
+    startNtuple();
   }
+#endif
+  if (_async_depth > 0)
+  {
+    startWriter();
+  }
+  startFillWorkers();
 
   return Fun4AllReturnCodes::EVENT_OK;
 }
@@ -891,162 +891,21 @@ int EventEvaluatorEIC::process_event(PHCompositeNode* topNode)
   {
     cout << "entered process_event" << endl;
   }
-  if (_do_FHCAL)
-  {
-    if (!_caloevalstackFHCAL)
-    {
-      _caloevalstackFHCAL = new CaloEvalStack(topNode, "FHCAL");
-      _caloevalstackFHCAL->set_strict(_strict);
-      _caloevalstackFHCAL->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackFHCAL->next_event(topNode);
-    }
-  }
-  if (_do_BECAL)
-  {
-    if (!_caloevalstackBECAL)
-    {
-      _caloevalstackBECAL = new CaloEvalStack(topNode, "BECAL");
-      _caloevalstackBECAL->set_strict(_strict);
-      _caloevalstackBECAL->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackBECAL->next_event(topNode);
-    }
-  }
-  if (_do_HCALIN)
-  {
-    if (!_caloevalstackHCALIN)
-    {
-      _caloevalstackHCALIN = new CaloEvalStack(topNode, "HCALIN");
-      _caloevalstackHCALIN->set_strict(_strict);
-      _caloevalstackHCALIN->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackHCALIN->next_event(topNode);
-    }
-  }
-  if (_do_HCALOUT)
-  {
-    if (!_caloevalstackHCALOUT)
-    {
-      _caloevalstackHCALOUT = new CaloEvalStack(topNode, "HCALOUT");
-      _caloevalstackHCALOUT->set_strict(_strict);
-      _caloevalstackHCALOUT->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackHCALOUT->next_event(topNode);
-    }
-  }
-  if (_do_EHCAL)
-  {
-    if (!_caloevalstackEHCAL)
-    {
-      _caloevalstackEHCAL = new CaloEvalStack(topNode, "EHCAL");
-      _caloevalstackEHCAL->set_strict(_strict);
-      _caloevalstackEHCAL->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackEHCAL->next_event(topNode);
-    }
-  }
-  if (_do_DRCALO)
-  {
-    if (!_caloevalstackDRCALO)
-    {
-      _caloevalstackDRCALO = new CaloEvalStack(topNode, "DRCALO");
-      _caloevalstackDRCALO->set_strict(_strict);
-      _caloevalstackDRCALO->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackDRCALO->next_event(topNode);
-    }
-  }
-  if (_do_FOCAL)
-  {
-    if (!_caloevalstackFOCAL)
-    {
-      _caloevalstackFOCAL = new CaloEvalStack(topNode, "FOCAL");
-      _caloevalstackFOCAL->set_strict(_strict);
-      _caloevalstackFOCAL->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackFOCAL->next_event(topNode);
-    }
-  }
-  if (_do_LFHCAL)
-  {
-    if (!_caloevalstackLFHCAL)
-    {
-      _caloevalstackLFHCAL = new CaloEvalStack(topNode, "LFHCAL");
-      _caloevalstackLFHCAL->set_strict(_strict);
-      _caloevalstackLFHCAL->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackLFHCAL->next_event(topNode);
-    }
-  }
-
-  if (_do_FEMC)
-  {
-    if (!_caloevalstackFEMC)
-    {
-      _caloevalstackFEMC = new CaloEvalStack(topNode, "FEMC");
-      _caloevalstackFEMC->set_strict(_strict);
-      _caloevalstackFEMC->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackFEMC->next_event(topNode);
-    }
-  }
-  if (_do_CEMC)
-  {
-    if (!_caloevalstackCEMC)
-    {
-      _caloevalstackCEMC = new CaloEvalStack(topNode, "CEMC");
-      _caloevalstackCEMC->set_strict(_strict);
-      _caloevalstackCEMC->set_verbosity(Verbosity() + 1);
-    }
-    else
-    {
-      _caloevalstackCEMC->next_event(topNode);
-    }
-  }
-  if (_do_EEMC)
+  for (auto& calo : _calos)
   {
-    if (!_caloevalstackEEMC)
-    {
-      _caloevalstackEEMC = new CaloEvalStack(topNode, "EEMC");
-      _caloevalstackEEMC->set_strict(_strict);
-      _caloevalstackEEMC->set_verbosity(Verbosity() + 1);
-    }
-    else
+    if (!calo.enabled)
     {
-      _caloevalstackEEMC->next_event(topNode);
+      continue;
     }
-  }
-
-  if (_do_EEMCG)
-  {
-    if (!_caloevalstackEEMCG)
+    if (!calo.evalstack)
     {
-      _caloevalstackEEMCG = new CaloEvalStack(topNode, "EEMC_glass");
-      _caloevalstackEEMCG->set_strict(_strict);
-      _caloevalstackEEMCG->set_verbosity(Verbosity() + 1);
+      calo.evalstack = new CaloEvalStack(topNode, calo.nodename);
+      calo.evalstack->set_strict(_strict);
+      calo.evalstack->set_verbosity(Verbosity() + 1);
     }
     else
     {
-      _caloevalstackEEMCG->next_event(topNode);
+      calo.evalstack->next_event(topNode);
     }
   }
 
@@ -1070,6 +929,12 @@ void EventEvaluatorEIC::fillOutputNtuples(PHCompositeNode* topNode)
     cout << "EventEvaluatorEIC::fillOutputNtuples() entered" << endl;
   }
 
+  // the tower truth attribution is only valid within one event
+  for (auto& calo : _calos)
+  {
+    calo.towerTruth.clear();
+  }
+
   //----------------------
   // fill the Event Tree
   //----------------------
@@ -1182,2369 +1047,638 @@ void EventEvaluatorEIC::fillOutputNtuples(PHCompositeNode* topNode)
     }
   }
   //----------------------
-  //    HITS
+  // DETECTOR SECTIONS
   //----------------------
-  if (_do_HITS)
+  // every section writes only to its own output buffers and only reads the node tree and
+  // the truth containers, so they can run as concurrent tasks (set_fill_threads). Each hit
+  // layer is a task that collects its hits in its own buffer, the buffers are copied to the hits
+  // arrays in layer order after the tasks. The towers and clusters of a calorimeter are one
+  // task, the clusters use its tower truth cache.
+  if (_do_CLUSTERS && Verbosity() > 0)
   {
-    if (Verbosity() > 0)
+    cout << "saving clusters" << endl;
+  }
+  // cluster eta is computed for the first reconstructed vertex
+  SvtxVertex* vertex = (vertexmap && !vertexmap->empty()) ? vertexmap->begin()->second : nullptr;
+  // the geometry tree entries follow the calorimeter order, so it is filled here and not in the tasks
+  if (_do_GEOMETRY)
+  {
+    for (auto& calo : _calos)
     {
-      cout << "saving hits" << endl;
-    }
-    _nHitsLayers = 0;
-    PHG4TruthInfoContainer* truthinfocontainerHits = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
-    for (int iIndex = 0; iIndex < 200; ++iIndex)
-    {
-      // you need to add your layer name here to be saved! This has to be done
-      // as we do not want to save thousands of calorimeter hits!
-      if (
-          (_do_HITS_CALO && ( (GetProjectionNameFromIndex(iIndex).find("LFHCAL") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("HCALIN") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("HCALOUT") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("BECAL") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("FEMC") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("EHCAL") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("EEMCH") != std::string::npos) ||
-                              (GetProjectionNameFromIndex(iIndex).find("EEMC") != std::string::npos))) ||
-          (GetProjectionNameFromIndex(iIndex).find("TTL") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("LBLVTX") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("BARR") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("FST") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("ZDCsurrogate") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("rpTruth") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("rpTruth2") != std::string::npos) ||  // needed for IP8
-          (GetProjectionNameFromIndex(iIndex).find("offMomTruth") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("b0Truth") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("EGEM") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("FGEM") != std::string::npos) ||
-          (GetProjectionNameFromIndex(iIndex).find("RWELL") != std::string::npos) ||
-          (((GetProjectionNameFromIndex(iIndex).find("BH_1") != std::string::npos) || (GetProjectionNameFromIndex(iIndex).find("BH_FORWARD_PLUS") != std::string::npos) || (GetProjectionNameFromIndex(iIndex).find("BH_FORWARD_NEG") != std::string::npos)) && _do_BLACKHOLE))
-      {
-
-        string nodename = "G4HIT_" + GetProjectionNameFromIndex(iIndex);
-        PHG4HitContainer* hits = findNode::getClass<PHG4HitContainer>(topNode, nodename);
-        if (hits)
-        {
-          if (Verbosity() > 1)
-          {
-            cout << __PRETTY_FUNCTION__ << " number of hits: " << hits->size() << endl;
-          }
-          PHG4HitContainer::ConstRange hit_range = hits->getHits();
-          for (PHG4HitContainer::ConstIterator hit_iter = hit_range.first; hit_iter != hit_range.second; hit_iter++)
-          {
-            if (Verbosity() > 1)
-            {
-              cout << __PRETTY_FUNCTION__ << " found hit with id " << hit_iter->second->get_trkid() << endl;
-            }
-            if (_nHitsLayers > _maxNHits)
-            {
-              cout << __PRETTY_FUNCTION__ << " exceededed maximum hit array size! Please check where these hits come from!" << endl;
-              break;
-            }
-
-            _hits_x[_nHitsLayers] = hit_iter->second->get_x(0);
-            _hits_y[_nHitsLayers] = hit_iter->second->get_y(0);
-            _hits_z[_nHitsLayers] = hit_iter->second->get_z(0);
-            _hits_x2[_nHitsLayers] = hit_iter->second->get_x(1);
-            _hits_y2[_nHitsLayers] = hit_iter->second->get_y(1);
-            _hits_z2[_nHitsLayers] = hit_iter->second->get_z(1);
-            _hits_t[_nHitsLayers] = hit_iter->second->get_t(0);
-            _hits_edep[_nHitsLayers] = hit_iter->second->get_edep();
-            _hits_lightyield[_nHitsLayers] = hit_iter->second->get_light_yield();
-            _hits_isAbsorber[_nHitsLayers] = 0;
-            _hits_layerID[_nHitsLayers] = iIndex;
-            // cout << "i " << hit_iter->second->get_index_i() << "\tj " <<hit_iter->second->get_index_j() << "\tk " <<hit_iter->second->get_index_k() << "\tl " << hit_iter->second->get_index_l() << "\tsens_x "<< hit_iter->second->get_strip_z_index()<< "\tsens_y "<< hit_iter->second->get_strip_y_index()   << endl;
-            if (truthinfocontainerHits)
-            {
-              PHG4Particle* particle = truthinfocontainerHits->GetParticle(hit_iter->second->get_trkid());
-
-              if (particle->get_parent_id() != 0)
-              {
-                PHG4Particle* g4particleMother = truthinfocontainerHits->GetParticle(hit_iter->second->get_trkid());
-                int mcSteps = 0;
-                while (g4particleMother->get_parent_id() != 0)
-                {
-                  g4particleMother = truthinfocontainerHits->GetParticle(g4particleMother->get_parent_id());
-                  if (g4particleMother == NULL) break;
-                  mcSteps += 1;
-                }
-                if (mcSteps <= _depth_MCstack)
-                {
-                  _hits_trueID[_nHitsLayers] = hit_iter->second->get_trkid();
-                }
-                else
-                {
-                  PHG4Particle* g4particleMother2 = truthinfocontainerHits->GetParticle(hit_iter->second->get_trkid());
-                  int mcSteps2 = 0;
-                  while (g4particleMother2->get_parent_id() != 0 && (mcSteps2 < (mcSteps - _depth_MCstack + 1)))
-                  {
-                    g4particleMother2 = truthinfocontainerHits->GetParticle(g4particleMother2->get_parent_id());
-                    if (g4particleMother2 == NULL)
-                    {
-                      break;
-                    }
-                    else
-                    {
-                      _hits_trueID[_nHitsLayers] = g4particleMother2->get_parent_id();
-                      mcSteps2 += 1;
-                    }
-                  }
-                }
-              }
-              else
-              {
-                _hits_trueID[_nHitsLayers] = hit_iter->second->get_trkid();
-              }
-            }
-            _nHitsLayers++;
-          }
-          if (Verbosity() > 0)
-          {
-            cout << "saved\t" << _nHitsLayers << "\thits for " << GetProjectionNameFromIndex(iIndex) << endl;
-          }
-        }
-        else
-        {
-          if (Verbosity() > 0)
-          {
-            cout << __PRETTY_FUNCTION__ << " could not find " << nodename << endl;
-          }
-          continue;
-        }
-        if(_do_HITS_ABSORBER){
-          string nodenameAbs = "G4HIT_ABSORBER_" + GetProjectionNameFromIndex(iIndex);
-          PHG4HitContainer* hitsAbs = findNode::getClass<PHG4HitContainer>(topNode, nodenameAbs);
-          if (hitsAbs)
-          {
-            if (Verbosity() > 1)
-            {
-              cout << __PRETTY_FUNCTION__ << " absorber number of hits: " << hitsAbs->size() << endl;
-            }
-            PHG4HitContainer::ConstRange hit_range = hitsAbs->getHits();
-            for (PHG4HitContainer::ConstIterator hit_iter = hit_range.first; hit_iter != hit_range.second; hit_iter++)
-            {
-              if (Verbosity() > 1)
-              {
-                cout << __PRETTY_FUNCTION__ << " found hit with id " << hit_iter->second->get_trkid() << endl;
-              }
-              if (_nHitsLayers > _maxNHits)
-              {
-                cout << __PRETTY_FUNCTION__ << " exceededed maximum hit array size! Please check where these hits come from!" << endl;
-                break;
-              }
-
-              _hits_x[_nHitsLayers] = hit_iter->second->get_x(0);
-              _hits_y[_nHitsLayers] = hit_iter->second->get_y(0);
-              _hits_z[_nHitsLayers] = hit_iter->second->get_z(0);
-              _hits_x2[_nHitsLayers] = hit_iter->second->get_x(1);
-              _hits_y2[_nHitsLayers] = hit_iter->second->get_y(1);
-              _hits_z2[_nHitsLayers] = hit_iter->second->get_z(1);
-              _hits_t[_nHitsLayers] = hit_iter->second->get_t(0);
-              _hits_edep[_nHitsLayers] = hit_iter->second->get_edep();
-              _hits_lightyield[_nHitsLayers] = hit_iter->second->get_light_yield();
-              _hits_isAbsorber[_nHitsLayers] = 1;
-              _hits_layerID[_nHitsLayers] = iIndex;
-              // cout << "i " << hit_iter->second->get_index_i() << "\tj " <<hit_iter->second->get_index_j() << "\tk " <<hit_iter->second->get_index_k() << "\tl " << hit_iter->second->get_index_l() << "\tsens_x "<< hit_iter->second->get_strip_z_index()<< "\tsens_y "<< hit_iter->second->get_strip_y_index()   << endl;
-              if (truthinfocontainerHits)
-              {
-                PHG4Particle* particle = truthinfocontainerHits->GetParticle(hit_iter->second->get_trkid());
-
-                if (particle->get_parent_id() != 0)
-                {
-                  PHG4Particle* g4particleMother = truthinfocontainerHits->GetParticle(hit_iter->second->get_trkid());
-                  int mcSteps = 0;
-                  while (g4particleMother->get_parent_id() != 0)
-                  {
-                    g4particleMother = truthinfocontainerHits->GetParticle(g4particleMother->get_parent_id());
-                    if (g4particleMother == NULL) break;
-                    mcSteps += 1;
-                  }
-                  if (mcSteps <= _depth_MCstack)
-                  {
-                    _hits_trueID[_nHitsLayers] = hit_iter->second->get_trkid();
-                  }
-                  else
-                  {
-                    PHG4Particle* g4particleMother2 = truthinfocontainerHits->GetParticle(hit_iter->second->get_trkid());
-                    int mcSteps2 = 0;
-                    while (g4particleMother2->get_parent_id() != 0 && (mcSteps2 < (mcSteps - _depth_MCstack + 1)))
-                    {
-                      g4particleMother2 = truthinfocontainerHits->GetParticle(g4particleMother2->get_parent_id());
-                      if (g4particleMother2 == NULL)
-                      {
-                        break;
-                      }
-                      else
-                      {
-                        _hits_trueID[_nHitsLayers] = g4particleMother2->get_parent_id();
-                        mcSteps2 += 1;
-                      }
-                    }
-                  }
-                }
-                else
-                {
-                  _hits_trueID[_nHitsLayers] = hit_iter->second->get_trkid();
-                }
-              }
-              _nHitsLayers++;
-            }
-            if (Verbosity() > 0)
-            {
-              cout << "saved\t" << _nHitsLayers << "\thits for absorber of " << GetProjectionNameFromIndex(iIndex) << endl;
-            }
-          }
-          else
-          {
-            if (Verbosity() > 0)
-            {
-              cout << __PRETTY_FUNCTION__ << " could not find " << nodename << endl;
-            }
-            continue;
-          }
-        }
-      }
-    }
-  }
-  //----------------------
-  //    TOWERS FHCAL
-  //----------------------
-  if (_do_FHCAL)
-  {
-    CaloRawTowerEval* towerevalFHCAL = _caloevalstackFHCAL->get_rawtower_eval();
-    _nTowers_FHCAL = 0;
-    string towernodeFHCAL = "TOWER_CALIB_FHCAL";
-    RawTowerContainer* towersFHCAL = findNode::getClass<RawTowerContainer>(topNode, towernodeFHCAL.c_str());
-    if (towersFHCAL)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving HCAL towers" << endl;
-      }
-      string towergeomnodeFHCAL = "TOWERGEOM_FHCAL";
-      RawTowerGeomContainer* towergeomFHCAL = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeFHCAL.c_str());
-      if (towergeomFHCAL)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kFHCAL])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomFHCAL->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kFHCAL;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kFHCAL] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-
-        RawTowerContainer::ConstRange begin_end = towersFHCAL->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kFHCAL]) continue;
-            // cout << "\tnew FHCAL tower" << endl;
-            _tower_FHCAL_iEta[_nTowers_FHCAL] = tower->get_bineta();
-            _tower_FHCAL_iPhi[_nTowers_FHCAL] = tower->get_binphi();
-            _tower_FHCAL_E[_nTowers_FHCAL] = tower->get_energy();
-
-            // PHG4TruthInfoContainer* truthinfocontainer = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
-            // RawTower::ShowerConstRange shower_range = tower->get_g4showers();
-            // for (RawTower::ShowerConstIterator iter = shower_range.first;
-            //     iter != shower_range.second;
-            //     ++iter)
-            // {
-            //   PHG4Shower* shower = truthinfocontainer->GetShower(iter->first);
-            //   // PHG4Particle* particleParent = truthinfocontainer->GetParticle(shower->get_parent_particle_id());
-            //     // if (particleParent)
-            //     // {
-            //     //   cout << "\t\tcurr shower parent id: " << shower->get_parent_particle_id()<< "\tPDG " << particleParent->get_pid() << "\tedep: " << shower->get_edep() << endl;
-            //     // } else {
-            //     //   cout << "\t\tcurr shower parent id: " << shower->get_parent_particle_id() << endl;
-            //     // }
-            //   // for (PHG4Shower::ParticleIdIter jter = shower->begin_g4particle_id();jter != shower->end_g4particle_id(); ++jter)
-            //   // {
-            //   //   int g4particle_id = *jter;
-            //   //   PHG4Particle* particle = truthinfocontainer->GetParticle(g4particle_id);
-            //   //   if (particle)
-            //   //   {
-            //   //     if(particle->get_e()>0.01*shower->get_edep()){
-            //   //       // cout << "\t\t\tparticle ID in shower: " << particle->get_track_id() << "\tPDG " << particle->get_pid() << "\tenergy: " << particle->get_e()<< endl;
-            //   //     }
-            //   //   }
-            //   // }
-            // }
-
-            PHG4Particle* primary = towerevalFHCAL->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_FHCAL_trueID[_nTowers_FHCAL] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalFHCAL->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_FHCAL_trueID[_nTowers_FHCAL] = -10;
-            }
-            _nTowers_FHCAL++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeFHCAL << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_FHCAL << "\tFHCAL towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeFHCAL << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS BECAL
-  //----------------------
-  if (_do_BECAL)
-  {
-    CaloRawTowerEval* towerevalBECAL = _caloevalstackBECAL->get_rawtower_eval();
-    _nTowers_BECAL = 0;
-    string towernodeBECAL = "TOWER_CALIB_BECAL";
-    RawTowerContainer* towersBECAL = findNode::getClass<RawTowerContainer>(topNode, towernodeBECAL.c_str());
-
-    if (Verbosity() > 0)
-    {
-      RawTowerContainer* towersBECAL1 = findNode::getClass<RawTowerContainer>(topNode, "TOWER_RAW_BECAL");
-      RawTowerContainer* towersBECAL2 = findNode::getClass<RawTowerContainer>(topNode, "TOWER_SIM_BECAL");
-      cout << "BECAL sim: " << towersBECAL2->size() << endl;
-      cout << "BECAL raw: " << towersBECAL1->size() << endl;
-      cout << "BECAL calib: " << towersBECAL->size() << endl;
-    }
-    if (towersBECAL)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving BECAL towers" << endl;
-      }
-      string towergeomnodeBECAL = "TOWERGEOM_BECAL";
-      RawTowerGeomContainer* towergeomBECAL = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeBECAL.c_str());
-      if (towergeomBECAL)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kBECAL])
-        {
-          // std::ostream *fout= new ofstream("test.list");
-          RawTowerGeomContainer::ConstRange all_towers = towergeomBECAL->get_tower_geometries();
-          // *fout << "Calorimeter ID: " << towergeomBECAL->get_calorimeter_id() << endl;
-          // *fout << "size: " << towergeomBECAL->size() << endl;
-          // towergeomBECAL->identify(*fout);
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kBECAL;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            // it->second->identify(*fout);
-            _calo_towers_N++;
-          }
-          _geometry_done[kBECAL] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-          // _calo_ID = kBECAL;
-          // _calo_ID = kBECAL;
-        }
-
-        RawTowerContainer::ConstRange begin_end = towersBECAL->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kBECAL]) continue;
-            _tower_BECAL_iEta[_nTowers_BECAL] = tower->get_bineta();
-            _tower_BECAL_iPhi[_nTowers_BECAL] = tower->get_binphi();
-            _tower_BECAL_E[_nTowers_BECAL] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalBECAL->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_BECAL_trueID[_nTowers_BECAL] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalBECAL->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_BECAL_trueID[_nTowers_BECAL] = -10;
-            }
-            _nTowers_BECAL++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeBECAL << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_BECAL << "\tBECAL towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeBECAL << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS HCALIN
-  //----------------------
-  if (_do_HCALIN)
-  {
-    CaloRawTowerEval* towerevalHCALIN = _caloevalstackHCALIN->get_rawtower_eval();
-    _nTowers_HCALIN = 0;
-    string towernodeHCALIN = "TOWER_CALIB_HCALIN";
-    RawTowerContainer* towersHCALIN = findNode::getClass<RawTowerContainer>(topNode, towernodeHCALIN.c_str());
-    if (towersHCALIN)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving HCAL towers" << endl;
-      }
-      string towergeomnodeHCALIN = "TOWERGEOM_HCALIN";
-      RawTowerGeomContainer* towergeomHCALIN = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeHCALIN.c_str());
-      if (towergeomHCALIN)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kHCALIN])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomHCALIN->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kHCALIN;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kHCALIN] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersHCALIN->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kHCALIN]) continue;
-            _tower_HCALIN_iEta[_nTowers_HCALIN] = tower->get_bineta();
-            _tower_HCALIN_iPhi[_nTowers_HCALIN] = tower->get_binphi();
-            _tower_HCALIN_E[_nTowers_HCALIN] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalHCALIN->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_HCALIN_trueID[_nTowers_HCALIN] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalHCALIN->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_HCALIN_trueID[_nTowers_HCALIN] = -10;
-            }
-            _nTowers_HCALIN++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeHCALIN << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_HCALIN << "\tHCALIN towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeHCALIN << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS HCALOUT
-  //----------------------
-  if (_do_HCALOUT)
-  {
-    CaloRawTowerEval* towerevalHCALOUT = _caloevalstackHCALOUT->get_rawtower_eval();
-    _nTowers_HCALOUT = 0;
-    string towernodeHCALOUT = "TOWER_CALIB_HCALOUT";
-    RawTowerContainer* towersHCALOUT = findNode::getClass<RawTowerContainer>(topNode, towernodeHCALOUT.c_str());
-    if (towersHCALOUT)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving HCAL towers" << endl;
-      }
-      string towergeomnodeHCALOUT = "TOWERGEOM_HCALOUT";
-      RawTowerGeomContainer* towergeomHCALOUT = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeHCALOUT.c_str());
-      if (towergeomHCALOUT)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kHCALOUT])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomHCALOUT->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kHCALOUT;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kHCALOUT] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersHCALOUT->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kHCALOUT]) continue;
-            _tower_HCALOUT_iEta[_nTowers_HCALOUT] = tower->get_bineta();
-            _tower_HCALOUT_iPhi[_nTowers_HCALOUT] = tower->get_binphi();
-            _tower_HCALOUT_E[_nTowers_HCALOUT] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalHCALOUT->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_HCALOUT_trueID[_nTowers_HCALOUT] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalHCALOUT->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_HCALOUT_trueID[_nTowers_HCALOUT] = -10;
-            }
-            _nTowers_HCALOUT++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeHCALOUT << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_HCALOUT << "\tHCALOUT towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeHCALOUT << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS EHCAL
-  //----------------------
-  if (_do_EHCAL)
-  {
-    CaloRawTowerEval* towerevalEHCAL = _caloevalstackEHCAL->get_rawtower_eval();
-    _nTowers_EHCAL = 0;
-    string towernodeEHCAL = "TOWER_CALIB_EHCAL";
-    RawTowerContainer* towersEHCAL = findNode::getClass<RawTowerContainer>(topNode, towernodeEHCAL.c_str());
-    if (towersEHCAL)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving HCAL towers" << endl;
-      }
-      string towergeomnodeEHCAL = "TOWERGEOM_EHCAL";
-      RawTowerGeomContainer* towergeomEHCAL = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeEHCAL.c_str());
-      if (towergeomEHCAL)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kEHCAL])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomEHCAL->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kEHCAL;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kEHCAL] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersEHCAL->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kEHCAL]) continue;
-            _tower_EHCAL_iEta[_nTowers_EHCAL] = tower->get_bineta();
-            _tower_EHCAL_iPhi[_nTowers_EHCAL] = tower->get_binphi();
-            _tower_EHCAL_E[_nTowers_EHCAL] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalEHCAL->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_EHCAL_trueID[_nTowers_EHCAL] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalEHCAL->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_EHCAL_trueID[_nTowers_EHCAL] = -10;
-            }
-            _nTowers_EHCAL++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeEHCAL << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_EHCAL << "\tEHCAL towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeEHCAL << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS DRCALO
-  //----------------------
-  if (_do_DRCALO)
-  {
-    CaloRawTowerEval* towerevalDRCALO = _caloevalstackDRCALO->get_rawtower_eval();
-    _nTowers_DRCALO = 0;
-    string towernodeDRCALO = "TOWER_CALIB_DRCALO";
-    RawTowerContainer* towersDRCALO = findNode::getClass<RawTowerContainer>(topNode, towernodeDRCALO.c_str());
-    if (towersDRCALO)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving DRCALO towers" << endl;
-      }
-      string towergeomnodeDRCALO = "TOWERGEOM_DRCALO";
-      RawTowerGeomContainer* towergeomDRCALO = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeDRCALO.c_str());
-      if (towergeomDRCALO)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kDRCALO])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomDRCALO->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kDRCALO;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kDRCALO] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        if (Verbosity() > 0)
-        {
-          cout << "found DRCALO geom" << endl;
-        }
-        RawTowerContainer::ConstRange begin_end = towersDRCALO->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          // if (dynamic_cast<RawTowerv2 *>(tower) == nullptr)
-          // {
-          //   cout << __PRETTY_FUNCTION__ << " : Fatal Error! "
-          //       << "Expect RawTowerv2, but found this tower:";
-          // tower->identify();
-          //   // exit(1);
-          // }
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kDRCALO]) continue;
-
-            _tower_DRCALO_iEta[_nTowers_DRCALO] = tower->get_bineta();
-            _tower_DRCALO_iPhi[_nTowers_DRCALO] = tower->get_binphi();
-            _tower_DRCALO_E[_nTowers_DRCALO] = tower->get_energy();
-            // cout << __LINE__ << endl;
-            _tower_DRCALO_NScint[_nTowers_DRCALO] = tower->get_scint_gammas();
-            _tower_DRCALO_NCerenkov[_nTowers_DRCALO] = tower->get_cerenkov_gammas();
-            // cout << "sci gammas: " << tower->get_scint_gammas() << "\tcerenk gammas: " << tower->get_cerenkov_gammas() << endl;
-
-            PHG4Particle* primary = towerevalDRCALO->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_DRCALO_trueID[_nTowers_DRCALO] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalDRCALO->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_DRCALO_trueID[_nTowers_DRCALO] = -10;
-            }
-            _nTowers_DRCALO++;
-          }
-        }
-        if (Verbosity() > 0)
-        {
-          cout << "finished DRCALO twr loop" << endl;
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeDRCALO << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_DRCALO << "\tDRCALO towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeDRCALO << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS FOCAL
-  //----------------------
-  if (_do_FOCAL)
-  {
-    CaloRawTowerEval* towerevalFOCAL = _caloevalstackFOCAL->get_rawtower_eval();
-    _nTowers_FOCAL = 0;
-    string towernodeFOCAL = "TOWER_CALIB_FOCAL";
-    RawTowerContainer* towersFOCAL = findNode::getClass<RawTowerContainer>(topNode, towernodeFOCAL.c_str());
-    if (towersFOCAL)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving FOCAL towers" << endl;
-      }
-      string towergeomnodeFOCAL = "TOWERGEOM_FOCAL";
-      RawTowerGeomContainer* towergeomFOCAL = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeFOCAL.c_str());
-      if (towergeomFOCAL)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kFOCAL])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomFOCAL->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kFOCAL;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kFOCAL] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        if (Verbosity() > 0)
-        {
-          cout << "found FOCAL geom" << endl;
-        }
-        RawTowerContainer::ConstRange begin_end = towersFOCAL->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kFOCAL]) continue;
-
-            _tower_FOCAL_iEta[_nTowers_FOCAL] = tower->get_bineta();
-            _tower_FOCAL_iPhi[_nTowers_FOCAL] = tower->get_binphi();
-            _tower_FOCAL_E[_nTowers_FOCAL] = tower->get_energy();
-            _tower_FOCAL_NScint[_nTowers_FOCAL] = tower->get_scint_gammas();
-            _tower_FOCAL_NCerenkov[_nTowers_FOCAL] = tower->get_cerenkov_gammas();
-
-            PHG4Particle* primary = towerevalFOCAL->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_FOCAL_trueID[_nTowers_FOCAL] = primary->get_track_id();
-            }
-            else
-            {
-              _tower_FOCAL_trueID[_nTowers_FOCAL] = -10;
-            }
-            _nTowers_FOCAL++;
-          }
-        }
-        if (Verbosity() > 0)
-        {
-          cout << "finished FOCAL twr loop" << endl;
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeFOCAL << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_FOCAL << "\tFOCAL towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeFOCAL << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS LFHCAL
-  //----------------------
-  if (_do_LFHCAL)
-  {
-    CaloRawTowerEval* towerevalLFHCAL = _caloevalstackLFHCAL->get_rawtower_eval();
-    _nTowers_LFHCAL = 0;
-    string towernodeLFHCAL = "TOWER_CALIB_LFHCAL";
-    RawTowerContainer* towersLFHCAL = findNode::getClass<RawTowerContainer>(topNode, towernodeLFHCAL.c_str());
-    if (Verbosity() > 1)
-      std::cout << "reading towers: " << towersLFHCAL->size() << std::endl;
-    if (towersLFHCAL)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving LFHCAL towers" << endl;
-      }
-      string towergeomnodeLFHCAL = "TOWERGEOM_LFHCAL";
-      RawTowerGeomContainer* towergeomLFHCAL = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeLFHCAL.c_str());
-      if (towergeomLFHCAL)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kLFHCAL])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeomLFHCAL->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kLFHCAL;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = it->second->get_binl();
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kLFHCAL] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        if (Verbosity() > 0)
-        {
-          cout << "found LFHCAL geom" << endl;
-        }
-
-        RawTowerContainer::ConstRange begin_end = towersLFHCAL->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kLFHCAL]) continue;
-            if (Verbosity() > 1) cout << "\n event eval: \t" << tower->get_energy() << "\t ieta: " << tower->get_bineta() << "\t iphi: " << tower->get_binphi() << "\t iZ: " << tower->get_binl() << endl;
-            _tower_LFHCAL_iEta[_nTowers_LFHCAL] = tower->get_bineta();
-            _tower_LFHCAL_iPhi[_nTowers_LFHCAL] = tower->get_binphi();
-            _tower_LFHCAL_iL[_nTowers_LFHCAL] = tower->get_binl();
-            _tower_LFHCAL_E[_nTowers_LFHCAL] = tower->get_energy();
-            PHG4Particle* primary = towerevalLFHCAL->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_LFHCAL_trueID[_nTowers_LFHCAL] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalLFHCAL->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_LFHCAL_trueID[_nTowers_LFHCAL] = -10;
-            }
-            _nTowers_LFHCAL++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeLFHCAL << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_LFHCAL << "\tLFHCAL towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeLFHCAL << endl;
-      }
-      // return;
-    }
-  }
-
-  //----------------------
-  //    TOWERS FEMC
-  //----------------------
-  if (_do_FEMC)
-  {
-    CaloRawTowerEval* towerevalFEMC = _caloevalstackFEMC->get_rawtower_eval();
-    _nTowers_FEMC = 0;
-    string towernodeFEMC = "TOWER_CALIB_FEMC";
-    RawTowerContainer* towersFEMC = findNode::getClass<RawTowerContainer>(topNode, towernodeFEMC.c_str());
-    if (towersFEMC)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving EMC towers" << endl;
-      }
-      string towergeomnodeFEMC = "TOWERGEOM_FEMC";
-      RawTowerGeomContainer* towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeFEMC.c_str());
-      if (towergeom)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kFEMC])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeom->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kFEMC;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kFEMC] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersFEMC->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kFEMC]) continue;
-
-            _tower_FEMC_iEta[_nTowers_FEMC] = tower->get_bineta();
-            _tower_FEMC_iPhi[_nTowers_FEMC] = tower->get_binphi();
-            _tower_FEMC_E[_nTowers_FEMC] = tower->get_energy();
-
-            // cout << "\tnew FEMC tower " << tower->get_energy() << endl;
-
-            PHG4Particle* primary = towerevalFEMC->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_FEMC_trueID[_nTowers_FEMC] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalFEMC->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_FEMC_trueID[_nTowers_FEMC] = -10;
-            }
-
-            // PHG4TruthInfoContainer* truthinfocontainer = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
-            // RawTower::ShowerConstRange shower_range = tower->get_g4showers();
-            // for (RawTower::ShowerConstIterator iter = shower_range.first;
-            //     iter != shower_range.second;
-            //     ++iter)
-            // {
-            //   PHG4Shower* shower = truthinfocontainer->GetShower(iter->first);
-            //   PHG4Particle* particleParent = truthinfocontainer->GetParticle(shower->get_parent_particle_id());
-            //     if (particleParent)
-            //     {
-            //       cout << "\t\tcurr shower parent id: " << shower->get_parent_particle_id() << " ("<< _tower_FEMC_trueID[_nTowers_FEMC] << ")\tPDG " << particleParent->get_pid() << "\tedep: " << shower->get_edep() << endl;
-            //     } else {
-            //       cout << "\t\tcurr shower parent id: " << shower->get_parent_particle_id() << endl;
-            //     }
-            //   for (PHG4Shower::ParticleIdIter jter = shower->begin_g4particle_id();jter != shower->end_g4particle_id(); ++jter)
-            //   {
-            //     int g4particle_id = *jter;
-            //     PHG4Particle* particle = truthinfocontainer->GetParticle(g4particle_id);
-            //     if (particle)
-            //     {
-            //       // if(particle->get_e()>0.1*shower->get_edep()){
-            //         // cout << "\t\t\tparticle ID in shower: " << particle->get_track_id() << "\tPDG " << particle->get_pid() << "\tenergy: " << particle->get_e()<< endl;
-            //       // }
-            //     }
-            //   }
-            // }
-            _nTowers_FEMC++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeFEMC << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_FEMC << "\tFEMC towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeFEMC << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS CEMC
-  //----------------------
-  if (_do_CEMC)
-  {
-    CaloRawTowerEval* towerevalCEMC = _caloevalstackCEMC->get_rawtower_eval();
-    _nTowers_CEMC = 0;
-    string towernodeCEMC = "TOWER_CALIB_CEMC";
-    RawTowerContainer* towersCEMC = findNode::getClass<RawTowerContainer>(topNode, towernodeCEMC.c_str());
-    if (towersCEMC)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving EMC towers" << endl;
-      }
-      string towergeomnodeCEMC = "TOWERGEOM_CEMC";
-      RawTowerGeomContainer* towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeCEMC.c_str());
-      if (towergeom)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kCEMC])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeom->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kCEMC;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kCEMC] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersCEMC->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kCEMC]) continue;
-
-            _tower_CEMC_iEta[_nTowers_CEMC] = tower->get_bineta();
-            _tower_CEMC_iPhi[_nTowers_CEMC] = tower->get_binphi();
-            _tower_CEMC_E[_nTowers_CEMC] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalCEMC->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_CEMC_trueID[_nTowers_CEMC] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalCEMC->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_CEMC_trueID[_nTowers_CEMC] = -10;
-            }
-            _nTowers_CEMC++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeCEMC << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_CEMC << "\tCEMC towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeCEMC << endl;
-      }
-      // return;
-    }
-  }
-  //----------------------
-  //    TOWERS EEMC
-  //----------------------
-  if (_do_EEMC)
-  {
-    CaloRawTowerEval* towerevalEEMC = _caloevalstackEEMC->get_rawtower_eval();
-    _nTowers_EEMC = 0;
-    string towernodeEEMC = "TOWER_CALIB_EEMC";
-    RawTowerContainer* towersEEMC = findNode::getClass<RawTowerContainer>(topNode, towernodeEEMC.c_str());
-    if (towersEEMC)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving EMC towers" << endl;
-      }
-      string towergeomnodeEEMC = "TOWERGEOM_EEMC";
-      RawTowerGeomContainer* towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeEEMC.c_str());
-      if (towergeom)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kEEMC])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeom->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kEEMC;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kEEMC] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersEEMC->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kEEMC]) continue;
-
-            _tower_EEMC_iEta[_nTowers_EEMC] = tower->get_bineta();
-            _tower_EEMC_iPhi[_nTowers_EEMC] = tower->get_binphi();
-            _tower_EEMC_E[_nTowers_EEMC] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalEEMC->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_EEMC_trueID[_nTowers_EEMC] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalEEMC->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_EEMC_trueID[_nTowers_EEMC] = -10;
-            }
-            _nTowers_EEMC++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeEEMC << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_EEMC << "\tEEMC towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeEEMC << endl;
-      }
-      // return;
-    }
-  }
-
-  //----------------------
-  //    TOWERS EEMC
-  //----------------------
-  if (_do_EEMCG)
-  {
-    CaloRawTowerEval* towerevalEEMCG = _caloevalstackEEMCG->get_rawtower_eval();
-    _nTowers_EEMCG = 0;
-    string towernodeEEMCG = "TOWER_CALIB_EEMC_glass";
-    RawTowerContainer* towersEEMCG = findNode::getClass<RawTowerContainer>(topNode, towernodeEEMCG.c_str());
-    if (towersEEMCG)
-    {
-      if (Verbosity() > 0)
-      {
-        cout << "saving EMC towers" << endl;
-      }
-      string towergeomnodeEEMCG = "TOWERGEOM_EEMC_glass";
-      RawTowerGeomContainer* towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodeEEMCG.c_str());
-      if (towergeom)
-      {
-        if (_do_GEOMETRY && !_geometry_done[kEEMCG])
-        {
-          RawTowerGeomContainer::ConstRange all_towers = towergeom->get_tower_geometries();
-          for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
-               it != all_towers.second; ++it)
-          {
-            _calo_ID = kEEMCG;
-            _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
-            _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
-            _calo_towers_iL[_calo_towers_N] = -1;
-            _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
-            _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
-            _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
-            _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
-            _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
-            _calo_towers_N++;
-          }
-          _geometry_done[kEEMCG] = 1;
-          _geometry_tree->Fill();
-          resetGeometryArrays();
-        }
-        RawTowerContainer::ConstRange begin_end = towersEEMCG->getTowers();
-        RawTowerContainer::ConstIterator rtiter;
-        for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
-        {
-          RawTower* tower = rtiter->second;
-          if (tower)
-          {
-            // min energy cut
-            if (tower->get_energy() < _reco_e_threshold[kEEMCG]) continue;
-
-            _tower_EEMCG_iEta[_nTowers_EEMCG] = tower->get_bineta();
-            _tower_EEMCG_iPhi[_nTowers_EEMCG] = tower->get_binphi();
-            _tower_EEMCG_E[_nTowers_EEMCG] = tower->get_energy();
-
-            PHG4Particle* primary = towerevalEEMCG->max_truth_primary_particle_by_energy(tower);
-            if (primary)
-            {
-              _tower_EEMCG_trueID[_nTowers_EEMCG] = primary->get_track_id();
-              // gflavor = primary->get_pid();
-              // efromtruth = towerevalEEMCG->get_energy_contribution(tower, primary);
-            }
-            else
-            {
-              _tower_EEMCG_trueID[_nTowers_EEMCG] = -10;
-            }
-            _nTowers_EEMCG++;
-          }
-        }
-      }
-      else
-      {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << " ERROR: Can't find " << towergeomnodeEEMCG << endl;
-        }
-        // return;
-      }
-      if (Verbosity() > 0)
-      {
-        cout << "saved\t" << _nTowers_EEMCG << "\tEEMCG towers" << endl;
-      }
-    }
-    else
-    {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " ERROR: Can't find " << towernodeEEMCG << endl;
-      }
-      // return;
-    }
-  }
-
-  //------------------------
-  // CLUSTERS FHCAL
-  //------------------------
-  if (Verbosity() > 0)
-  {
-    cout << "saving clusters" << endl;
-  }
-  if (_do_FHCAL && _do_CLUSTERS)
-  {
-    CaloRawClusterEval* clusterevalFHCAL = _caloevalstackFHCAL->get_rawcluster_eval();
-    _nclusters_FHCAL = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
-
-    string clusternodeFHCAL = "CLUSTER_FHCAL";
-    RawClusterContainer* clustersFHCAL = findNode::getClass<RawClusterContainer>(topNode, clusternodeFHCAL.c_str());
-    if (clustersFHCAL)
-    {
-      // for every cluster
-      for (const auto& iterator : clustersFHCAL->getClustersMap())
-      {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kFHCAL]) continue;
-
-        _cluster_FHCAL_E[_nclusters_FHCAL] = cluster->get_energy();
-        _cluster_FHCAL_NTower[_nclusters_FHCAL] = cluster->getNTowers();
-        _cluster_FHCAL_Phi[_nclusters_FHCAL] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_FHCAL_Eta[_nclusters_FHCAL] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_FHCAL_Eta[_nclusters_FHCAL] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        }
-        else
-          _cluster_FHCAL_Eta[_nclusters_FHCAL] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
-
-        PHG4Particle* primary = clusterevalFHCAL->max_truth_primary_particle_by_energy(cluster);
-
-        if (primary)
-        {
-          _cluster_FHCAL_trueID[_nclusters_FHCAL] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_FHCAL_trueID[_nclusters_FHCAL] = -10;
-        }
-
-        _nclusters_FHCAL++;
-      }
-    }
-    else
-    {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeFHCAL << endl;
-      // return;
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "saved\t" << _nclusters_FHCAL << "\tFHCAL clusters" << endl;
-    }
-  }
-  //------------------------
-  // CLUSTERS HCALIN
-  //------------------------
-  if (_do_HCALIN && _do_CLUSTERS)
-  {
-    CaloRawClusterEval* clusterevalHCALIN = _caloevalstackHCALIN->get_rawcluster_eval();
-    _nclusters_HCALIN = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
-
-    string clusternodeHCALIN = "CLUSTER_HCALIN";
-    RawClusterContainer* clustersHCALIN = findNode::getClass<RawClusterContainer>(topNode, clusternodeHCALIN.c_str());
-    if (clustersHCALIN)
-    {
-      // for every cluster
-      for (const auto& iterator : clustersHCALIN->getClustersMap())
-      {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kHCALIN]) continue;
-
-        _cluster_HCALIN_E[_nclusters_HCALIN] = cluster->get_energy();
-        _cluster_HCALIN_NTower[_nclusters_HCALIN] = cluster->getNTowers();
-        _cluster_HCALIN_Phi[_nclusters_HCALIN] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_HCALIN_Eta[_nclusters_HCALIN] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_HCALIN_Eta[_nclusters_HCALIN] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-          ;
-        }
-        else
-          _cluster_HCALIN_Eta[_nclusters_HCALIN] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
-
-        PHG4Particle* primary = clusterevalHCALIN->max_truth_primary_particle_by_energy(cluster);
-
-        if (primary)
-        {
-          _cluster_HCALIN_trueID[_nclusters_HCALIN] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_HCALIN_trueID[_nclusters_HCALIN] = -10;
-        }
-
-        _nclusters_HCALIN++;
-      }
-    }
-    else
-    {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeHCALIN << endl;
-      // return;
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "saved\t" << _nclusters_HCALIN << "\tHCALIN clusters" << endl;
-    }
-  }
-  //------------------------
-  // CLUSTERS HCALOUT
-  //------------------------
-  if (_do_HCALOUT && _do_CLUSTERS)
-  {
-    CaloRawClusterEval* clusterevalHCALOUT = _caloevalstackHCALOUT->get_rawcluster_eval();
-    _nclusters_HCALOUT = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
-
-    string clusternodeHCALOUT = "CLUSTER_HCALOUT";
-    RawClusterContainer* clustersHCALOUT = findNode::getClass<RawClusterContainer>(topNode, clusternodeHCALOUT.c_str());
-    if (clustersHCALOUT)
-    {
-      // for every cluster
-      for (const auto& iterator : clustersHCALOUT->getClustersMap())
-      {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kHCALOUT]) continue;
-
-        _cluster_HCALOUT_E[_nclusters_HCALOUT] = cluster->get_energy();
-        _cluster_HCALOUT_NTower[_nclusters_HCALOUT] = cluster->getNTowers();
-        _cluster_HCALOUT_Phi[_nclusters_HCALOUT] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_HCALOUT_Eta[_nclusters_HCALOUT] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_HCALOUT_Eta[_nclusters_HCALOUT] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-          ;
-        }
-        else
-          _cluster_HCALOUT_Eta[_nclusters_HCALOUT] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
-
-        PHG4Particle* primary = clusterevalHCALOUT->max_truth_primary_particle_by_energy(cluster);
-
-        if (primary)
-        {
-          _cluster_HCALOUT_trueID[_nclusters_HCALOUT] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_HCALOUT_trueID[_nclusters_HCALOUT] = -10;
-        }
-
-        _nclusters_HCALOUT++;
-      }
-    }
-    else
-    {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeHCALOUT << endl;
-      // return;
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "saved\t" << _nclusters_HCALOUT << "\tHCALOUT clusters" << endl;
-    }
-  }
-  //------------------------
-  // CLUSTERS EHCAL
-  //------------------------
-  if (_do_EHCAL && _do_CLUSTERS)
-  {
-    CaloRawClusterEval* clusterevalEHCAL = _caloevalstackEHCAL->get_rawcluster_eval();
-    _nclusters_EHCAL = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
-
-    string clusternodeEHCAL = "CLUSTER_EHCAL";
-    RawClusterContainer* clustersEHCAL = findNode::getClass<RawClusterContainer>(topNode, clusternodeEHCAL.c_str());
-    if (clustersEHCAL)
-    {
-      // for every cluster
-      for (const auto& iterator : clustersEHCAL->getClustersMap())
+      if (calo.enabled && !calo.geometryDone)
       {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kEHCAL]) continue;
-
-        _cluster_EHCAL_E[_nclusters_EHCAL] = cluster->get_energy();
-        _cluster_EHCAL_NTower[_nclusters_EHCAL] = cluster->getNTowers();
-        _cluster_EHCAL_Phi[_nclusters_EHCAL] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_EHCAL_Eta[_nclusters_EHCAL] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_EHCAL_Eta[_nclusters_EHCAL] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-          ;
-        }
-        else
-          _cluster_EHCAL_Eta[_nclusters_EHCAL] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
-
-        PHG4Particle* primary = clusterevalEHCAL->max_truth_primary_particle_by_energy(cluster);
-
-        if (primary)
-        {
-          _cluster_EHCAL_trueID[_nclusters_EHCAL] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_EHCAL_trueID[_nclusters_EHCAL] = -10;
-        }
-
-        _nclusters_EHCAL++;
+        fillGeometry(topNode, calo);
       }
     }
-    else
-    {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeEHCAL << endl;
-      // return;
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "saved\t" << _nclusters_EHCAL << "\tEHCAL clusters" << endl;
-    }
   }
-
-  //------------------------
-  // CLUSTERS FEMC
-  //------------------------
-  if (_do_FEMC && _do_CLUSTERS)
+  std::vector<std::function<bool()>> sections;
+  if (_do_HITS)
   {
-    CaloRawClusterEval* clusterevalFEMC = _caloevalstackFEMC->get_rawcluster_eval();
-    _nclusters_FEMC = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
-
-    string clusternodeFEMC = "CLUSTER_FEMC";
-    RawClusterContainer* clustersFEMC = findNode::getClass<RawClusterContainer>(topNode, clusternodeFEMC.c_str());
-    if (clustersFEMC)
-    {
-      // for every cluster
-      for (const auto& iterator : clustersFEMC->getClustersMap())
-      {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kFEMC]) continue;
-
-        _cluster_FEMC_E[_nclusters_FEMC] = cluster->get_energy();
-        _cluster_FEMC_NTower[_nclusters_FEMC] = cluster->getNTowers();
-        _cluster_FEMC_Phi[_nclusters_FEMC] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_FEMC_Eta[_nclusters_FEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_FEMC_Eta[_nclusters_FEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-          ;
-        }
-        else
-          _cluster_FEMC_Eta[_nclusters_FEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
-
-        PHG4Particle* primary = clusterevalFEMC->max_truth_primary_particle_by_energy(cluster);
-
-        if (primary)
-        {
-          _cluster_FEMC_trueID[_nclusters_FEMC] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_FEMC_trueID[_nclusters_FEMC] = -10;
-        }
-
-        _nclusters_FEMC++;
-      }
-    }
-    else
+    if (Verbosity() > 0)
     {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeFEMC << endl;
-      // return;
+      cout << "saving hits" << endl;
     }
-    if (Verbosity() > 0)
+    // only the layers selected in Init are read, we do not want to save thousands of calorimeter hits!
+    PHG4TruthInfoContainer* truthinfocontainerHits = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+    for (unsigned int ilayer = 0; ilayer < _hit_layers.size(); ilayer++)
     {
-      cout << "saved\t" << _nclusters_FEMC << "\tFEMC clusters" << endl;
+      sections.push_back([this, topNode, ilayer, truthinfocontainerHits] {
+        fillHitLayer(topNode, _hit_layers[ilayer], truthinfocontainerHits, _hit_buffers[ilayer]);
+        return true;
+      });
     }
   }
-  //------------------------
-  // CLUSTERS CEMC
-  //------------------------
-  if (_do_CEMC && _do_CLUSTERS)
+  for (auto& calo : _calos)
   {
-    CaloRawClusterEval* clusterevalCEMC = _caloevalstackCEMC->get_rawcluster_eval();
-    _nclusters_CEMC = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
-
-    string clusternodeCEMC = "CLUSTER_CEMC";
-    RawClusterContainer* clustersCEMC = findNode::getClass<RawClusterContainer>(topNode, clusternodeCEMC.c_str());
-    if (clustersCEMC)
+    if (calo.enabled)
     {
-      // for every cluster
-      for (const auto& iterator : clustersCEMC->getClustersMap())
-      {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kCEMC]) continue;
-
-        _cluster_CEMC_E[_nclusters_CEMC] = cluster->get_energy();
-        _cluster_CEMC_NTower[_nclusters_CEMC] = cluster->getNTowers();
-        _cluster_CEMC_Phi[_nclusters_CEMC] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
+      sections.push_back([this, topNode, &calo, vertex] {
+        fillTowers(topNode, calo);
+        if (_do_CLUSTERS && calo.clusterArrays.maxSize > 0)
         {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_CEMC_Eta[_nclusters_CEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_CEMC_Eta[_nclusters_CEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-          ;
+          fillClusters(topNode, calo, vertex);
         }
-        else
-          _cluster_CEMC_Eta[_nclusters_CEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
+        return true;
+      });
+    }
+  }
+  if (_do_TRACKS)
+  {
+    sections.push_back([this, topNode] { return fillTracks(topNode); });
+  }
+  _nMCPart = 0;
+  if (_do_MCPARTICLES)
+  {
+    sections.push_back([this, topNode] { return fillMCParticles(topNode); });
+  }
+  _nHepmcp = 0;
+  if (_do_HEPMC)
+  {
+    sections.push_back([this, topNode] { return fillHepMC(topNode); });
+  }
+  // an event without the requested track, truth or HepMC nodes is not saved
+  if (!runFillTasks(sections))
+  {
+    return;
+  }
+  if (_do_HITS)
+  {
+    joinHits();
+  }
 
-        PHG4Particle* primary = clusterevalCEMC->max_truth_primary_particle_by_energy(cluster);
+#ifdef HAVE_RNTUPLE
+  if (_ntuple_writer)
+  {
+    fillNtuple();
+  }
+#endif
+  if (_writer.joinable())
+  {
+    queueEvent();
+  }
+  else
+  {
+    _event_tree->Fill();
+  }
 
-        if (primary)
-        {
-          _cluster_CEMC_trueID[_nclusters_CEMC] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_CEMC_trueID[_nclusters_CEMC] = -10;
-        }
+  if (Verbosity() > 0)
+  {
+    cout << "Resetting buffer ..." << endl;
+  }
+  resetBuffer();
+  if (Verbosity() > 0)
+  {
+    cout << "EventEvaluatorEIC buffer reset" << endl;
+  }
+  return;
+}
 
-        _nclusters_CEMC++;
-      }
-    }
-    else
-    {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeCEMC << endl;
-      // return;
-    }
+void EventEvaluatorEIC::fillHitLayer(PHCompositeNode* topNode, const HitLayer& layer, PHG4TruthInfoContainer* truth, std::vector<HitEntry>& buffer)
+{
+  buffer.clear();
+  PHG4HitContainer* hits = findNode::getClass<PHG4HitContainer>(topNode, layer.nodename);
+  if (!hits)
+  {
     if (Verbosity() > 0)
     {
-      cout << "saved\t" << _nclusters_CEMC << "\tCEMC clusters" << endl;
+      cout << __PRETTY_FUNCTION__ << " could not find " << layer.nodename << endl;
     }
+    return;
   }
-  //------------------------
-  // CLUSTERS EEMC
-  //------------------------
-  if (_do_EEMC && _do_CLUSTERS)
+  if (Verbosity() > 1)
   {
-    CaloRawClusterEval* clusterevalEEMC = _caloevalstackEEMC->get_rawcluster_eval();
-    _nclusters_EEMC = 0;
-    if (Verbosity() > 1)
-    {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
-    }
+    cout << __PRETTY_FUNCTION__ << " number of hits: " << hits->size() << endl;
+  }
+  addHits(hits, 0, truth, buffer);
+  if (Verbosity() > 0)
+  {
+    cout << "saved\t" << buffer.size() << "\thits for " << layer.name << endl;
+  }
 
-    string clusternodeEEMC = "CLUSTER_EEMC";
-    RawClusterContainer* clustersEEMC = findNode::getClass<RawClusterContainer>(topNode, clusternodeEEMC.c_str());
-    if (clustersEEMC)
+  if (_do_HITS_ABSORBER)
+  {
+    PHG4HitContainer* hitsAbs = findNode::getClass<PHG4HitContainer>(topNode, layer.nodenameAbs);
+    if (!hitsAbs)
     {
-      // for every cluster
-      for (const auto& iterator : clustersEEMC->getClustersMap())
+      if (Verbosity() > 0)
       {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kEEMC]) continue;
-
-        _cluster_EEMC_E[_nclusters_EEMC] = cluster->get_energy();
-        _cluster_EEMC_NTower[_nclusters_EEMC] = cluster->getNTowers();
-        _cluster_EEMC_Phi[_nclusters_EEMC] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_EEMC_Eta[_nclusters_EEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_EEMC_Eta[_nclusters_EEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-          ;
-        }
-        else
-          _cluster_EEMC_Eta[_nclusters_EEMC] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
-        ;
-
-        PHG4Particle* primary = clusterevalEEMC->max_truth_primary_particle_by_energy(cluster);
-
-        if (primary)
-        {
-          _cluster_EEMC_trueID[_nclusters_EEMC] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_EEMC_trueID[_nclusters_EEMC] = -10;
-        }
-
-        _nclusters_EEMC++;
+        cout << __PRETTY_FUNCTION__ << " could not find " << layer.nodenameAbs << endl;
       }
+      return;
     }
-    else
+    if (Verbosity() > 1)
     {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeEEMC << endl;
-      // return;
+      cout << __PRETTY_FUNCTION__ << " absorber number of hits: " << hitsAbs->size() << endl;
     }
+    const size_t nHits = buffer.size();
+    addHits(hitsAbs, 1, truth, buffer);
     if (Verbosity() > 0)
     {
-      cout << "saved\t" << _nclusters_EEMC << "\tEEMC clusters" << endl;
+      cout << "saved\t" << buffer.size() - nHits << "\thits for absorber of " << layer.name << endl;
     }
   }
-  //------------------------
-  // CLUSTERS EEMCG
-  //------------------------
-  if (_do_EEMCG && _do_CLUSTERS)
+}
+
+void EventEvaluatorEIC::addHits(PHG4HitContainer* hits, const int isAbsorber, PHG4TruthInfoContainer* truth, std::vector<HitEntry>& buffer)
+{
+  PHG4HitContainer::ConstRange hit_range = hits->getHits();
+  for (PHG4HitContainer::ConstIterator hit_iter = hit_range.first; hit_iter != hit_range.second; hit_iter++)
   {
-    CaloRawClusterEval* clusterevalEEMCG = _caloevalstackEEMCG->get_rawcluster_eval();
-    _nclusters_EEMCG = 0;
+    PHG4Hit* hit = hit_iter->second;
     if (Verbosity() > 1)
     {
-      cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
+      cout << __PRETTY_FUNCTION__ << " found hit with id " << hit->get_trkid() << endl;
     }
+    // joinHits drops everything beyond the limit of the hits arrays anyway
+    if (buffer.size() >= (size_t) _maxNHits) break;
+    buffer.push_back(HitEntry{truth ? GetHitTrueID(truth, hit) : 0,
+                              hit->get_x(0), hit->get_y(0), hit->get_z(0),
+                              hit->get_x(1), hit->get_y(1), hit->get_z(1),
+                              hit->get_t(0), hit->get_edep(), hit->get_light_yield(), isAbsorber});
+  }
+}
 
-    string clusternodeEEMCG = "CLUSTER_EEMC_glass";
-    RawClusterContainer* clustersEEMCG = findNode::getClass<RawClusterContainer>(topNode, clusternodeEEMCG.c_str());
-    if (clustersEEMCG)
-    {
-      // for every cluster
-      for (const auto& iterator : clustersEEMCG->getClustersMap())
-      {
-        RawCluster* cluster = iterator.second;
-
-        if (cluster->get_energy() < _reco_e_threshold[kEEMCG]) continue;
-
-        _cluster_EEMCG_E[_nclusters_EEMCG] = cluster->get_energy();
-        _cluster_EEMCG_NTower[_nclusters_EEMCG] = cluster->getNTowers();
-        _cluster_EEMCG_Phi[_nclusters_EEMCG] = cluster->get_phi();
-
-        // require vertex for cluster eta calculation
-        if (vertexmap)
-        {
-          if (!vertexmap->empty())
-          {
-            SvtxVertex* vertex = (vertexmap->begin()->second);
-            _cluster_EEMCG_Eta[_nclusters_EEMCG] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
-          }
-          else
-            _cluster_EEMCG_Eta[_nclusters_EEMCG] = -10000;
-        }
-        else
-          _cluster_EEMCG_Eta[_nclusters_EEMCG] = -10000;
-
-        PHG4Particle* primary = clusterevalEEMCG->max_truth_primary_particle_by_energy(cluster);
+int EventEvaluatorEIC::GetHitTrueID(PHG4TruthInfoContainer* truth, PHG4Hit* hit)
+{
+  PHG4Particle* particle = truth->GetParticle(hit->get_trkid());
+  if (particle->get_parent_id() == 0)
+  {
+    return hit->get_trkid();
+  }
 
-        if (primary)
-        {
-          _cluster_EEMCG_trueID[_nclusters_EEMCG] = primary->get_track_id();
-        }
-        else
-        {
-          _cluster_EEMCG_trueID[_nclusters_EEMCG] = -10;
-        }
+  PHG4Particle* g4particleMother = particle;
+  int mcSteps = 0;
+  while (g4particleMother->get_parent_id() != 0)
+  {
+    g4particleMother = truth->GetParticle(g4particleMother->get_parent_id());
+    if (g4particleMother == NULL) break;
+    mcSteps += 1;
+  }
+  if (mcSteps <= _depth_MCstack)
+  {
+    return hit->get_trkid();
+  }
 
-        _nclusters_EEMCG++;
-      }
-    }
-    else
+  // the parent of the ancestor mcSteps - _depth_MCstack steps up the stack
+  int trueID = 0;
+  PHG4Particle* g4particleMother2 = particle;
+  int mcSteps2 = 0;
+  while (g4particleMother2->get_parent_id() != 0 && (mcSteps2 < (mcSteps - _depth_MCstack + 1)))
+  {
+    g4particleMother2 = truth->GetParticle(g4particleMother2->get_parent_id());
+    if (g4particleMother2 == NULL)
     {
-      cerr << PHWHERE << " ERROR: Can't find " << clusternodeEEMCG << endl;
-      // return;
+      break;
     }
-    if (Verbosity() > 0)
-    {
-      cout << "saved\t" << _nclusters_EEMCG << "\tEEMCG clusters" << endl;
+    trueID = g4particleMother2->get_parent_id();
+    mcSteps2 += 1;
+  }
+  return trueID;
+}
+
+void EventEvaluatorEIC::joinHits()
+{
+  _nHitsLayers = 0;
+  for (unsigned int ilayer = 0; ilayer < _hit_layers.size(); ilayer++)
+  {
+    for (const auto& hit : _hit_buffers[ilayer])
+    {
+      if (!growOutputArrays(_hitArrays, _nHitsLayers)) return;
+      _hits_layerID[_nHitsLayers] = _hit_layers[ilayer].id;
+      _hits_trueID[_nHitsLayers] = hit.trueID;
+      _hits_x[_nHitsLayers] = hit.x;
+      _hits_y[_nHitsLayers] = hit.y;
+      _hits_z[_nHitsLayers] = hit.z;
+      _hits_x2[_nHitsLayers] = hit.x2;
+      _hits_y2[_nHitsLayers] = hit.y2;
+      _hits_z2[_nHitsLayers] = hit.z2;
+      _hits_t[_nHitsLayers] = hit.t;
+      _hits_edep[_nHitsLayers] = hit.edep;
+      _hits_lightyield[_nHitsLayers] = hit.lightyield;
+      _hits_isAbsorber[_nHitsLayers] = hit.isAbsorber;
+      _nHitsLayers++;
     }
   }
+}
 
-  //------------------------
-  // TRACKS
-  //------------------------
-  if (_do_TRACKS)
-  {
-    _nTracks = 0;
-    _nProjections = 0;
+bool EventEvaluatorEIC::fillTracks(PHCompositeNode* topNode)
+{
+  _nTracks = 0;
+  _nProjections = 0;
 
-    EICPIDParticleContainer* pidcontainer(nullptr);
+  EICPIDParticleContainer* pidcontainer(nullptr);
 
-    if (_do_PID_LogLikelihood)
+  if (_do_PID_LogLikelihood)
+  {
+    pidcontainer = findNode::getClass<EICPIDParticleContainer>(topNode, "EICPIDParticleMap");
+    if (pidcontainer == nullptr)
     {
-      pidcontainer = findNode::getClass<EICPIDParticleContainer>(topNode, "EICPIDParticleMap");
-      if (pidcontainer == nullptr)
-      {
-        cout << __PRETTY_FUNCTION__ << " Error: missing EICPIDParticleMap while _do_PID_LogLikelihood = "
-             << _do_PID_LogLikelihood << endl;
-      }
+      cout << __PRETTY_FUNCTION__ << " Error: missing EICPIDParticleMap while _do_PID_LogLikelihood = "
+           << _do_PID_LogLikelihood << endl;
     }
+  }
 
-    // Loop over track maps, identifiy each source.
-    // Although this configuration is fixed here, it doesn't require multiple sources.
-    // It will only store them if they're available.
-    std::vector<std::pair<std::string, TrackSource_t>> trackMapPairs = {
-        {"TrackMap", TrackSource_t::all},
-        {"InnerTrackMap", TrackSource_t::inner},
-        {"SiliconTrackMap", TrackSource_t::silicon},
-        {"TTLTrackMap", TrackSource_t::ttl}
-    };
-    bool foundAtLeastOneTrackSource = false;
-    for (const auto& trackMapInfo : trackMapPairs)
+  // Loop over track maps, identifiy each source.
+  // Although this configuration is fixed here, it doesn't require multiple sources.
+  // It will only store them if they're available.
+  std::vector<std::pair<std::string, TrackSource_t>> trackMapPairs = {
+      {"TrackMap", TrackSource_t::all},
+      {"InnerTrackMap", TrackSource_t::inner},
+      {"SiliconTrackMap", TrackSource_t::silicon},
+      {"TTLTrackMap", TrackSource_t::ttl}
+  };
+  bool foundAtLeastOneTrackSource = false;
+  for (const auto& trackMapInfo : trackMapPairs)
+  {
+    SvtxTrackMap* trackmap = findNode::getClass<SvtxTrackMap>(topNode, trackMapInfo.first);
+    if (trackmap)
     {
-      if (_nTracks >= _maxNTracks) break;
-
-      SvtxTrackMap* trackmap = findNode::getClass<SvtxTrackMap>(topNode, trackMapInfo.first);
-      if (trackmap)
+      foundAtLeastOneTrackSource = true;
+      int nTracksInASource = 0;
+      if (Verbosity() > 0)
       {
-        foundAtLeastOneTrackSource = true;
-        int nTracksInASource = 0;
-        if (Verbosity() > 0)
-        {
-          cout << "saving tracks for track map: " << trackMapInfo.first << endl;
-        }
-        for (SvtxTrackMap::ConstIter track_itr = trackmap->begin(); track_itr != trackmap->end(); track_itr++)
-        {
-          if (_nTracks >= _maxNTracks) break;
-
-          SvtxTrack_FastSim* track = dynamic_cast<SvtxTrack_FastSim*>(track_itr->second);
-          if (track)
+        cout << "saving tracks for track map: " << trackMapInfo.first << endl;
+      }
+      for (SvtxTrackMap::ConstIter track_itr = trackmap->begin(); track_itr != trackmap->end(); track_itr++)
+      {
+        SvtxTrack_FastSim* track = dynamic_cast<SvtxTrack_FastSim*>(track_itr->second);
+        if (track)
+        {
+          if (!growOutputArrays(_trackArrays, _nTracks)) break;
+          _track_ID[_nTracks] = track->get_id();
+          _track_charge[_nTracks] = track->get_charge();
+          _track_px[_nTracks] = track->get_px();
+          _track_py[_nTracks] = track->get_py();
+          _track_pz[_nTracks] = track->get_pz();
+          _track_x[_nTracks] = track->get_x();
+          _track_y[_nTracks] = track->get_y();
+          _track_z[_nTracks] = track->get_z();
+          _track_ndf[_nTracks] = track->get_ndf();
+          _track_chi2[_nTracks] = track->get_chisq();
+          // Ideally, would be dca3d_xy and dca3d_z, but these don't seem to be calculated properly in the
+          // current (June 2021) simulations (they return NaN). So we take dca (seems to be ~ the 3d distance)
+          // and dca_2d (seems to be ~ the distance in the transverse plane).
+          // The names of the branches are based on the method names.
+          _track_dca[_nTracks] = static_cast<float>(track->get_dca());
+          _track_dca_2d[_nTracks] = static_cast<float>(track->get_dca2d());
+          _track_trueID[_nTracks] = track->get_truth_track_id();
+          _track_source[_nTracks] = static_cast<unsigned short>(trackMapInfo.second);
+          if (_do_PROJECTIONS)
           {
-            _track_ID[_nTracks] = track->get_id();
-            _track_charge[_nTracks] = track->get_charge();
-            _track_px[_nTracks] = track->get_px();
-            _track_py[_nTracks] = track->get_py();
-            _track_pz[_nTracks] = track->get_pz();
-            _track_x[_nTracks] = track->get_x();
-            _track_y[_nTracks] = track->get_y();
-            _track_z[_nTracks] = track->get_z();
-            _track_ndf[_nTracks] = track->get_ndf();
-            _track_chi2[_nTracks] = track->get_chisq();
-            // Ideally, would be dca3d_xy and dca3d_z, but these don't seem to be calculated properly in the
-            // current (June 2021) simulations (they return NaN). So we take dca (seems to be ~ the 3d distance)
-            // and dca_2d (seems to be ~ the distance in the transverse plane).
-            // The names of the branches are based on the method names.
-            _track_dca[_nTracks] = static_cast<float>(track->get_dca());
-            _track_dca_2d[_nTracks] = static_cast<float>(track->get_dca2d());
-            _track_trueID[_nTracks] = track->get_truth_track_id();
-            _track_source[_nTracks] = static_cast<unsigned short>(trackMapInfo.second);
-            if (_do_PROJECTIONS)
+            // find projections
+            for (SvtxTrack::ConstStateIter trkstates = track->begin_states(); trkstates != track->end_states(); ++trkstates)
             {
-              // find projections
-              for (SvtxTrack::ConstStateIter trkstates = track->begin_states(); trkstates != track->end_states(); ++trkstates)
+              if (Verbosity() > 1)
               {
-                if (Verbosity() > 1)
-                {
-                  cout << __PRETTY_FUNCTION__ << " processing " << trkstates->second->get_name() << endl;
-                }
-                string trackStateName = trkstates->second->get_name();
-                if (Verbosity() > 1)
-                {
-                  cout << __PRETTY_FUNCTION__ << " found " << trkstates->second->get_name() << endl;
-                }
-                int trackStateIndex = GetProjectionIndex(trackStateName);
-                if (trackStateIndex > -1)
+                cout << __PRETTY_FUNCTION__ << " processing " << trkstates->second->get_name() << endl;
+              }
+              if (Verbosity() > 1)
+              {
+                cout << __PRETTY_FUNCTION__ << " found " << trkstates->second->get_name() << endl;
+              }
+              TrackState& trackState = GetTrackState(topNode, trkstates->second->get_name());
+              int trackStateIndex = trackState.id;
+              if (trackStateIndex > -1)
+              {
+                // save true projection info to given branch
+                if (!growOutputArrays(_projectionArrays, _nProjections)) break;
+                _track_TLP_x[_nProjections] = trkstates->second->get_pos(0);
+                _track_TLP_y[_nProjections] = trkstates->second->get_pos(1);
+                _track_TLP_z[_nProjections] = trkstates->second->get_pos(2);
+                _track_TLP_t[_nProjections] = trkstates->first;
+                _track_TLP_px[_nProjections] = trkstates->second->get_px();
+                _track_TLP_py[_nProjections] = trkstates->second->get_py();
+                _track_TLP_pz[_nProjections] = trkstates->second->get_pz();
+                _track_ProjLayer[_nProjections] = trackStateIndex;
+                _track_ProjTrackID[_nProjections] = _nTracks;
+
+                const string& nodename = trackState.nodename;
+                if (trackState.hits)
                 {
-                  // save true projection info to given branch
-                  _track_TLP_x[_nProjections] = trkstates->second->get_pos(0);
-                  _track_TLP_y[_nProjections] = trkstates->second->get_pos(1);
-                  _track_TLP_z[_nProjections] = trkstates->second->get_pos(2);
-                  _track_TLP_t[_nProjections] = trkstates->first;
-                  _track_TLP_px[_nProjections] = trkstates->second->get_px();
-                  _track_TLP_py[_nProjections] = trkstates->second->get_py();
-                  _track_TLP_pz[_nProjections] = trkstates->second->get_pz();
-                  _track_ProjLayer[_nProjections] = trackStateIndex;
-                  _track_ProjTrackID[_nProjections] = _nTracks;
-
-                  string nodename = "G4HIT_" + trkstates->second->get_name();
-                  PHG4HitContainer* hits = findNode::getClass<PHG4HitContainer>(topNode, nodename);
-                  if (hits)
+                  if (Verbosity() > 1)
                   {
-                    if (Verbosity() > 1)
-                    {
-                      cout << __PRETTY_FUNCTION__ << " number of hits: " << hits->size() << endl;
-                    }
-                    PHG4HitContainer::ConstRange hit_range = hits->getHits();
-                    for (PHG4HitContainer::ConstIterator hit_iter = hit_range.first; hit_iter != hit_range.second; hit_iter++)
-                    {
-                      if (Verbosity() > 1)
-                      {
-                        cout << __PRETTY_FUNCTION__ << " checking hit id " << hit_iter->second->get_trkid() << " against " << track->get_truth_track_id() << endl;
-                      }
-                      if (hit_iter->second->get_trkid() - track->get_truth_track_id() == 0)
-                      {
-                        if (Verbosity() > 1)
-                        {
-                          cout << __PRETTY_FUNCTION__ << " found hit with id " << hit_iter->second->get_trkid() << endl;
-                        }
-                        // save reco projection info to given branch
-                        _track_TLP_true_x[_nProjections] = hit_iter->second->get_x(0);
-                        _track_TLP_true_y[_nProjections] = hit_iter->second->get_y(0);
-                        _track_TLP_true_z[_nProjections] = hit_iter->second->get_z(0);
-                        _track_TLP_true_t[_nProjections] = hit_iter->second->get_t(0);
-                      }
-                    }
+                    cout << __PRETTY_FUNCTION__ << " number of hits: " << trackState.hits->size() << endl;
                   }
-                  else
+                  PHG4Hit* hit = GetTrackStateHit(trackState, track->get_truth_track_id());
+                  if (hit)
                   {
                     if (Verbosity() > 1)
                     {
-                      cout << __PRETTY_FUNCTION__ << " could not find " << nodename << endl;
+                      cout << __PRETTY_FUNCTION__ << " found hit with id " << hit->get_trkid() << endl;
                     }
-                    _track_TLP_true_x[_nProjections] = -10000;
-                    _track_TLP_true_y[_nProjections] = -10000;
-                    _track_TLP_true_z[_nProjections] = -10000;
-                    _track_TLP_true_t[_nProjections] = -10000;
+                    // save reco projection info to given branch
+                    _track_TLP_true_x[_nProjections] = hit->get_x(0);
+                    _track_TLP_true_y[_nProjections] = hit->get_y(0);
+                    _track_TLP_true_z[_nProjections] = hit->get_z(0);
+                    _track_TLP_true_t[_nProjections] = hit->get_t(0);
                   }
-                  _nProjections++;
                 }
-              }
-            }  //             if (_do_PROJECTIONS)
-
-            if (_do_PID_LogLikelihood)
-            {
-              // perform PID matching
-              if (trackMapInfo.second == TrackSource_t::all and pidcontainer != nullptr)
-              {
-                // only do so for the TrackSource_t::all
-                const EICPIDParticle* pid_particle =
-                    pidcontainer->findEICPIDParticle(track->get_id());
-
-                if (pid_particle)
+                else
                 {
-                  if ((unsigned int) _nTracks >= _track_pion_LL.size())
+                  if (Verbosity() > 1)
                   {
-                    cout << __PRETTY_FUNCTION__
-                         << " logical error _nTracks = " << _nTracks
-                         << " logical error _track_pion_LL.size() = " << _track_pion_LL.size()
-                         << endl;
-                    exit(1);
+                    cout << __PRETTY_FUNCTION__ << " could not find " << nodename << endl;
                   }
-
-                  _track_pion_LL[_nTracks] = pid_particle->get_SumLogLikelyhood(EICPIDDefs::PionCandiate);
-                  _track_kaon_LL[_nTracks] = pid_particle->get_SumLogLikelyhood(EICPIDDefs::KaonCandiate);
-                  _track_proton_LL[_nTracks] = pid_particle->get_SumLogLikelyhood(EICPIDDefs::ProtonCandiate);
+                  _track_TLP_true_x[_nProjections] = -10000;
+                  _track_TLP_true_y[_nProjections] = -10000;
+                  _track_TLP_true_z[_nProjections] = -10000;
+                  _track_TLP_true_t[_nProjections] = -10000;
                 }
+                _nProjections++;
               }
-            }  // if (_do_PID_LogLikelihood )
+            }
+          }  //             if (_do_PROJECTIONS)
 
-            _nTracks++;
-            nTracksInASource++;
-          }
-          else
+          if (_do_PID_LogLikelihood)
           {
-            if (Verbosity() > 0)  //Verbosity()
+            // perform PID matching
+            if (trackMapInfo.second == TrackSource_t::all and pidcontainer != nullptr)
             {
-              cout << "PHG4TrackFastSimEval::fill_track_tree - ignore track that is not a SvtxTrack_FastSim:";
-              track_itr->second->identify();
+              // only do so for the TrackSource_t::all
+              const EICPIDParticle* pid_particle =
+                  pidcontainer->findEICPIDParticle(track->get_id());
+
+              if (pid_particle)
+              {
+                if ((unsigned int) _nTracks >= _track_pion_LL.size())
+                {
+                  cout << __PRETTY_FUNCTION__
+                       << " logical error _nTracks = " << _nTracks
+                       << " logical error _track_pion_LL.size() = " << _track_pion_LL.size()
+                       << endl;
+                  exit(1);
+                }
+
+                _track_pion_LL[_nTracks] = pid_particle->get_SumLogLikelyhood(EICPIDDefs::PionCandiate);
+                _track_kaon_LL[_nTracks] = pid_particle->get_SumLogLikelyhood(EICPIDDefs::KaonCandiate);
+                _track_proton_LL[_nTracks] = pid_particle->get_SumLogLikelyhood(EICPIDDefs::ProtonCandiate);
+              }
             }
-            continue;
-          }
+          }  // if (_do_PID_LogLikelihood )
+
+          _nTracks++;
+          nTracksInASource++;
         }
-        if (Verbosity() > 0)
+        else
         {
-          cout << "saved\t" << nTracksInASource << "\ttracks from track map " << trackMapInfo.first << ". Total saved tracks: " << _nTracks << endl;
+          if (Verbosity() > 0)  //Verbosity()
+          {
+            cout << "PHG4TrackFastSimEval::fill_track_tree - ignore track that is not a SvtxTrack_FastSim:";
+            track_itr->second->identify();
+          }
+          continue;
         }
       }
-      else
+      if (Verbosity() > 0)
       {
-        if (Verbosity() > 0)
-        {
-          cout << PHWHERE << "SvtxTrackMap node with name '" << trackMapInfo.first << "' not found on node tree" << endl;
-        }
+        cout << "saved\t" << nTracksInASource << "\ttracks from track map " << trackMapInfo.first << ". Total saved tracks: " << _nTracks << endl;
       }
     }
-    if (foundAtLeastOneTrackSource == false)
-    {
-      cout << PHWHERE << "Requested tracks, but found no sources on node tree. Returning" << endl;
-      return;
-    }
-  }
-  //------------------------
-  // MC PARTICLES
-  //------------------------
-  _nMCPart = 0;
-  if (_do_MCPARTICLES)
-  {
-    PHG4TruthInfoContainer* truthinfocontainer = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
-    if (truthinfocontainer)
+    else
     {
       if (Verbosity() > 0)
       {
-        cout << "saving MC particles" << endl;
+        cout << PHWHERE << "SvtxTrackMap node with name '" << trackMapInfo.first << "' not found on node tree" << endl;
       }
-      //GetParticleRange for all particles
-      //GetPrimaryParticleRange for primary particles
-      PHG4TruthInfoContainer::ConstRange range = truthinfocontainer->GetParticleRange();
-      for (PHG4TruthInfoContainer::ConstIterator truth_itr = range.first; truth_itr != range.second; ++truth_itr)
-      {
-        PHG4Particle* g4particle = truth_itr->second;
-        if (!g4particle) continue;
+    }
+  }
+  if (foundAtLeastOneTrackSource == false)
+  {
+    cout << PHWHERE << "Requested tracks, but found no sources on node tree. Returning" << endl;
+    return false;
+  }
+  return true;
+}
 
-        int mcSteps = 0;
-        PHG4Particle* g4particleMother = truth_itr->second;
-        if (g4particle->get_parent_id() != 0)
-        {
-          while (g4particleMother->get_parent_id() != 0)
-          {
-            g4particleMother = truthinfocontainer->GetParticle(g4particleMother->get_parent_id());
-            if (g4particleMother == NULL) break;
-            mcSteps += 1;
-          }
-        }
-        if (mcSteps > _depth_MCstack) continue;
+bool EventEvaluatorEIC::fillMCParticles(PHCompositeNode* topNode)
+{
+  PHG4TruthInfoContainer* truthinfocontainer = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  if (truthinfocontainer)
+  {
+    if (Verbosity() > 0)
+    {
+      cout << "saving MC particles" << endl;
+    }
+    //GetParticleRange for all particles
+    //GetPrimaryParticleRange for primary particles
+    PHG4TruthInfoContainer::ConstRange range = truthinfocontainer->GetParticleRange();
+    for (PHG4TruthInfoContainer::ConstIterator truth_itr = range.first; truth_itr != range.second; ++truth_itr)
+    {
+      PHG4Particle* g4particle = truth_itr->second;
+      if (!g4particle) continue;
 
-        // evaluating true primary vertex
-        if (_do_VERTEX && _nMCPart == 0)
+      int mcSteps = 0;
+      PHG4Particle* g4particleMother = truth_itr->second;
+      if (g4particle->get_parent_id() != 0)
+      {
+        while (g4particleMother->get_parent_id() != 0)
         {
-          PHG4VtxPoint* vtx = truthinfocontainer->GetVtx(g4particle->get_vtx_id());
-          if (vtx)
-          {
-            _vertex_true_x = vtx->get_x();
-            _vertex_true_y = vtx->get_y();
-            _vertex_true_z = vtx->get_z();
-          }
+          g4particleMother = truthinfocontainer->GetParticle(g4particleMother->get_parent_id());
+          if (g4particleMother == NULL) break;
+          mcSteps += 1;
         }
+      }
+      if (mcSteps > _depth_MCstack) continue;
 
-        // in case of all MC particles, make restrictions on the secondary selection
-        // if(g4particle->get_track_id()<0 && g4particle->get_e()<0.5) continue;
-        // primary (g4particle->get_parent_id() == 0) selection via:
-        // if(gtrackID < 0) continue;
-
-        //using the e threshold also for the truth particles gets rid of all the low energy secondary particles
-        if (g4particle->get_e() < _reco_e_thresholdMC) continue;
-
-        _mcpart_ID[_nMCPart] = g4particle->get_track_id();
-        _mcpart_ID_parent[_nMCPart] = g4particle->get_parent_id();
-        _mcpart_PDG[_nMCPart] = g4particle->get_pid();
-        _mcpart_E[_nMCPart] = g4particle->get_e();
-        _mcpart_px[_nMCPart] = g4particle->get_px();
-        _mcpart_py[_nMCPart] = g4particle->get_py();
-        _mcpart_pz[_nMCPart] = g4particle->get_pz();
-        PHG4VtxPoint* vtxtmp = truthinfocontainer->GetVtx(g4particle->get_vtx_id());
-        if (vtxtmp)
+      // evaluating true primary vertex
+      if (_do_VERTEX && _nMCPart == 0)
+      {
+        PHG4VtxPoint* vtx = truthinfocontainer->GetVtx(g4particle->get_vtx_id());
+        if (vtx)
         {
-          _mcpart_x[_nMCPart] = vtxtmp->get_x();
-          _mcpart_y[_nMCPart] = vtxtmp->get_y();
-          _mcpart_z[_nMCPart] = vtxtmp->get_z();
+          _vertex_true_x = vtx->get_x();
+          _vertex_true_y = vtx->get_y();
+          _vertex_true_z = vtx->get_z();
         }
-        //BCID added for G4Particle --  HEPMC particle matching
-        _mcpart_BCID[_nMCPart] = g4particle->get_barcode();
-        // TVector3 projvec(_mcpart_px[0],_mcpart_py[0],_mcpart_pz[0]);
-        // float projeta = projvec.Eta();
-        _nMCPart++;
       }
-      if (Verbosity() > 0)
+
+      // in case of all MC particles, make restrictions on the secondary selection
+      // if(g4particle->get_track_id()<0 && g4particle->get_e()<0.5) continue;
+      // primary (g4particle->get_parent_id() == 0) selection via:
+      // if(gtrackID < 0) continue;
+
+      //using the e threshold also for the truth particles gets rid of all the low energy secondary particles
+      if (g4particle->get_e() < _reco_e_thresholdMC) continue;
+
+      if (!growOutputArrays(_mcpartArrays, _nMCPart)) break;
+      _mcpart_ID[_nMCPart] = g4particle->get_track_id();
+      _mcpart_ID_parent[_nMCPart] = g4particle->get_parent_id();
+      _mcpart_PDG[_nMCPart] = g4particle->get_pid();
+      _mcpart_E[_nMCPart] = g4particle->get_e();
+      _mcpart_px[_nMCPart] = g4particle->get_px();
+      _mcpart_py[_nMCPart] = g4particle->get_py();
+      _mcpart_pz[_nMCPart] = g4particle->get_pz();
+      PHG4VtxPoint* vtxtmp = truthinfocontainer->GetVtx(g4particle->get_vtx_id());
+      if (vtxtmp)
       {
-        cout << "saved\t" << _nMCPart << "\tMC particles" << endl;
+        _mcpart_x[_nMCPart] = vtxtmp->get_x();
+        _mcpart_y[_nMCPart] = vtxtmp->get_y();
+        _mcpart_z[_nMCPart] = vtxtmp->get_z();
       }
+      //BCID added for G4Particle --  HEPMC particle matching
+      _mcpart_BCID[_nMCPart] = g4particle->get_barcode();
+      // TVector3 projvec(_mcpart_px[0],_mcpart_py[0],_mcpart_pz[0]);
+      // float projeta = projvec.Eta();
+      _nMCPart++;
     }
-    else
+    if (Verbosity() > 0)
     {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " PHG4TruthInfoContainer node not found on node tree" << endl;
-      }
-      return;
+      cout << "saved\t" << _nMCPart << "\tMC particles" << endl;
+    }
+  }
+  else
+  {
+    if (Verbosity() > 0)
+    {
+      cout << PHWHERE << " PHG4TruthInfoContainer node not found on node tree" << endl;
     }
+    return false;
   }
+  return true;
+}
 
-  //------------------------
-  // HEPMC
-  //------------------------
-  _nHepmcp = 0;
-  if (_do_HEPMC)
+bool EventEvaluatorEIC::fillHepMC(PHCompositeNode* topNode)
+{
+  PHHepMCGenEventMap* hepmceventmap = findNode::getClass<PHHepMCGenEventMap>(topNode, "PHHepMCGenEventMap");
+  if (hepmceventmap)
   {
-    PHHepMCGenEventMap* hepmceventmap = findNode::getClass<PHHepMCGenEventMap>(topNode, "PHHepMCGenEventMap");
-    if (hepmceventmap)
+    if (Verbosity() > 0)
     {
-      if (Verbosity() > 0)
-      {
-        cout << "saving HepMC output" << endl;
-      }
-      if (Verbosity() > 0)
-      {
-        hepmceventmap->Print();
-      }
+      cout << "saving HepMC output" << endl;
+    }
+    if (Verbosity() > 0)
+    {
+      hepmceventmap->Print();
+    }
 
-      for (PHHepMCGenEventMap::ConstIter eventIter = hepmceventmap->begin();
-           eventIter != hepmceventmap->end();
-           ++eventIter)
-      {
-        PHHepMCGenEvent* hepmcevent = eventIter->second;
+    for (PHHepMCGenEventMap::ConstIter eventIter = hepmceventmap->begin();
+         eventIter != hepmceventmap->end();
+         ++eventIter)
+    {
+      PHHepMCGenEvent* hepmcevent = eventIter->second;
 
-        if (hepmcevent)
+      if (hepmcevent)
+      {
+        HepMC::GenEvent* truthevent = hepmcevent->getEvent();
+        if (!truthevent)
         {
-          HepMC::GenEvent* truthevent = hepmcevent->getEvent();
-          if (!truthevent)
-          {
-            cout << PHWHERE
-                 << "no evt pointer under phhepmvgeneventmap found "
-                 << endl;
-            return;
-          }
+          cout << PHWHERE
+               << "no evt pointer under phhepmvgeneventmap found "
+               << endl;
+          return false;
+        }
 
-          _hepmcp_vtx_x = hepmcevent->get_collision_vertex().x();
-          _hepmcp_vtx_y = hepmcevent->get_collision_vertex().y();
-          _hepmcp_vtx_z = hepmcevent->get_collision_vertex().z();
-          _hepmcp_vtx_t = hepmcevent->get_collision_vertex().t();
+        _hepmcp_vtx_x = hepmcevent->get_collision_vertex().x();
+        _hepmcp_vtx_y = hepmcevent->get_collision_vertex().y();
+        _hepmcp_vtx_z = hepmcevent->get_collision_vertex().z();
+        _hepmcp_vtx_t = hepmcevent->get_collision_vertex().t();
 
-          HepMC::PdfInfo* pdfinfo = truthevent->pdf_info();
+        HepMC::PdfInfo* pdfinfo = truthevent->pdf_info();
 
-          //     m_partid1 = pdfinfo->id1();
-          // m_partid2 = pdfinfo->id2();
-          _hepmcp_x1 = pdfinfo->x1();
-          _hepmcp_x2 = pdfinfo->x2();
-          _hepmcp_Q2 = pdfinfo->scalePDF();
+        //     m_partid1 = pdfinfo->id1();
+        // m_partid2 = pdfinfo->id2();
+        _hepmcp_x1 = pdfinfo->x1();
+        _hepmcp_x2 = pdfinfo->x2();
+        _hepmcp_Q2 = pdfinfo->scalePDF();
 
-          // m_mpi = truthevent->mpi();
+        // m_mpi = truthevent->mpi();
 
-          _hepmcp_procid = truthevent->signal_process_id();
+        _hepmcp_procid = truthevent->signal_process_id();
 
-          if (Verbosity() > 2)
-          {
-            cout << " Iterating over an event" << endl;
-          }
-          for (HepMC::GenEvent::particle_const_iterator iter = truthevent->particles_begin();
-               iter != truthevent->particles_end();
-               ++iter)
+        if (Verbosity() > 2)
+        {
+          cout << " Iterating over an event" << endl;
+        }
+        for (HepMC::GenEvent::particle_const_iterator iter = truthevent->particles_begin();
+             iter != truthevent->particles_end();
+             ++iter)
+        {
+          if (!growOutputArrays(_hepmcpArrays, _nHepmcp)) break;
+          _hepmcp_E[_nHepmcp] = (*iter)->momentum().e();
+          _hepmcp_PDG[_nHepmcp] = (*iter)->pdg_id();
+          _hepmcp_px[_nHepmcp] = (*iter)->momentum().px();
+          _hepmcp_py[_nHepmcp] = (*iter)->momentum().py();
+          _hepmcp_pz[_nHepmcp] = (*iter)->momentum().pz();
+          _hepmcp_status[_nHepmcp] = (*iter)->status();
+          _hepmcp_BCID[_nHepmcp] = (*iter)->barcode();
+          _hepmcp_m2[_nHepmcp] = 0;
+          _hepmcp_m1[_nHepmcp] = 0;
+          if ((*iter)->production_vertex())
           {
-            _hepmcp_E[_nHepmcp] = (*iter)->momentum().e();
-            _hepmcp_PDG[_nHepmcp] = (*iter)->pdg_id();
-            _hepmcp_px[_nHepmcp] = (*iter)->momentum().px();
-            _hepmcp_py[_nHepmcp] = (*iter)->momentum().py();
-            _hepmcp_pz[_nHepmcp] = (*iter)->momentum().pz();
-            _hepmcp_status[_nHepmcp] = (*iter)->status();
-            _hepmcp_BCID[_nHepmcp] = (*iter)->barcode();
-            _hepmcp_m2[_nHepmcp] = 0;
-            _hepmcp_m1[_nHepmcp] = 0;
-            if ((*iter)->production_vertex())
+            for (HepMC::GenVertex::particle_iterator mother = (*iter)->production_vertex()->particles_begin(HepMC::parents);
+                 mother != (*iter)->production_vertex()->particles_end(HepMC::parents);
+                 ++mother)
             {
-              for (HepMC::GenVertex::particle_iterator mother = (*iter)->production_vertex()->particles_begin(HepMC::parents);
-                   mother != (*iter)->production_vertex()->particles_end(HepMC::parents);
-                   ++mother)
-              {
-                _hepmcp_m2[_nHepmcp] = (*mother)->barcode();
-                if (_hepmcp_m1[_nHepmcp] == 0)
-                  _hepmcp_m1[_nHepmcp] = (*mother)->barcode();
-              }
+              _hepmcp_m2[_nHepmcp] = (*mother)->barcode();
+              if (_hepmcp_m1[_nHepmcp] == 0)
+                _hepmcp_m1[_nHepmcp] = (*mother)->barcode();
             }
-            if (Verbosity() > 2) cout << "nHepmcp " << _nHepmcp << "\tPDG " << _hepmcp_PDG[_nHepmcp] << "\tEnergy " << _hepmcp_E[_nHepmcp] << "\tbarcode " << _hepmcp_BCID[_nHepmcp] << "\tMother1 " << _hepmcp_m1[_nHepmcp] << "\tMother2 " << _hepmcp_m2[_nHepmcp] << endl;
-            _nHepmcp++;
           }
+          if (Verbosity() > 2) cout << "nHepmcp " << _nHepmcp << "\tPDG " << _hepmcp_PDG[_nHepmcp] << "\tEnergy " << _hepmcp_E[_nHepmcp] << "\tbarcode " << _hepmcp_BCID[_nHepmcp] << "\tMother1 " << _hepmcp_m1[_nHepmcp] << "\tMother2 " << _hepmcp_m2[_nHepmcp] << endl;
+          _nHepmcp++;
         }
       }
     }
-    else
+  }
+  else
+  {
+    if (Verbosity() > 0)
     {
-      if (Verbosity() > 0)
-      {
-        cout << PHWHERE << " PHHepMCGenEventMap node not found on node tree" << endl;
-      }
-      return;
+      cout << PHWHERE << " PHHepMCGenEventMap node not found on node tree" << endl;
     }
-  }  //hepmc
-
-  _event_tree->Fill();
+    return false;
+  }
+  return true;
+}
 
-  if (Verbosity() > 0)
+int EventEvaluatorEIC::End(PHCompositeNode* topNode)
+{
+  if (!_fill_workers.empty())
   {
-    cout << "Resetting buffer ..." << endl;
+    cout << Name() << "::End() - parallel filling on " << _fill_workers.size() + 1 << " threads: the detector sections took "
+         << (_nFilled > 0 ? 1e3 * _fillTaskTime / _nFilled : 0) << " ms per event, running them took "
+         << (_nFilled > 0 ? 1e3 * _fillTime / _nFilled : 0) << " ms per event" << endl;
+    stopFillWorkers();
   }
-  resetBuffer();
-  if (Verbosity() > 0)
+  if (_writer.joinable())
   {
-    cout << "EventEvaluatorEIC buffer reset" << endl;
+    stopWriter();
+    cout << Name() << "::End() - asynchronous output with " << _async_depth << " records: "
+         << _maxQueued << " events queued at most, " << (_nQueued > 0 ? (double) _sumQueued / _nQueued : 0) << " on average, "
+         << _nStalls << " events waited for the writer for " << 1e3 * _stallTime << " ms in total, tree filling took "
+         << (_nQueued > 0 ? 1e3 * _writeTime / _nQueued : 0) << " ms per event" << endl;
+  }
+
+  if (_ntuple_writer)
+  {
+    // the RNTuple is written when its writer is destroyed
+    _ntuple_writer.reset();
+    if (Verbosity() > 0)
+    {
+      cout << Name() << "::End() - RNTuple output written to: " << _rntuple_filename << endl;
+    }
   }
-  return;
-}
 
-int EventEvaluatorEIC::End(PHCompositeNode* topNode)
-{
   _tfile->cd();
 
   _event_tree->Write();
@@ -3570,791 +1704,401 @@ int EventEvaluatorEIC::End(PHCompositeNode* topNode)
     cout << "===========================================================================" << endl;
   }
 
-  if (_caloevalstackFHCAL) delete _caloevalstackFHCAL;
-  if (_caloevalstackBECAL) delete _caloevalstackBECAL;
-  if (_caloevalstackHCALIN) delete _caloevalstackHCALIN;
-  if (_caloevalstackHCALOUT) delete _caloevalstackHCALOUT;
-  if (_caloevalstackEHCAL) delete _caloevalstackEHCAL;
-  if (_caloevalstackDRCALO) delete _caloevalstackDRCALO;
-  if (_caloevalstackFOCAL) delete _caloevalstackFOCAL;
-  if (_caloevalstackLFHCAL) delete _caloevalstackLFHCAL;
-  if (_caloevalstackFEMC) delete _caloevalstackFEMC;
-  if (_caloevalstackCEMC) delete _caloevalstackCEMC;
-  if (_caloevalstackEEMC) delete _caloevalstackEEMC;
-  if (_caloevalstackEEMCG) delete _caloevalstackEEMCG;
+  std::vector<const OutputArrays*> allArrays = {&_hitArrays, &_trackArrays, &_projectionArrays, &_mcpartArrays, &_hepmcpArrays, &_geometryArrays};
+  for (const auto& calo : _calos)
+  {
+    allArrays.push_back(&calo.towerArrays);
+    allArrays.push_back(&calo.clusterArrays);
+  }
+  for (const auto* arrays : allArrays)
+  {
+    if (arrays->nOverflowEvents > 0)
+    {
+      cout << Name() << "::End() - WARNING: " << arrays->name << " truncated to " << arrays->maxSize
+           << " entries in " << arrays->nOverflowEvents << " events" << endl;
+    }
+  }
+
+  for (auto& calo : _calos)
+  {
+    delete calo.evalstack;
+    calo.evalstack = nullptr;
+  }
 
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
-int EventEvaluatorEIC::GetProjectionIndex(std::string projname)
+void EventEvaluatorEIC::add_projection_layer(const std::string& name, const int id, const ProjectionHits hits)
 {
-  if (projname.find("FTTL_0") != std::string::npos)
-    return 0;
-  else if (projname.find("FTTL_1") != std::string::npos)
-    return 1;
-  else if (projname.find("FTTL_2") != std::string::npos)
-    return 2;
-  else if (projname.find("ETTL_0") != std::string::npos)
-    return 3;
-  else if (projname.find("ETTL_1") != std::string::npos)
-    return 4;
-  else if (projname.find("LFHCAL") != std::string::npos)
-    return 5;
-  else if (projname.find("FEMC") != std::string::npos)
-    return 6;
-  else if (projname.find("CTTL_0") != std::string::npos)
-    return 7;
-  else if (projname.find("CTTL_1") != std::string::npos)
-    return 8;
-
-  else if (projname.find("LBLVTX_CENTRAL_10") != std::string::npos)
-    return 10;
-  else if (projname.find("LBLVTX_CENTRAL_11") != std::string::npos)
-    return 11;
-  else if (projname.find("LBLVTX_CENTRAL_12") != std::string::npos)
-    return 12;
-  else if (projname.find("LBLVTX_CENTRAL_13") != std::string::npos)
-    return 13;
-  else if (projname.find("LBLVTX_CENTRAL_14") != std::string::npos)
-    return 14;
-  else if (projname.find("LBLVTX_CENTRAL_15") != std::string::npos)
-    return 15;
-
-  else if (projname.find("LBLVTX_FORWARD_20") != std::string::npos)
-    return 20;
-  else if (projname.find("LBLVTX_FORWARD_21") != std::string::npos)
-    return 21;
-  else if (projname.find("LBLVTX_FORWARD_22") != std::string::npos)
-    return 22;
-  else if (projname.find("LBLVTX_FORWARD_23") != std::string::npos)
-    return 23;
-  else if (projname.find("LBLVTX_FORWARD_24") != std::string::npos)
-    return 24;
-
-  else if (projname.find("LBLVTX_BACKWARD_30") != std::string::npos)
-    return 30;
-  else if (projname.find("LBLVTX_BACKWARD_31") != std::string::npos)
-    return 31;
-  else if (projname.find("LBLVTX_BACKWARD_32") != std::string::npos)
-    return 32;
-  else if (projname.find("LBLVTX_BACKWARD_33") != std::string::npos)
-    return 33;
-  else if (projname.find("LBLVTX_BACKWARD_34") != std::string::npos)
-    return 34;
-
-  else if (projname.find("BARREL_0") != std::string::npos)
-    return 40;
-  else if (projname.find("BARREL_1") != std::string::npos)
-    return 41;
-  else if (projname.find("BARREL_2") != std::string::npos)
-    return 42;
-  else if (projname.find("BARREL_3") != std::string::npos)
-    return 43;
-  else if (projname.find("BARREL_4") != std::string::npos)
-    return 44;
-  else if (projname.find("BARREL_5") != std::string::npos)
-    return 45;
-
-  else if (projname.find("EFST_0") != std::string::npos)
-    return 100;
-  else if (projname.find("EFST_1") != std::string::npos)
-    return 101;
-  else if (projname.find("EFST_2") != std::string::npos)
-    return 102;
-  else if (projname.find("EFST_3") != std::string::npos)
-    return 103;
-  else if (projname.find("EFST_4") != std::string::npos)
-    return 104;
-  else if (projname.find("EFST_5") != std::string::npos)
-    return 105;
-  else if (projname.find("EFST_6") != std::string::npos)
-    return 106;
-
-  else if (projname.find("FST_0") != std::string::npos)
-    return 50;
-  else if (projname.find("FST_1") != std::string::npos)
-    return 51;
-  else if (projname.find("FST_2") != std::string::npos)
-    return 52;
-  else if (projname.find("FST_3") != std::string::npos)
-    return 53;
-  else if (projname.find("FST_4") != std::string::npos)
-    return 54;
-  else if (projname.find("FST_5") != std::string::npos)
-    return 55;
-  else if (projname.find("FST_6") != std::string::npos)
-    return 56;
-
-  else if (projname.find("EHCAL") != std::string::npos)
-    return 60;
-  else if (projname.find("EEMC") != std::string::npos)
-    return 61;
-  else if (projname.find("HCALIN") != std::string::npos)
-    return 62;
-  else if (projname.find("HCALOUT") != std::string::npos)
-    return 63;
-  else if (projname.find("CEMC") != std::string::npos)
-    return 64;
-  else if (projname.find("EEMC_glass_0") != std::string::npos)
-    return 65;
-  else if (projname.find("BECAL") != std::string::npos)
-    return 66;
-  // else if (projname.find("FHCAL") != std::string::npos)
-  //   return 67;
-
-  else if (projname.find("ZDCsurrogate") != std::string::npos)
-    return 70;
-  else if (projname.find("rpTruth") != std::string::npos)
-    return 71;
-  else if (projname.find("b0Truth") != std::string::npos)
-    return 72;
-  else if (projname.find("rpTruth2") != std::string::npos)
-    return 73;
-  else if (projname.find("offMomTruth") != std::string::npos)
-    return 74;
-
-  else if (projname.find("BH_1") != std::string::npos)
-    return 90;
-  else if (projname.find("BH_FORWARD_PLUS") != std::string::npos)
-    return 91;
-  else if (projname.find("BH_FORWARD_NEG") != std::string::npos)
-    return 92;
- 
-  else if (projname.find("RWELL_0") != std::string::npos)
-    return 110;
-  else if (projname.find("RWELL_1") != std::string::npos)
-    return 111;
-  else if (projname.find("RWELL_2") != std::string::npos)
-    return 112;
-
-
-  else if (projname.find("EST_0") != std::string::npos)
-    return 113;
-  else if (projname.find("EST_1") != std::string::npos)
-    return 114;
-  else if (projname.find("EST_2") != std::string::npos)
-    return 115;
-  else if (projname.find("EST_3") != std::string::npos)
-    return 116;
-  else if (projname.find("EST_4") != std::string::npos)
-    return 117;
-  else if (projname.find("EST_5") != std::string::npos)
-    return 118;
-  else if (projname.find("EST_6") != std::string::npos)
-    return 119;
-
-  else if (projname.find("FGEM_0") != std::string::npos)
-    return 120;
-  else if (projname.find("FGEM_1") != std::string::npos)
-    return 121;
-
-  else if (projname.find("EGEM_0") != std::string::npos)
-    return 130;
-  else if (projname.find("EGEM_1") != std::string::npos)
-    return 131;
-
-
-  else if (projname.find("LFHCAL_0") != std::string::npos)
-    return 140;
-  else if (projname.find("LFHCAL_1") != std::string::npos)
-    return 141;
-  else if (projname.find("LFHCAL_2") != std::string::npos)
-    return 142;
-  else if (projname.find("LFHCAL_3") != std::string::npos)
-    return 143;
-  else if (projname.find("LFHCAL_4") != std::string::npos)
-    return 144;
-  else if (projname.find("LFHCAL_5") != std::string::npos)
-    return 145;
-  else if (projname.find("LFHCAL_6") != std::string::npos)
-    return 146;
-  else if (projname.find("LFHCAL_7") != std::string::npos)
-    return 147;
-
-  else if (projname.find("BARR_0") != std::string::npos)
-    return 150;
-  else if (projname.find("BARR_1") != std::string::npos)
-    return 151;
-  else if (projname.find("BARR_2") != std::string::npos)
-    return 152;
-  else if (projname.find("BARR_3") != std::string::npos)
-    return 153;
-  else if (projname.find("BARR_4") != std::string::npos)
-    return 154;
-  else if (projname.find("SVTX_0") != std::string::npos)
-    return 155;
-  else if (projname.find("SVTX_1") != std::string::npos)
-    return 156;
-  else if (projname.find("SVTX_2") != std::string::npos)
-    return 157;
-  else if (projname.find("SVTX_3") != std::string::npos)
-    return 158;
-  else if (projname.find("SVTX_4") != std::string::npos)
-    return 159;
-
-  else if (projname.find("BARR") != std::string::npos)
-    return 160;
-  else if (projname.find("SVTX") != std::string::npos)
-    return 161;
-  else
-    return -1;
-  return -1;
+  _projection_layers.insert(_projection_layers.begin() + _nCustomProjectionLayers, ProjectionLayer{name, id, hits});
+  ++_nCustomProjectionLayers;
 }
 
-std::string EventEvaluatorEIC::GetProjectionNameFromIndex(int projindex)
+int EventEvaluatorEIC::add_calorimeter(const std::string& name, const std::string& nodename, const float threshold, const int maxNTowers, const int maxNClusters, const unsigned int fields)
 {
-  switch (projindex)
+  int id = 0;
+  for (const auto& calo : _calos)
   {
-  case 0:
-    return "FTTL_0";
-  case 1:
-    return "FTTL_1";
-  case 2:
-    return "FTTL_2";
-  case 3:
-    return "ETTL_0";
-  case 4:
-    return "ETTL_1";
-  case 5:
-    return "LFHCAL";
-  case 6:
-    return "FEMC";
-  case 7:
-    return "CTTL_0";
-  case 8:
-    return "CTTL_1";
-
-  case 10:
-    return "LBLVTX_CENTRAL_10";
-  case 11:
-    return "LBLVTX_CENTRAL_11";
-  case 12:
-    return "LBLVTX_CENTRAL_12";
-  case 13:
-    return "LBLVTX_CENTRAL_13";
-  case 14:
-    return "LBLVTX_CENTRAL_14";
-  case 15:
-    return "LBLVTX_CENTRAL_15";
-
-  case 20:
-    return "LBLVTX_FORWARD_20";
-  case 21:
-    return "LBLVTX_FORWARD_21";
-  case 22:
-    return "LBLVTX_FORWARD_22";
-  case 23:
-    return "LBLVTX_FORWARD_23";
-  case 24:
-    return "LBLVTX_FORWARD_24";
-
-  case 30:
-    return "LBLVTX_BACKWARD_30";
-  case 31:
-    return "LBLVTX_BACKWARD_31";
-  case 32:
-    return "LBLVTX_BACKWARD_32";
-  case 33:
-    return "LBLVTX_BACKWARD_33";
-  case 34:
-    return "LBLVTX_BACKWARD_34";
-
-  case 40:
-    return "BARREL_0";
-  case 41:
-    return "BARREL_1";
-  case 42:
-    return "BARREL_2";
-  case 43:
-    return "BARREL_3";
-  case 44:
-    return "BARREL_4";
-  case 45:
-    return "BARREL_5";
-
-  case 50:
-    return "FST_0";
-  case 51:
-    return "FST_1";
-  case 52:
-    return "FST_2";
-  case 53:
-    return "FST_3";
-  case 54:
-    return "FST_4";
-  case 55:
-    return "FST_5";
-  case 56 :
-    return "FST_6";
-
-  case 60:
-    return "EHCAL";
-  case 61:
-    return "EEMC";
-  case 62:
-    return "HCALIN";
-  case 63:
-    return "HCALOUT";
-  case 64:
-    return "CEMC";
-  case 65:
-    return "EEMC_glass";
-  case 66:
-    return "BECAL";
-  // case 67:
-  //   return "LFHCAL";
-
-  case 70:
-    return "ZDCsurrogate";
-  case 71:
-    return "rpTruth";
-  case 72:
-    return "b0Truth";
-  case 73:
-    return "rpTruth2";
-  case 74:
-    return "offMomTruth";
-
-  case 90:
-    return "BH_1";
-  case 91:
-    return "BH_FORWARD_PLUS";
-  case 92:
-    return "BH_FORWARD_NEG";
-
-  case 100:
-    return "EFST_0";
-  case 101:
-    return "EFST_1";
-  case 102:
-    return "EFST_2";
-  case 103:
-    return "EFST_3";
-  case 104:
-    return "EFST_4";
-  case 105:
-    return "EFST_5";
-
-  case 110:
-    return "RWELL_0";
-  case 111:
-    return "RWELL_1";
-  case 112:
-    return "RWELL_2";
-
-  case 113:
-    return "EST_0";
-  case 114:
-    return "EST_1";
-  case 115:
-    return "EST_2";
-  case 116:
-    return "EST_3";
-  case 117:
-    return "EST_4";
-  case 118:
-    return "EST_5";
-
-
-  case 120:
-    return "FGEM_0";
-  case 121:
-    return "FGEM_1";
-
-  case 130:
-    return "EGEM_0";
-  case 131:
-    return "EGEM_1";
-
-
-  case 140:
-    return "LFHCAL_0";
-  case 141:
-    return "LFHCAL_1";
-  case 142:
-    return "LFHCAL_2";
-  case 143:
-    return "LFHCAL_3";
-  case 144:
-    return "LFHCAL_4";
-  case 145:
-    return "LFHCAL_5";
-  case 146:
-    return "LFHCAL_6";
-  case 147:
-    return "LFHCAL_7";
-
-  case 150:
-    return "BARR_0";
-  case 151:
-    return "BARR_1";
-  case 152:
-    return "BARR_2";
-  case 153:
-    return "BARR_3";
-  case 154:
-    return "BARR_4";
-  case 155:
-    return "SVTX_0";
-  case 156:
-    return "SVTX_1";
-  case 157:
-    return "SVTX_2";
-  case 158:
-    return "SVTX_3";
-  case 159:
-    return "SVTX_4";
-
-  case 160:
-    return "BARR";
-  case 161:
-    return "SVTX";
-  default:
-    return "NOTHING";
+    id = std::max(id, calo.id + 1);
   }
+  _calos.push_back(CaloDescriptor(id, name, nodename, threshold, maxNTowers, maxNClusters, fields));
+  _calos.back().enabled = true;
+  return id;
 }
 
-void EventEvaluatorEIC::resetGeometryArrays()
+int EventEvaluatorEIC::GetProjectionIndex(const std::string& projname) const
 {
-  for (Int_t igeo = 0; igeo < _calo_towers_N; igeo++)
+  for (const auto& layer : _projection_layers)
   {
-    _calo_towers_iEta[_calo_towers_N] = -10000;
-    _calo_towers_iPhi[_calo_towers_N] = -10000;
-    _calo_towers_iL[_calo_towers_N] = -10000;
-    _calo_towers_Eta[_calo_towers_N] = -10000;
-    _calo_towers_Phi[_calo_towers_N] = -10000;
-    _calo_towers_x[_calo_towers_N] = -10000;
-    _calo_towers_y[_calo_towers_N] = -10000;
-    _calo_towers_z[_calo_towers_N] = -10000;
+    if (projname.find(layer.name) != std::string::npos)
+    {
+      return layer.id;
+    }
   }
-  _calo_ID = -1;
-  _calo_towers_N = 0;
+  return -1;
 }
-void EventEvaluatorEIC::resetBuffer()
+
+EventEvaluatorEIC::CaloDescriptor* EventEvaluatorEIC::GetCalorimeter(const int caloid)
 {
-  if (_do_store_event_info)
+  for (auto& calo : _calos)
   {
-    _cross_section = 0;
-    _event_weight = 0;
-    _n_generator_accepted = 0;
-    if (Verbosity() > 0)
+    if (calo.id == caloid)
     {
-      cout << "\t... event info variables reset" << endl;
+      return &calo;
     }
   }
-  if (_do_VERTEX)
+  return nullptr;
+}
+
+EventEvaluatorEIC::TrackState& EventEvaluatorEIC::GetTrackState(PHCompositeNode* topNode, const std::string& statename)
+{
+  auto trackState = _track_states.find(statename);
+  if (trackState == _track_states.end())
   {
-    _vertex_x = -1000;
-    _vertex_y = -1000;
-    _vertex_z = -1000;
-    _vertex_NCont = 0;
-    _vertex_true_x = -1000;
-    _vertex_true_y = -1000;
-    _vertex_true_z = -1000;
-    if (Verbosity() > 0)
-    {
-      cout << "\t... vertex variables reset" << endl;
-    }
+    trackState = _track_states.emplace(statename, TrackState{GetProjectionIndex(statename), "G4HIT_" + statename, nullptr, _ievent, false, {}}).first;
+    trackState->second.hits = findNode::getClass<PHG4HitContainer>(topNode, trackState->second.nodename);
   }
-  if (_do_HITS)
+  else if (trackState->second.hitsEvent != _ievent)
   {
-    _nHitsLayers = 0;
-    for (Int_t ihit = 0; ihit < _maxNHits; ihit++)
-    {
-      _hits_layerID[ihit] = 0;
-      _hits_trueID[ihit] = 0;
-      _hits_x[ihit] = 0;
-      _hits_y[ihit] = 0;
-      _hits_z[ihit] = 0;
-      _hits_x2[ihit] = 0;
-      _hits_y2[ihit] = 0;
-      _hits_z2[ihit] = 0;
-      _hits_t[ihit] = 0;
-      _hits_edep[ihit] = 0;
-      _hits_lightyield[ihit] = 0;
-      _hits_isAbsorber[ihit] = 0;
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "\t... hit variables reset" << endl;
-    }
+    trackState->second.hits = findNode::getClass<PHG4HitContainer>(topNode, trackState->second.nodename);
+    trackState->second.hitsEvent = _ievent;
+    trackState->second.indexed = false;
+    trackState->second.hitsByTrkid.clear();
   }
-  if (_do_FHCAL)
+  return trackState->second;
+}
+
+PHG4Hit* EventEvaluatorEIC::GetTrackStateHit(TrackState& trackState, const int trkid)
+{
+  if (!trackState.hits)
   {
-    _nTowers_FHCAL = 0;
-    for (Int_t itow = 0; itow < _maxNTowers; itow++)
-    {
-      _tower_FHCAL_E[itow] = 0;
-      _tower_FHCAL_iEta[itow] = 0;
-      _tower_FHCAL_iPhi[itow] = 0;
-      _tower_FHCAL_trueID[itow] = 0;
-    }
-    if (_do_CLUSTERS)
-    {
-      _nclusters_FHCAL = 0;
-      for (Int_t itow = 0; itow < _maxNclusters; itow++)
-      {
-        _cluster_FHCAL_E[itow] = 0;
-        _cluster_FHCAL_Eta[itow] = 0;
-        _cluster_FHCAL_Phi[itow] = 0;
-        _cluster_FHCAL_NTower[itow] = 0;
-        _cluster_FHCAL_trueID[itow] = 0;
-      }
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "\t... FHCAL variables reset" << endl;
-    }
+    return nullptr;
   }
-  if (_do_BECAL)
+  if (!trackState.indexed)
   {
-    _nTowers_BECAL = 0;
-    for (Int_t itow = 0; itow < _maxNTowers; itow++)
-    {
-      _tower_BECAL_E[itow] = 0;
-      _tower_BECAL_iEta[itow] = 0;
-      _tower_BECAL_iPhi[itow] = 0;
-      _tower_BECAL_trueID[itow] = 0;
-    }
-    if (Verbosity() > 0)
+    // the last hit of a track wins, as in the linear search this index replaces
+    PHG4HitContainer::ConstRange hit_range = trackState.hits->getHits();
+    for (PHG4HitContainer::ConstIterator hit_iter = hit_range.first; hit_iter != hit_range.second; hit_iter++)
     {
-      cout << "\t... BECAL variables reset" << endl;
+      trackState.hitsByTrkid[hit_iter->second->get_trkid()] = hit_iter->second;
     }
+    trackState.indexed = true;
   }
-  if (_do_FEMC)
+  auto hit = trackState.hitsByTrkid.find(trkid);
+  return (hit != trackState.hitsByTrkid.end()) ? hit->second : nullptr;
+}
+
+void EventEvaluatorEIC::fillGeometry(PHCompositeNode* topNode, CaloDescriptor& calo)
+{
+  // like the towers, the geometry is saved once both the tower and the geometry node exist
+  RawTowerGeomContainer* towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, "TOWERGEOM_" + calo.nodename);
+  if (!towergeom || !findNode::getClass<RawTowerContainer>(topNode, "TOWER_CALIB_" + calo.nodename))
+  {
+    return;
+  }
+  RawTowerGeomContainer::ConstRange all_towers = towergeom->get_tower_geometries();
+  for (RawTowerGeomContainer::ConstIterator it = all_towers.first;
+       it != all_towers.second; ++it)
+  {
+    _calo_ID = calo.id;
+    if (!growOutputArrays(_geometryArrays, _calo_towers_N)) break;
+    _calo_towers_iEta[_calo_towers_N] = it->second->get_bineta();
+    _calo_towers_iPhi[_calo_towers_N] = it->second->get_binphi();
+    _calo_towers_iL[_calo_towers_N] = (calo.fields & kTowerLayer) ? it->second->get_binl() : -1;
+    _calo_towers_Eta[_calo_towers_N] = it->second->get_eta();
+    _calo_towers_Phi[_calo_towers_N] = it->second->get_phi();
+    _calo_towers_x[_calo_towers_N] = it->second->get_center_x();
+    _calo_towers_y[_calo_towers_N] = it->second->get_center_y();
+    _calo_towers_z[_calo_towers_N] = it->second->get_center_z();
+    _calo_towers_N++;
+  }
+  calo.geometryDone = true;
+  _geometry_tree->Fill();
+  resetGeometryArrays();
+}
+
+void EventEvaluatorEIC::fillTowers(PHCompositeNode* topNode, CaloDescriptor& calo)
+{
+  CaloRawTowerEval* towereval = calo.evalstack->get_rawtower_eval();
+  calo.nTowers = 0;
+  string towernode = "TOWER_CALIB_" + calo.nodename;
+  RawTowerContainer* towers = findNode::getClass<RawTowerContainer>(topNode, towernode);
+  if (!towers)
   {
-    _nTowers_FEMC = 0;
-    for (Int_t itow = 0; itow < _maxNTowers; itow++)
-    {
-      _tower_FEMC_E[itow] = 0;
-      _tower_FEMC_iEta[itow] = 0;
-      _tower_FEMC_iPhi[itow] = 0;
-      _tower_FEMC_trueID[itow] = 0;
-    }
-    if (_do_CLUSTERS)
-    {
-      _nclusters_FEMC = 0;
-      for (Int_t itow = 0; itow < _maxNclusters; itow++)
-      {
-        _cluster_FEMC_E[itow] = 0;
-        _cluster_FEMC_Eta[itow] = 0;
-        _cluster_FEMC_Phi[itow] = 0;
-        _cluster_FEMC_NTower[itow] = 0;
-        _cluster_FEMC_trueID[itow] = 0;
-      }
-    }
     if (Verbosity() > 0)
     {
-      cout << "\t... FEMC variables reset" << endl;
+      cout << PHWHERE << " ERROR: Can't find " << towernode << endl;
     }
+    return;
   }
-  if (_do_CEMC)
+  if (Verbosity() > 0)
   {
-    _nTowers_CEMC = 0;
-    for (Int_t itow = 0; itow < _maxNTowersCentral; itow++)
-    {
-      _tower_CEMC_E[itow] = 0;
-      _tower_CEMC_iEta[itow] = 0;
-      _tower_CEMC_iPhi[itow] = 0;
-      _tower_CEMC_trueID[itow] = 0;
-    }
-    if (_do_CLUSTERS)
-    {
-      _nclusters_CEMC = 0;
-      for (Int_t itow = 0; itow < _maxNclustersCentral; itow++)
-      {
-        _cluster_CEMC_E[itow] = 0;
-        _cluster_CEMC_Eta[itow] = 0;
-        _cluster_CEMC_Phi[itow] = 0;
-        _cluster_CEMC_NTower[itow] = 0;
-        _cluster_CEMC_trueID[itow] = 0;
-      }
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "\t... CEMC variables reset" << endl;
-    }
+    cout << "saving " << calo.name << " towers" << endl;
   }
-  if (_do_HCALIN)
+  string towergeomnode = "TOWERGEOM_" + calo.nodename;
+  RawTowerGeomContainer* towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnode);
+  if (!towergeom)
   {
-    _nTowers_HCALIN = 0;
-    for (Int_t itow = 0; itow < _maxNTowersCentral; itow++)
-    {
-      _tower_HCALIN_E[itow] = 0;
-      _tower_HCALIN_iEta[itow] = 0;
-      _tower_HCALIN_iPhi[itow] = 0;
-      _tower_HCALIN_trueID[itow] = 0;
-    }
-    if (_do_CLUSTERS)
-    {
-      _nclusters_HCALIN = 0;
-      for (Int_t itow = 0; itow < _maxNclusters; itow++)
-      {
-        _cluster_HCALIN_E[itow] = 0;
-        _cluster_HCALIN_Eta[itow] = 0;
-        _cluster_HCALIN_Phi[itow] = 0;
-        _cluster_HCALIN_NTower[itow] = 0;
-        _cluster_HCALIN_trueID[itow] = 0;
-      }
-    }
     if (Verbosity() > 0)
     {
-      cout << "\t... HCALIN variables reset" << endl;
+      cout << PHWHERE << " ERROR: Can't find " << towergeomnode << endl;
     }
+    return;
   }
-  if (_do_HCALOUT)
+
+  RawTowerContainer::ConstRange begin_end = towers->getTowers();
+  for (RawTowerContainer::ConstIterator rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
   {
-    if (Verbosity() > 0)
+    RawTower* tower = rtiter->second;
+    if (!tower) continue;
+    // min energy cut
+    if (tower->get_energy() < calo.threshold) continue;
+    if (!growOutputArrays(calo.towerArrays, calo.nTowers)) break;
+    calo.towerE[calo.nTowers] = tower->get_energy();
+    calo.towerIEta[calo.nTowers] = tower->get_bineta();
+    calo.towerIPhi[calo.nTowers] = tower->get_binphi();
+    if (calo.fields & kTowerLayer)
     {
-      cout << "\t... resetting HCALOUT variables" << endl;
+      calo.towerIL[calo.nTowers] = tower->get_binl();
     }
-    _nTowers_HCALOUT = 0;
-    for (Int_t itow = 0; itow < _maxNTowersCentral; itow++)
+    if (calo.fields & kTowerPhotons)
     {
-      _tower_HCALOUT_E[itow] = 0;
-      _tower_HCALOUT_iEta[itow] = 0;
-      _tower_HCALOUT_iPhi[itow] = 0;
-      _tower_HCALOUT_trueID[itow] = 0;
-    }
-    if (_do_CLUSTERS)
-    {
-      _nclusters_HCALOUT = 0;
-      for (Int_t itow = 0; itow < _maxNclusters; itow++)
-      {
-        _cluster_HCALOUT_E[itow] = 0;
-        _cluster_HCALOUT_Eta[itow] = 0;
-        _cluster_HCALOUT_Phi[itow] = 0;
-        _cluster_HCALOUT_NTower[itow] = 0;
-        _cluster_HCALOUT_trueID[itow] = 0;
-      }
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "\t... HCALOUT variables reset" << endl;
+      calo.towerNScint[calo.nTowers] = tower->get_scint_gammas();
+      calo.towerNCerenkov[calo.nTowers] = tower->get_cerenkov_gammas();
     }
+
+    PHG4Particle* primary = GetTowerTruth(calo, towereval, tower).primary;
+    calo.towerTrueID[calo.nTowers] = primary ? primary->get_track_id() : -10;
+    calo.nTowers++;
   }
-  if (_do_EEMC)
+  if (Verbosity() > 0)
   {
-    if (Verbosity() > 0)
-    {
-      cout << "\t... resetting EEMC variables" << endl;
-    }
-    _nTowers_EEMC = 0;
-    for (Int_t itow = 0; itow < _maxNTowers; itow++)
-    {
-      _tower_EEMC_E[itow] = 0;
-      _tower_EEMC_iEta[itow] = 0;
-      _tower_EEMC_iPhi[itow] = 0;
-      _tower_EEMC_trueID[itow] = 0;
-    }
-    if (_do_CLUSTERS)
-    {
-      _nclusters_EEMC = 0;
-      for (Int_t itow = 0; itow < _maxNclusters; itow++)
-      {
-        _cluster_EEMC_E[itow] = 0;
-        _cluster_EEMC_Eta[itow] = 0;
-        _cluster_EEMC_Phi[itow] = 0;
-        _cluster_EEMC_NTower[itow] = 0;
-        _cluster_EEMC_trueID[itow] = 0;
-      }
-    }
-    if (Verbosity() > 0)
-    {
-      cout << "\t... EEMC variables reset" << endl;
-    }
+    cout << "saved\t" << calo.nTowers << "\t" << calo.name << " towers" << endl;
+  }
+}
+
+void EventEvaluatorEIC::fillClusters(PHCompositeNode* topNode, CaloDescriptor& calo, SvtxVertex* vertex)
+{
+  // the cluster truth is summed from the tower truth attribution cached for the towers of this calorimeter
+  CaloRawTowerEval* towereval = calo.evalstack->get_rawtower_eval();
+  RawTowerContainer* towers = findNode::getClass<RawTowerContainer>(topNode, "TOWER_CALIB_" + calo.nodename);
+  calo.nClusters = 0;
+  if (Verbosity() > 1)
+  {
+    cout << "CaloEvaluator::filling gcluster ntuple..." << endl;
   }
-  if (_do_EEMCG)
+
+  string clusternode = "CLUSTER_" + calo.nodename;
+  RawClusterContainer* clusters = findNode::getClass<RawClusterContainer>(topNode, clusternode);
+  if (!clusters)
   {
-    if (Verbosity() > 0)
+    cerr << PHWHERE << " ERROR: Can't find " << clusternode << endl;
+    return;
+  }
+  for (const auto& iterator : clusters->getClustersMap())
+  {
+    RawCluster* cluster = iterator.second;
+
+    if (cluster->get_energy() < calo.threshold) continue;
+
+    if (!growOutputArrays(calo.clusterArrays, calo.nClusters)) break;
+    calo.clusterE[calo.nClusters] = cluster->get_energy();
+    calo.clusterNTower[calo.nClusters] = cluster->getNTowers();
+    calo.clusterPhi[calo.nClusters] = cluster->get_phi();
+    if (vertex)
     {
-      cout << "\t... resetting EEMCG variables" << endl;
+      calo.clusterEta[calo.nClusters] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(vertex->get_x(), vertex->get_y(), vertex->get_z()));
     }
-    _nTowers_EEMCG = 0;
-    for (Int_t itow = 0; itow < _maxNTowers; itow++)
+    else if (calo.fields & kClusterEtaVertexOnly)
     {
-      _tower_EEMCG_E[itow] = 0;
-      _tower_EEMCG_iEta[itow] = 0;
-      _tower_EEMCG_iPhi[itow] = 0;
-      _tower_EEMCG_trueID[itow] = 0;
+      calo.clusterEta[calo.nClusters] = -10000;
     }
-    if (_do_CLUSTERS)
+    else
     {
-      _nclusters_EEMCG = 0;
-      for (Int_t itow = 0; itow < _maxNclusters; itow++)
-      {
-        _cluster_EEMCG_E[itow] = 0;
-        _cluster_EEMCG_Eta[itow] = 0;
-        _cluster_EEMCG_Phi[itow] = 0;
-        _cluster_EEMCG_NTower[itow] = 0;
-        _cluster_EEMCG_trueID[itow] = 0;
-      }
+      calo.clusterEta[calo.nClusters] = RawClusterUtility::GetPseudorapidity(*cluster, CLHEP::Hep3Vector(0, 0, 0));
     }
-    if (Verbosity() > 0)
+
+    PHG4Particle* primary = GetClusterTruth(calo, towereval, towers, cluster);
+    calo.clusterTrueID[calo.nClusters] = primary ? primary->get_track_id() : -10;
+    calo.nClusters++;
+  }
+  if (Verbosity() > 0)
+  {
+    cout << "saved\t" << calo.nClusters << "\t" << calo.name << " clusters" << endl;
+  }
+}
+
+const EventEvaluatorEIC::TowerTruth& EventEvaluatorEIC::GetTowerTruth(CaloDescriptor& calo, CaloRawTowerEval* towereval, RawTower* tower)
+{
+  auto inserted = calo.towerTruth.emplace(tower->get_id(), TowerTruth());
+  TowerTruth& towerTruth = inserted.first->second;
+  if (!inserted.second)
+  {
+    return towerTruth;
+  }
+  // same selection as CaloRawTowerEval::max_truth_primary_particle_by_energy
+  float max_e = -FLT_MAX;
+  for (PHG4Particle* primary : towereval->all_truth_primary_particles(tower))
+  {
+    float e = towereval->get_energy_contribution(tower, primary);
+    towerTruth.contributions.push_back(make_pair(primary, e));
+    if (std::isnan(e)) continue;
+    if (e > max_e)
     {
-      cout << "\t... EEMCG variables reset" << endl;
+      max_e = e;
+      towerTruth.primary = primary;
     }
   }
-  if (_do_DRCALO)
+  return towerTruth;
+}
+
+PHG4Particle* EventEvaluatorEIC::GetClusterTruth(CaloDescriptor& calo, CaloRawTowerEval* towereval, RawTowerContainer* towers, RawCluster* cluster)
+{
+  if (!towers)
+  {
+    return nullptr;
+  }
+  // energy of each primary summed over the towers of the cluster, in the order of
+  // CaloRawClusterEval::all_truth_primary_particles so that ties resolve the same way
+  map<PHG4Particle*, float> energies;
+  RawCluster::TowerConstRange tower_range = cluster->get_towers();
+  for (RawCluster::TowerConstIterator tower_iter = tower_range.first; tower_iter != tower_range.second; ++tower_iter)
   {
-    if (Verbosity() > 0)
+    RawTower* tower = towers->getTower(tower_iter->first);
+    if (!tower) continue;
+    for (const auto& contribution : GetTowerTruth(calo, towereval, tower).contributions)
     {
-      cout << "\t... resetting DRCALO variables" << endl;
+      float& e = energies[contribution.first];
+      if (!std::isnan(contribution.second)) e += contribution.second;
     }
-    _nTowers_DRCALO = 0;
-    for (Int_t itow = 0; itow < _maxNTowersDR; itow++)
+  }
+  PHG4Particle* max_primary = nullptr;
+  float max_e = -FLT_MAX;
+  for (const auto& energy : energies)
+  {
+    if (energy.second > max_e)
     {
-      _tower_DRCALO_E[itow] = 0;
-      _tower_DRCALO_NScint[itow] = 0;
-      _tower_DRCALO_NCerenkov[itow] = 0;
-      _tower_DRCALO_iEta[itow] = 0;
-      _tower_DRCALO_iPhi[itow] = 0;
-      _tower_DRCALO_trueID[itow] = 0;
+      max_e = energy.second;
+      max_primary = energy.first;
     }
+  }
+  return max_primary;
+}
+
+void EventEvaluatorEIC::resetGeometryArrays()
+{
+  // every geometry entry is written in full and calo_towers_N bounds what is read,
+  // so the arrays themselves do not need to be cleared
+  _calo_ID = -1;
+  _calo_towers_N = 0;
+}
+void EventEvaluatorEIC::resetBuffer()
+{
+  if (_do_store_event_info)
+  {
+    _cross_section = 0;
+    _event_weight = 0;
+    _n_generator_accepted = 0;
     if (Verbosity() > 0)
     {
-      cout << "\t... DRCALO variables reset" << endl;
+      cout << "\t... event info variables reset" << endl;
     }
   }
-  if (_do_FOCAL)
+  if (_do_VERTEX)
   {
+    _vertex_x = -1000;
+    _vertex_y = -1000;
+    _vertex_z = -1000;
+    _vertex_NCont = 0;
+    _vertex_true_x = -1000;
+    _vertex_true_y = -1000;
+    _vertex_true_z = -1000;
     if (Verbosity() > 0)
     {
-      cout << "\t... resetting FOCAL variables" << endl;
+      cout << "\t... vertex variables reset" << endl;
     }
-    _nTowers_FOCAL = 0;
-    for (Int_t itow = 0; itow < _maxNTowersDR; itow++)
+  }
+  if (_do_HITS)
+  {
+    _nHitsLayers = 0;
+    for (Int_t ihit = 0; ihit < _hitArrays.used; ihit++)
     {
-      _tower_FOCAL_E[itow] = 0;
-      _tower_FOCAL_NScint[itow] = 0;
-      _tower_FOCAL_NCerenkov[itow] = 0;
-      _tower_FOCAL_iEta[itow] = 0;
-      _tower_FOCAL_iPhi[itow] = 0;
-      _tower_FOCAL_trueID[itow] = 0;
+      _hits_layerID[ihit] = 0;
+      _hits_trueID[ihit] = 0;
+      _hits_x[ihit] = 0;
+      _hits_y[ihit] = 0;
+      _hits_z[ihit] = 0;
+      _hits_x2[ihit] = 0;
+      _hits_y2[ihit] = 0;
+      _hits_z2[ihit] = 0;
+      _hits_t[ihit] = 0;
+      _hits_edep[ihit] = 0;
+      _hits_lightyield[ihit] = 0;
+      _hits_isAbsorber[ihit] = 0;
     }
+    _hitArrays.used = 0;
     if (Verbosity() > 0)
     {
-      cout << "\t... FOCAL variables reset" << endl;
+      cout << "\t... hit variables reset" << endl;
     }
   }
-  if (_do_LFHCAL)
+  for (auto& calo : _calos)
   {
-    if (Verbosity() > 0)
+    if (!calo.enabled)
+    {
+      continue;
+    }
+    calo.nTowers = 0;
+    for (Int_t itow = 0; itow < calo.towerArrays.used; itow++)
     {
-      cout << "\t... resetting LFHCAL variables" << endl;
+      calo.towerE[itow] = 0;
+      calo.towerIEta[itow] = 0;
+      calo.towerIPhi[itow] = 0;
+      calo.towerTrueID[itow] = 0;
+      if (calo.fields & kTowerPhotons)
+      {
+        calo.towerNScint[itow] = 0;
+        calo.towerNCerenkov[itow] = 0;
+      }
+      if (calo.fields & kTowerLayer)
+      {
+        calo.towerIL[itow] = 0;
+      }
     }
-    _nTowers_LFHCAL = 0;
-    for (Int_t itow = 0; itow < _maxNTowers; itow++)
+    calo.towerArrays.used = 0;
+    calo.nClusters = 0;
+    for (Int_t iclus = 0; iclus < calo.clusterArrays.used; iclus++)
     {
-      _tower_LFHCAL_E[itow] = 0;
-      _tower_LFHCAL_iEta[itow] = 0;
-      _tower_LFHCAL_iPhi[itow] = 0;
-      _tower_LFHCAL_iL[itow] = 0;
-      _tower_LFHCAL_trueID[itow] = 0;
+      calo.clusterE[iclus] = 0;
+      calo.clusterEta[iclus] = 0;
+      calo.clusterPhi[iclus] = 0;
+      calo.clusterNTower[iclus] = 0;
+      calo.clusterTrueID[iclus] = 0;
     }
+    calo.clusterArrays.used = 0;
     if (Verbosity() > 0)
     {
-      cout << "\t... LFHCAL variables reset" << endl;
+      cout << "\t... " << calo.name << " variables reset" << endl;
     }
   }
   if (_do_TRACKS)
@@ -4364,7 +2108,7 @@ void EventEvaluatorEIC::resetBuffer()
       cout << "\t... resetting Track variables" << endl;
     }
     _nTracks = 0;
-    for (Int_t itrk = 0; itrk < _maxNTracks; itrk++)
+    for (Int_t itrk = 0; itrk < _trackArrays.used; itrk++)
     {
       _track_ID[itrk] = 0;
       _track_charge[itrk] = 0;
@@ -4386,10 +2130,11 @@ void EventEvaluatorEIC::resetBuffer()
       _track_kaon_LL[itrk] = -100;
       _track_proton_LL[itrk] = -100;
     }
+    _trackArrays.used = 0;
     if (_do_PROJECTIONS)
     {
       _nProjections = 0;
-      for (Int_t iproj = 0; iproj < _maxNProjections; iproj++)
+      for (Int_t iproj = 0; iproj < _projectionArrays.used; iproj++)
       {
         _track_ProjLayer[iproj] = -1;
         _track_ProjTrackID[iproj] = 0;
@@ -4405,6 +2150,7 @@ void EventEvaluatorEIC::resetBuffer()
         _track_TLP_true_z[iproj] = 0;
         _track_TLP_true_t[iproj] = 0;
       }
+      _projectionArrays.used = 0;
     }
     if (Verbosity() > 0)
     {
@@ -4414,7 +2160,7 @@ void EventEvaluatorEIC::resetBuffer()
   if (_do_MCPARTICLES)
   {
     _nMCPart = 0;
-    for (Int_t imcpart = 0; imcpart < _maxNMCPart; imcpart++)
+    for (Int_t imcpart = 0; imcpart < _mcpartArrays.used; imcpart++)
     {
       _mcpart_ID[imcpart] = 0;
       _mcpart_ID_parent[imcpart] = 0;
@@ -4428,6 +2174,7 @@ void EventEvaluatorEIC::resetBuffer()
       _mcpart_z[imcpart] = 0;
       _mcpart_BCID[imcpart] = -10;
     }
+    _mcpartArrays.used = 0;
   }
 
   if (_do_HEPMC)
@@ -4437,7 +2184,7 @@ void EventEvaluatorEIC::resetBuffer()
     _hepmcp_vtx_y = 0;
     _hepmcp_vtx_z = 0;
     _hepmcp_vtx_t = 0;
-    for (Int_t iHepmcp = 0; iHepmcp < _maxNHepmcp; iHepmcp++)
+    for (Int_t iHepmcp = 0; iHepmcp < _hepmcpArrays.used; iHepmcp++)
     {
       _hepmcp_E[iHepmcp] = 0;
       _hepmcp_PDG[iHepmcp] = 0;
@@ -4449,6 +2196,7 @@ void EventEvaluatorEIC::resetBuffer()
       _hepmcp_m2[iHepmcp] = 0;
       _hepmcp_m1[iHepmcp] = 0;
     }
+    _hepmcpArrays.used = 0;
     if (Verbosity() > 0)
     {
       cout << "\t... MC variables reset" << endl;
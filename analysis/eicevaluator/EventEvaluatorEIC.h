@@ -7,20 +7,50 @@
 /// \author Michael P. McCumber (revised sPHENIX version)
 //===============================================
 
+#include <calobase/RawTowerDefs.h>
+
 #include <fun4all/SubsysReco.h>
 
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class CaloEvalStack;
+class CaloRawTowerEval;
 class PHCompositeNode;
+class PHG4Hit;
+class PHG4HitContainer;
+class PHG4Particle;
+class PHG4TruthInfoContainer;
 class PHHepMCGenEventMap;
 class PHHepMCGenEvent;
+class RawCluster;
+class RawTower;
+class RawTowerContainer;
+class SvtxVertex;
+class TBranch;
 class TFile;
 class TNtuple;
 class TTree;  //Added by Barak
 
+namespace ROOT
+{
+  namespace Experimental
+  {
+    class RNTupleModel;
+    class RNTupleWriter;
+  }  // namespace Experimental
+}  // namespace ROOT
+
 /// \class EventEvaluatorEIC
 ///
 /// \brief Compares reconstructed showers to truth particles
@@ -42,7 +72,7 @@ class EventEvaluatorEIC : public SubsysReco
 
   EventEvaluatorEIC(const std::string& name = "EventEvaluatorEIC",
                     const std::string& filename = "g4eval_cemc.root");
-  ~EventEvaluatorEIC() override{};
+  ~EventEvaluatorEIC() override;
 
   int Init(PHCompositeNode* topNode) override;
   int process_event(PHCompositeNode* topNode) override;
@@ -51,18 +81,18 @@ class EventEvaluatorEIC : public SubsysReco
   void set_strict(bool b) { _strict = b; }
 
   void set_do_store_event_level_info(bool b) { _do_store_event_info = b; }
-  void set_do_FHCAL(bool b) { _do_FHCAL = b; }
-  void set_do_BECAL(bool b) { _do_BECAL = b; }
-  void set_do_HCALIN(bool b) { _do_HCALIN = b; }
-  void set_do_HCALOUT(bool b) { _do_HCALOUT = b; }
-  void set_do_EHCAL(bool b) { _do_EHCAL = b; }
-  void set_do_FEMC(bool b) { _do_FEMC = b; }
-  void set_do_CEMC(bool b) { _do_CEMC = b; }
-  void set_do_EEMC(bool b) { _do_EEMC = b; }
-  void set_do_EEMCG(bool b) { _do_EEMCG = b; }
-  void set_do_DRCALO(bool b) { _do_DRCALO = b; }
-  void set_do_FOCAL(bool b) { _do_FOCAL = b; }
-  void set_do_LFHCAL(bool b) { _do_LFHCAL = b; }
+  void set_do_FHCAL(bool b) { GetCalorimeter(kFHCAL)->enabled = b; }
+  void set_do_BECAL(bool b) { GetCalorimeter(kBECAL)->enabled = b; }
+  void set_do_HCALIN(bool b) { GetCalorimeter(kHCALIN)->enabled = b; }
+  void set_do_HCALOUT(bool b) { GetCalorimeter(kHCALOUT)->enabled = b; }
+  void set_do_EHCAL(bool b) { GetCalorimeter(kEHCAL)->enabled = b; }
+  void set_do_FEMC(bool b) { GetCalorimeter(kFEMC)->enabled = b; }
+  void set_do_CEMC(bool b) { GetCalorimeter(kCEMC)->enabled = b; }
+  void set_do_EEMC(bool b) { GetCalorimeter(kEEMC)->enabled = b; }
+  void set_do_EEMCG(bool b) { GetCalorimeter(kEEMCG)->enabled = b; }
+  void set_do_DRCALO(bool b) { GetCalorimeter(kDRCALO)->enabled = b; }
+  void set_do_FOCAL(bool b) { GetCalorimeter(kFOCAL)->enabled = b; }
+  void set_do_LFHCAL(bool b) { GetCalorimeter(kLFHCAL)->enabled = b; }
   void set_do_HITS(bool b) { _do_HITS = b; }
   void set_do_HITS_ABSORBER(bool b) { _do_HITS_ABSORBER = b; }
   void set_do_HITS_CALO(bool b) { _do_HITS_CALO = b; }
@@ -75,13 +105,26 @@ class EventEvaluatorEIC : public SubsysReco
   void set_do_HEPMC(bool b) { _do_HEPMC = b; }
   void set_do_GEOMETRY(bool b) { _do_GEOMETRY = b; }
   void set_do_BLACKHOLE(bool b) { _do_BLACKHOLE = b; }
+  //! fill the event tree on a background thread, process_event continues while up to
+  //! depth events wait to be written. 0 (default) fills the tree in process_event
+  void set_async_output(const unsigned int depth) { _async_depth = depth; }
+  //! also write the event tree content as RNTuple "event_ntuple" to filename, the arrays
+  //! of each detector and object type (towers, clusters, hits, tracks, ...) as one collection.
+  //! Only available if configure found a compatible ROOT RNTuple API, otherwise an error is printed
+  void set_rntuple_output(const std::string& filename);
+  //! fill each hit layer, each calorimeter, the tracks, the MC and the HepMC particles of an event as
+  //! concurrent tasks on n threads, 0 uses all hardware threads. 1 (default) fills them in turn
+  void set_fill_threads(const unsigned int n) { _fill_threads = n; }
 
   // limit the tracing of towers and clusters back to the truth particles
   // to only those reconstructed objects above a particular energy
   // threshold (evaluation for objects above threshold unaffected)
   void set_reco_tracing_energy_threshold(float thresh, int caloid)
   {
-    _reco_e_threshold[caloid] = thresh;
+    if (CaloDescriptor* calo = GetCalorimeter(caloid))
+    {
+      calo->threshold = thresh;
+    }
   }
   void set_reco_tracing_energy_thresholdMC(float thresh)
   {
@@ -94,20 +137,165 @@ class EventEvaluatorEIC : public SubsysReco
     _depth_MCstack = d;
   }
 
+  //! optional tower and cluster fields of a calorimeter
+  enum CaloFields
+  {
+    kTowerLayer = 1,           ///< tower_<name>_iL and the tower layer in the geometry tree
+    kTowerPhotons = 2,         ///< tower_<name>_NScint and tower_<name>_NCerenkov
+    kClusterEtaVertexOnly = 4  ///< cluster eta is -10000 without a reconstructed vertex
+  };
+  //! register a further calorimeter: towers from TOWER_CALIB_<nodename> (with TOWERGEOM_<nodename>),
+  //! clusters from CLUSTER_<nodename> if maxNClusters > 0, saved as tower_<name>_* and cluster_<name>_*.
+  //! Returns its id for set_reco_tracing_energy_threshold and the geometry tree, has to be called before Init.
+  int add_calorimeter(const std::string& name, const std::string& nodename, const float threshold,
+                      const int maxNTowers, const int maxNClusters = 0, const unsigned int fields = 0);
+
+  //! which G4HIT_<name> containers of a projection layer are saved in the hits branches
+  enum ProjectionHits
+  {
+    kNoHits = 0,
+    kHits = 1,
+    kCaloHits = 2,      ///< only with set_do_HITS_CALO
+    kBlackHoleHits = 3  ///< only with set_do_BLACKHOLE
+  };
+  //! register a projection layer: track states whose name contains name are saved with
+  //! ProjLayer id, and its hits with layerID id. Checked before the default layers,
+  //! has to be called before Init. The hits of a name are saved once, with the id of its
+  //! first layer, so a layer with the name of a default one moves those hits to id.
+  void add_projection_layer(const std::string& name, const int id, const ProjectionHits hits = kHits);
+  //! remove all projection layers, including the default ones
+  void clear_projection_layers()
+  {
+    _projection_layers.clear();
+    _nCustomProjectionLayers = 0;
+  }
+
  private:
+  //! output arrays that share one counter branch, they start small and grow with
+  //! the events up to maxSize, the branch addresses follow the reallocations
+  struct OutputArrays
+  {
+    OutputArrays(const std::string& n = "", const int max = 0, const std::string& ntuple = "")
+      : name(n)
+      , maxSize(max)
+      , ntupleName(ntuple)
+    {
+    }
+    std::string name;
+    int maxSize;
+    std::string ntupleName;                        ///< collection of the arrays in the RNTuple output
+    int size = 0;                                  ///< current length of each array
+    int used = 0;                                  ///< entries written since the last reset
+    int lastOverflowEvent = -1;                    ///< last event in which maxSize was exceeded
+    unsigned int nOverflowEvents = 0;              ///< number of events that did not fit
+    std::vector<std::function<void(int)>> resize;  ///< resize one array and rebind its branch
+    // RNTuple output
+    const int* counter = nullptr;                                                                    ///< event tree counter of the arrays
+    std::vector<std::function<std::function<void(int)>(ROOT::Experimental::RNTupleModel&)>> fields;  ///< add the field of one array to the collection model
+    std::vector<std::function<void(int)>> copy;                                                      ///< copy entry i of one array to its field
+    std::function<void()> fill;                                                                      ///< add the copied entry to the collection
+  };
+
+  struct ProjectionLayer
+  {
+    std::string name;  ///< matched as substring of the track state name
+    int id;
+    ProjectionHits hits;
+  };
+  //! hit containers read for the hits branches, selected in Init
+  struct HitLayer
+  {
+    int id;
+    std::string name;
+    std::string nodename;
+    std::string nodenameAbs;
+  };
+  //! one hit of a layer, collected by the task of the layer and copied to the hits arrays after all tasks
+  struct HitEntry
+  {
+    int trueID;
+    float x;
+    float y;
+    float z;
+    float x2;
+    float y2;
+    float z2;
+    float t;
+    float edep;
+    float lightyield;
+    int isAbsorber;
+  };
+  //! projection id and hit container of one track state name, the container is looked up once per event
+  //! and indexed by truth track id when the first projection onto it needs its true hit
+  struct TrackState
+  {
+    int id;
+    std::string nodename;
+    PHG4HitContainer* hits;
+    unsigned int hitsEvent;
+    bool indexed = false;
+    std::unordered_map<int, PHG4Hit*> hitsByTrkid;
+  };
+  //! truth attribution of one tower: energy contribution of each primary, ordered like
+  //! CaloRawTowerEval::all_truth_primary_particles, and the one with the largest energy
+  struct TowerTruth
+  {
+    std::vector<std::pair<PHG4Particle*, float>> contributions;
+    PHG4Particle* primary = nullptr;
+  };
+  //! one calorimeter of the tower and cluster output, all of them are filled by the same code
+  struct CaloDescriptor
+  {
+    CaloDescriptor(const int i, const std::string& n, const std::string& node, const float thresh,
+                   const int maxNTowers, const int maxNClusters, const unsigned int f = 0)
+      : id(i)
+      , name(n)
+      , nodename(node)
+      , threshold(thresh)
+      , fields(f)
+      , towerArrays(n + " towers", maxNTowers, "tower_" + n)
+      , clusterArrays(n + " clusters", maxNClusters, "cluster_" + n)
+    {
+    }
+    int id;                ///< calotype, saved as calo in the geometry tree
+    std::string name;      ///< tower_<name>_* and cluster_<name>_* branches
+    std::string nodename;  ///< suffix of the TOWER_CALIB_, TOWERGEOM_ and CLUSTER_ nodes, name of the CaloEvalStack
+    float threshold;       ///< reco energy threshold of the saved towers and clusters
+    unsigned int fields;   ///< CaloFields
+    bool enabled = false;
+    bool geometryDone = false;
+    CaloEvalStack* evalstack = nullptr;
+    //! per event cache of the tower truth attribution, shared by the towers and clusters
+    std::unordered_map<RawTowerDefs::keytype, TowerTruth> towerTruth;
+
+    OutputArrays towerArrays;
+    int nTowers = 0;
+    std::vector<float> towerE;
+    std::vector<int> towerNScint;
+    std::vector<int> towerNCerenkov;
+    std::vector<int> towerIEta;
+    std::vector<int> towerIPhi;
+    std::vector<int> towerIL;
+    std::vector<int> towerTrueID;
+
+    OutputArrays clusterArrays;  ///< maxSize 0 if the calorimeter has no clusters
+    int nClusters = 0;
+    std::vector<float> clusterE;
+    std::vector<float> clusterEta;
+    std::vector<float> clusterPhi;
+    std::vector<int> clusterNTower;
+    std::vector<int> clusterTrueID;
+  };
+  //! event tree branch in the asynchronous output and the current data of its buffer
+  struct OutputBranch
+  {
+    TBranch* branch;
+    std::function<std::pair<const char*, size_t>()> data;
+  };
+  //! detached copy of the event tree buffers of one event, one entry per OutputBranch
+  typedef std::vector<std::vector<char>> EventRecord;
+
   bool _do_store_event_info;
-  bool _do_FHCAL;
-  bool _do_BECAL;
-  bool _do_HCALIN;
-  bool _do_HCALOUT;
-  bool _do_EHCAL;
-  bool _do_FEMC;
-  bool _do_CEMC;
-  bool _do_EEMC;
-  bool _do_EEMCG;
-  bool _do_DRCALO;
-  bool _do_FOCAL;
-  bool _do_LFHCAL;
   bool _do_HITS;
   bool _do_HITS_ABSORBER;
   bool _do_HITS_CALO;
@@ -129,156 +317,18 @@ class EventEvaluatorEIC : public SubsysReco
 
   // track hits
   int _nHitsLayers;
-  int* _hits_layerID;
-  int* _hits_trueID;
-  float* _hits_x;
-  float* _hits_y;
-  float* _hits_z;
-  float* _hits_x2;
-  float* _hits_y2;
-  float* _hits_z2;
-  float* _hits_t;
-  float* _hits_edep;
-  float* _hits_lightyield;
-  int* _hits_isAbsorber;
-
-  // towers
-  int _nTowers_FHCAL;
-  float* _tower_FHCAL_E;
-  int* _tower_FHCAL_iEta;
-  int* _tower_FHCAL_iPhi;
-  int* _tower_FHCAL_trueID;
-
-  // towers
-  int _nTowers_BECAL;
-  float* _tower_BECAL_E;
-  int* _tower_BECAL_iEta;
-  int* _tower_BECAL_iPhi;
-  int* _tower_BECAL_trueID;
-
-  // towers
-  int _nTowers_HCALIN;
-  float* _tower_HCALIN_E;
-  int* _tower_HCALIN_iEta;
-  int* _tower_HCALIN_iPhi;
-  int* _tower_HCALIN_trueID;
-
-  // towers
-  int _nTowers_HCALOUT;
-  float* _tower_HCALOUT_E;
-  int* _tower_HCALOUT_iEta;
-  int* _tower_HCALOUT_iPhi;
-  int* _tower_HCALOUT_trueID;
-
-  int _nTowers_EHCAL;
-  float* _tower_EHCAL_E;
-  int* _tower_EHCAL_iEta;
-  int* _tower_EHCAL_iPhi;
-  int* _tower_EHCAL_trueID;
-
-  int _nTowers_DRCALO;
-  float* _tower_DRCALO_E;
-  int* _tower_DRCALO_NScint;
-  int* _tower_DRCALO_NCerenkov;
-  int* _tower_DRCALO_iEta;
-  int* _tower_DRCALO_iPhi;
-  int* _tower_DRCALO_trueID;
-
-  int _nTowers_FOCAL;
-  float* _tower_FOCAL_E;
-  int* _tower_FOCAL_NScint;
-  int* _tower_FOCAL_NCerenkov;
-  int* _tower_FOCAL_iEta;
-  int* _tower_FOCAL_iPhi;
-  int* _tower_FOCAL_trueID;
-
-  int _nTowers_LFHCAL;
-  float* _tower_LFHCAL_E;
-  int* _tower_LFHCAL_iEta;
-  int* _tower_LFHCAL_iPhi;
-  int* _tower_LFHCAL_iL;
-  int* _tower_LFHCAL_trueID;
-
-  int _nTowers_FEMC;
-  float* _tower_FEMC_E;
-  int* _tower_FEMC_iEta;
-  int* _tower_FEMC_iPhi;
-  int* _tower_FEMC_trueID;
-
-  int _nTowers_EEMC;
-  float* _tower_EEMC_E;
-  int* _tower_EEMC_iEta;
-  int* _tower_EEMC_iPhi;
-  int* _tower_EEMC_trueID;
-
-  int _nTowers_EEMCG;
-  float* _tower_EEMCG_E;
-  int* _tower_EEMCG_iEta;
-  int* _tower_EEMCG_iPhi;
-  int* _tower_EEMCG_trueID;
-
-  int _nTowers_CEMC;
-  float* _tower_CEMC_E;
-  int* _tower_CEMC_iEta;
-  int* _tower_CEMC_iPhi;
-  int* _tower_CEMC_trueID;
-
-  // clusters
-  int _nclusters_FHCAL;
-  float* _cluster_FHCAL_E;
-  float* _cluster_FHCAL_Eta;
-  float* _cluster_FHCAL_Phi;
-  int* _cluster_FHCAL_NTower;
-  int* _cluster_FHCAL_trueID;
-
-  int _nclusters_HCALIN;
-  float* _cluster_HCALIN_E;
-  float* _cluster_HCALIN_Eta;
-  float* _cluster_HCALIN_Phi;
-  int* _cluster_HCALIN_NTower;
-  int* _cluster_HCALIN_trueID;
-
-  int _nclusters_HCALOUT;
-  float* _cluster_HCALOUT_E;
-  float* _cluster_HCALOUT_Eta;
-  float* _cluster_HCALOUT_Phi;
-  int* _cluster_HCALOUT_NTower;
-  int* _cluster_HCALOUT_trueID;
-
-  int _nclusters_EHCAL;
-  float* _cluster_EHCAL_E;
-  float* _cluster_EHCAL_Eta;
-  float* _cluster_EHCAL_Phi;
-  int* _cluster_EHCAL_NTower;
-  int* _cluster_EHCAL_trueID;
-
-  int _nclusters_FEMC;
-  float* _cluster_FEMC_E;
-  float* _cluster_FEMC_Eta;
-  float* _cluster_FEMC_Phi;
-  int* _cluster_FEMC_NTower;
-  int* _cluster_FEMC_trueID;
-
-  int _nclusters_CEMC;
-  float* _cluster_CEMC_E;
-  float* _cluster_CEMC_Eta;
-  float* _cluster_CEMC_Phi;
-  int* _cluster_CEMC_NTower;
-  int* _cluster_CEMC_trueID;
-
-  int _nclusters_EEMC;
-  float* _cluster_EEMC_E;
-  float* _cluster_EEMC_Eta;
-  float* _cluster_EEMC_Phi;
-  int* _cluster_EEMC_NTower;
-  int* _cluster_EEMC_trueID;
-
-  int _nclusters_EEMCG;
-  float* _cluster_EEMCG_E;
-  float* _cluster_EEMCG_Eta;
-  float* _cluster_EEMCG_Phi;
-  int* _cluster_EEMCG_NTower;
-  int* _cluster_EEMCG_trueID;
+  std::vector<int> _hits_layerID;
+  std::vector<int> _hits_trueID;
+  std::vector<float> _hits_x;
+  std::vector<float> _hits_y;
+  std::vector<float> _hits_z;
+  std::vector<float> _hits_x2;
+  std::vector<float> _hits_y2;
+  std::vector<float> _hits_z2;
+  std::vector<float> _hits_t;
+  std::vector<float> _hits_edep;
+  std::vector<float> _hits_lightyield;
+  std::vector<int> _hits_isAbsorber;
 
   // vertex
   float _vertex_x;
@@ -291,20 +341,20 @@ class EventEvaluatorEIC : public SubsysReco
 
   // tracks
   int _nTracks;
-  float* _track_ID;
-  short* _track_charge;
-  float* _track_px;
-  float* _track_py;
-  float* _track_pz;
-  float* _track_x;
-  float* _track_y;
-  float* _track_z;
-  float* _track_ndf;
-  float* _track_chi2;
-  float* _track_dca;
-  float* _track_dca_2d;
-  float* _track_trueID;
-  unsigned short* _track_source;
+  std::vector<float> _track_ID;
+  std::vector<short> _track_charge;
+  std::vector<float> _track_px;
+  std::vector<float> _track_py;
+  std::vector<float> _track_pz;
+  std::vector<float> _track_x;
+  std::vector<float> _track_y;
+  std::vector<float> _track_z;
+  std::vector<float> _track_ndf;
+  std::vector<float> _track_chi2;
+  std::vector<float> _track_dca;
+  std::vector<float> _track_dca_2d;
+  std::vector<float> _track_trueID;
+  std::vector<unsigned short> _track_source;
 
   // log likelihood summary for PID detectors, per track information
   std::vector<float> _track_pion_LL;
@@ -312,33 +362,33 @@ class EventEvaluatorEIC : public SubsysReco
   std::vector<float> _track_proton_LL;
 
   int _nProjections;
-  float* _track_ProjTrackID;
-  int* _track_ProjLayer;
-  float* _track_TLP_x;
-  float* _track_TLP_y;
-  float* _track_TLP_z;
-  float* _track_TLP_t;
-  float* _track_TLP_px;
-  float* _track_TLP_py;
-  float* _track_TLP_pz;
-  float* _track_TLP_true_x;
-  float* _track_TLP_true_y;
-  float* _track_TLP_true_z;
-  float* _track_TLP_true_t;
+  std::vector<float> _track_ProjTrackID;
+  std::vector<int> _track_ProjLayer;
+  std::vector<float> _track_TLP_x;
+  std::vector<float> _track_TLP_y;
+  std::vector<float> _track_TLP_z;
+  std::vector<float> _track_TLP_t;
+  std::vector<float> _track_TLP_px;
+  std::vector<float> _track_TLP_py;
+  std::vector<float> _track_TLP_pz;
+  std::vector<float> _track_TLP_true_x;
+  std::vector<float> _track_TLP_true_y;
+  std::vector<float> _track_TLP_true_z;
+  std::vector<float> _track_TLP_true_t;
 
   // MC particles
   int _nMCPart;
-  int* _mcpart_ID;
-  int* _mcpart_ID_parent;
-  int* _mcpart_PDG;
-  float* _mcpart_E;
-  float* _mcpart_px;
-  float* _mcpart_py;
-  float* _mcpart_pz;
-  float* _mcpart_x;
-  float* _mcpart_y;
-  float* _mcpart_z;
-  int* _mcpart_BCID;
+  std::vector<int> _mcpart_ID;
+  std::vector<int> _mcpart_ID_parent;
+  std::vector<int> _mcpart_PDG;
+  std::vector<float> _mcpart_E;
+  std::vector<float> _mcpart_px;
+  std::vector<float> _mcpart_py;
+  std::vector<float> _mcpart_pz;
+  std::vector<float> _mcpart_x;
+  std::vector<float> _mcpart_y;
+  std::vector<float> _mcpart_z;
+  std::vector<int> _mcpart_BCID;
 
   // MC particles
   int _nHepmcp;
@@ -351,45 +401,92 @@ class EventEvaluatorEIC : public SubsysReco
   float _hepmcp_vtx_z;
   float _hepmcp_vtx_t;
   //  float* _hepmcp_ID_parent;
-  int* _hepmcp_status;
-  int* _hepmcp_PDG;
-  float* _hepmcp_E;
-  float* _hepmcp_px;
-  float* _hepmcp_py;
-  float* _hepmcp_pz;
-  int* _hepmcp_m1;
-  int* _hepmcp_m2;
-  int* _hepmcp_BCID;
+  std::vector<int> _hepmcp_status;
+  std::vector<int> _hepmcp_PDG;
+  std::vector<float> _hepmcp_E;
+  std::vector<float> _hepmcp_px;
+  std::vector<float> _hepmcp_py;
+  std::vector<float> _hepmcp_pz;
+  std::vector<int> _hepmcp_m1;
+  std::vector<int> _hepmcp_m2;
+  std::vector<int> _hepmcp_BCID;
 
   int _calo_ID;
   int _calo_towers_N;
-  int* _calo_towers_iEta;
-  int* _calo_towers_iPhi;
-  int* _calo_towers_iL;
-  float* _calo_towers_Eta;
-  float* _calo_towers_Phi;
-  float* _calo_towers_x;
-  float* _calo_towers_y;
-  float* _calo_towers_z;
-  int* _geometry_done;
-
-  float* _reco_e_threshold;
+  std::vector<int> _calo_towers_iEta;
+  std::vector<int> _calo_towers_iPhi;
+  std::vector<int> _calo_towers_iL;
+  std::vector<float> _calo_towers_Eta;
+  std::vector<float> _calo_towers_Phi;
+  std::vector<float> _calo_towers_x;
+  std::vector<float> _calo_towers_y;
+  std::vector<float> _calo_towers_z;
+
+  OutputArrays _hitArrays;
+  OutputArrays _trackArrays;
+  OutputArrays _projectionArrays;
+  OutputArrays _mcpartArrays;
+  OutputArrays _hepmcpArrays;
+  OutputArrays _geometryArrays;
+
+  //! calorimeters in output order, the vector must not grow after Init
+  std::vector<CaloDescriptor> _calos;
+
+  //! projection layers in matching order, the ones from add_projection_layer first
+  std::vector<ProjectionLayer> _projection_layers;
+  unsigned int _nCustomProjectionLayers = 0;
+  std::vector<HitLayer> _hit_layers;
+  std::vector<std::vector<HitEntry>> _hit_buffers;  ///< hits of the current event per entry of _hit_layers
+  std::unordered_map<std::string, TrackState> _track_states;
+
+  //! asynchronous output: every event is copied into a free record and queued for the writer
+  //! thread, which points the event tree branches to the record and fills the tree
+  unsigned int _async_depth = 0;
+  std::vector<OutputBranch> _output_branches;
+  std::vector<EventRecord> _records;
+  std::vector<EventRecord*> _free_records;
+  std::deque<EventRecord*> _queued_records;
+  std::thread _writer;
+  std::mutex _writer_mutex;
+  std::condition_variable _cv_queued;
+  std::condition_variable _cv_free;
+  bool _writer_stop = false;
+  unsigned int _nQueued = 0;            ///< events handed to the writer
+  unsigned int _maxQueued = 0;          ///< most events waiting for the writer
+  unsigned long _sumQueued = 0;         ///< events waiting summed over all queued events
+  unsigned int _nStalls = 0;            ///< events that waited for a free record
+  double _stallTime = 0;                ///< seconds process_event waited for a free record
+  double _writeTime = 0;                ///< seconds the writer spent filling the tree
+
+  //! RNTuple output, filled from the same arrays as the event tree
+  std::string _rntuple_filename;
+  std::shared_ptr<ROOT::Experimental::RNTupleWriter> _ntuple_writer;  ///< shared_ptr, its deleter does not need the class without RNTuple
+  std::vector<std::function<void()>> _ntuple_values;  ///< copy the per event values to their fields
+  std::vector<OutputArrays*> _ntuple_collections;
+
+  //! parallel filling: the detector sections of an event are tasks taken in order by the workers
+  //! and the thread running them. A section reads the node tree and the truth containers and
+  //! writes only its own buffers (a calorimeter also its eval stack and tower truth cache).
+  //! Output array growth and overflow reports are serialized by _output_mutex. The geometry tree is filled before the tasks.
+  unsigned int _fill_threads = 1;
+  std::vector<std::thread> _fill_workers;
+  std::mutex _fill_mutex;  ///< guards the task state below
+  std::condition_variable _cv_fill_start;
+  std::condition_variable _cv_fill_done;
+  const std::vector<std::function<bool()>>* _fill_tasks = nullptr;
+  unsigned int _fill_next = 0;         ///< next task to take
+  unsigned int _fill_pending = 0;      ///< tasks not finished
+  unsigned long _fill_generation = 0;  ///< events handed to the workers
+  bool _fill_ok = true;                ///< no task of this event failed
+  bool _fill_stop = false;
+  unsigned int _nFilled = 0;  ///< events filled by runFillTasks
+  double _fillTime = 0;       ///< seconds from handing out the tasks to the last one finishing
+  double _fillTaskTime = 0;   ///< seconds spent in the tasks, summed over the threads
+  std::mutex _output_mutex;
+
   float _reco_e_thresholdMC;
   int _depth_MCstack;
 
-  CaloEvalStack* _caloevalstackFHCAL;
-  CaloEvalStack* _caloevalstackBECAL;
-  CaloEvalStack* _caloevalstackHCALIN;
-  CaloEvalStack* _caloevalstackHCALOUT;
-  CaloEvalStack* _caloevalstackEHCAL;
-  CaloEvalStack* _caloevalstackDRCALO;
-  CaloEvalStack* _caloevalstackFOCAL;
-  CaloEvalStack* _caloevalstackLFHCAL;
-  CaloEvalStack* _caloevalstackFEMC;
-  CaloEvalStack* _caloevalstackCEMC;
-  CaloEvalStack* _caloevalstackEEMC;
-  CaloEvalStack* _caloevalstackEEMCG;
-
   //----------------------------------
   // evaluator output ntuples
 
@@ -404,11 +501,42 @@ class EventEvaluatorEIC : public SubsysReco
   TFile* _tfile_geometry;
 
   // subroutines
-  int GetProjectionIndex(std::string projname);           ///< return track projection index for given track projection layer
-  std::string GetProjectionNameFromIndex(int projindex);  ///< return track projection layer name from projection index (see GetProjectionIndex)
-  void fillOutputNtuples(PHCompositeNode* topNode);       ///< dump the evaluator information into ntuple for external analysis
-  void resetGeometryArrays();                             ///< reset the tree variables before filling for a new event
-  void resetBuffer();                                     ///< reset the tree variables before filling for a new event
+  int GetProjectionIndex(const std::string& projname) const;                                                                         ///< return track projection index for given track projection layer, -1 if none matches
+  TrackState& GetTrackState(PHCompositeNode* topNode, const std::string& statename);                                                 ///< return the cached projection index and hit container of a track state
+  PHG4Hit* GetTrackStateHit(TrackState& trackState, const int trkid);                                                                ///< return the hit of truth track trkid in the hit container of a track state, nullptr if none
+  CaloDescriptor* GetCalorimeter(const int caloid);                                                                                  ///< return the calorimeter with calotype caloid, nullptr if none
+  const TowerTruth& GetTowerTruth(CaloDescriptor& calo, CaloRawTowerEval* towereval, RawTower* tower);                               ///< truth attribution of a tower, evaluated once per event
+  PHG4Particle* GetClusterTruth(CaloDescriptor& calo, CaloRawTowerEval* towereval, RawTowerContainer* towers, RawCluster* cluster);  ///< primary with the largest energy in the cluster, summed from the cached tower attributions
+  void fillGeometry(PHCompositeNode* topNode, CaloDescriptor& calo);                                                                 ///< fill the tower geometry of a calorimeter into the geometry tree, once
+  void fillTowers(PHCompositeNode* topNode, CaloDescriptor& calo);                                                                   ///< fill the towers of a calorimeter
+  void fillClusters(PHCompositeNode* topNode, CaloDescriptor& calo, SvtxVertex* vertex);                                             ///< fill the clusters of a calorimeter, their eta is computed for vertex (origin if nullptr)
+  void fillOutputNtuples(PHCompositeNode* topNode);                                                                                  ///< dump the evaluator information into ntuple for external analysis
+  void fillHitLayer(PHCompositeNode* topNode, const HitLayer& layer, PHG4TruthInfoContainer* truth, std::vector<HitEntry>& buffer);  ///< collect the hits (and absorber hits) of one layer in buffer
+  void addHits(PHG4HitContainer* hits, const int isAbsorber, PHG4TruthInfoContainer* truth, std::vector<HitEntry>& buffer);          ///< append the hits of a container to buffer
+  int GetHitTrueID(PHG4TruthInfoContainer* truth, PHG4Hit* hit);                                                                     ///< truth track of a hit, its ancestor if it is deeper than set_depth_MCstack in the MC stack
+  void joinHits();                                                                                                                   ///< copy the hit buffers of the layers in order into the hits arrays
+  bool fillTracks(PHCompositeNode* topNode);                                                                                         ///< fill the tracks and their projections, false if there is no track map
+  bool fillMCParticles(PHCompositeNode* topNode);                                                                                    ///< fill the MC particles, false without G4TruthInfo
+  bool fillHepMC(PHCompositeNode* topNode);                                                                                          ///< fill the HepMC particles, false without PHHepMCGenEventMap
+  void resetGeometryArrays();                                                                                                        ///< reset the geometry tree variables before filling the next calorimeter
+  void resetBuffer();                                                                                                                ///< reset the tree entries written in the last event before filling a new one
+  template <typename T>
+  void addOutputArray(OutputArrays& arrays, std::vector<T>& buffer, TTree* tree, const std::string& branchname,
+                      const std::string& leaflist, const typename std::vector<T>::value_type init = 0);  ///< size the buffer, create its branch in tree (if any) and add it to arrays
+  bool growOutputArrays(OutputArrays& arrays, const int n);            ///< make room for entry n, false if that exceeds the limit of the arrays
+  void startWriter();                                                  ///< collect the event tree branches and start the writer thread
+  void queueEvent();                                                   ///< copy the event tree buffers into a record for the writer thread
+  void writerLoop();                                                   ///< fill the event tree from the queued records until stopped
+  void stopWriter();                                                   ///< write the queued events and join the writer thread
+  void startNtuple();                                                  ///< create the RNTuple model from the event tree branches and open the RNTuple output
+  void fillNtuple();                                                   ///< fill the current event into the RNTuple output
+  void startFillWorkers();                                             ///< start the worker threads of the parallel filling
+  bool runFillTasks(const std::vector<std::function<bool()>>& tasks);  ///< run the tasks of an event and wait for them, false if one failed
+  void takeFillTasks(std::unique_lock<std::mutex>& lock);              ///< run tasks of the current event until none is left, lock on _fill_mutex
+  void fillWorkerLoop();                                               ///< run the tasks of each event until stopped
+  void stopFillWorkers();                                              ///< join the worker threads
+
+  const int _minNOutput = 64;
 
   const int _maxNHits = 1000000;
   const int _maxNTowers = 50 * 50;
@@ -421,7 +549,6 @@ class EventEvaluatorEIC : public SubsysReco
   const int _maxNProjections = 2000;
   const int _maxNMCPart = 100000;
   const int _maxNHepmcp = 1000;
-  const int _maxNCalo = 15;
 
   enum calotype
   {
@@ -0,0 +1,165 @@
+// Read benchmark for the two EventEvaluatorEIC output formats: reads the same
+// float columns over all events from the event_tree (TTree) and from the
+// event_ntuple (RNTuple, EventEvaluatorEIC::set_rntuple_output) of one job and
+// reports the file sizes and the read throughput.
+//
+// usage: evaloutputbenchmark <TTree file> <RNTuple file> [collection field ...]
+//
+// A column is given as RNTuple collection and field, e.g. "tower_FEMC E", the
+// TTree branch is <collection>_<field> (tower_FEMC_E) or <field> if there is no
+// such branch. Each column is read in its own pass over the events, the column
+// sums of both formats have to agree. Run it twice or drop the page cache in
+// between for cold reads.
+
+#include <ROOT/RNTuple.hxx>
+
+#include <TBranch.h>
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TTree.h>
+#include <TTreeReader.h>
+#include <TTreeReaderArray.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  typedef std::pair<std::string, std::string> column;
+
+  // sum of the column and number of values read
+  std::pair<double, unsigned long> readTree(TTree *tree, const std::string &branchname)
+  {
+    // read only this column and the counter branch that gives its length per event
+    TBranch *branch = tree->GetBranch(branchname.c_str());
+    if (!branch)
+    {
+      std::cout << "no branch " << branchname << " in the event_tree" << std::endl;
+      return std::make_pair(0., 0UL);
+    }
+    tree->SetBranchStatus("*", false);
+    tree->SetBranchStatus(branchname.c_str(), true);
+    TLeaf *leaf = static_cast<TLeaf *>(branch->GetListOfLeaves()->At(0));
+    if (leaf->GetLeafCount())
+    {
+      tree->SetBranchStatus(leaf->GetLeafCount()->GetBranch()->GetName(), true);
+    }
+    TTreeReader reader(tree);
+    TTreeReaderArray<float> values(reader, branchname.c_str());
+    double sum = 0;
+    unsigned long nvalues = 0;
+    while (reader.Next())
+    {
+      for (float value : values)
+      {
+        sum += value;
+      }
+      nvalues += values.GetSize();
+    }
+    return std::make_pair(sum, nvalues);
+  }
+
+  std::pair<double, unsigned long> readNtuple(ROOT::Experimental::RNTupleReader &ntuple, const column &col)
+  {
+    auto collection = ntuple.GetViewCollection(col.first);
+    auto values = collection.GetView<float>(col.second);
+    double sum = 0;
+    unsigned long nvalues = 0;
+    for (auto iEvent : ntuple.GetEntryRange())
+    {
+      for (auto iEntry : collection.GetCollectionRange(iEvent))
+      {
+        sum += values(iEntry);
+        nvalues++;
+      }
+    }
+    return std::make_pair(sum, nvalues);
+  }
+
+  void report(const std::string &format, const Long64_t filesize, const unsigned long nevents, const unsigned long nvalues, const double walltime)
+  {
+    std::cout << std::setw(8) << format << std::setw(14) << std::setprecision(4) << filesize / 1048576. << std::setw(10) << nevents
+              << std::setw(14) << nvalues << std::setw(12) << std::setprecision(4) << 1e3 * walltime
+              << std::setw(14) << std::setprecision(4) << (walltime > 0 ? nevents / walltime : 0) << std::endl;
+  }
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3 || argc % 2 == 0)
+  {
+    std::cout << "usage: " << argv[0] << " <TTree file> <RNTuple file> [collection field ...]" << std::endl;
+    return 1;
+  }
+  std::vector<column> columns;
+  for (int iarg = 3; iarg + 1 < argc; iarg += 2)
+  {
+    columns.push_back(std::make_pair(argv[iarg], argv[iarg + 1]));
+  }
+  if (columns.empty())
+  {
+    columns = {{"hits", "x"}, {"hits", "y"}, {"hits", "z"}, {"tracks", "px"}, {"tracks", "py"}, {"tracks", "pz"}};
+  }
+
+  std::unique_ptr<TFile> treefile(TFile::Open(argv[1]));
+  TTree *tree = treefile ? treefile->Get<TTree>("event_tree") : nullptr;
+  if (!tree)
+  {
+    std::cout << "no event_tree in " << argv[1] << std::endl;
+    return 1;
+  }
+  const Long64_t treesize = treefile->GetSize();
+  std::unique_ptr<TFile> ntuplefile(TFile::Open(argv[2]));
+  if (!ntuplefile)
+  {
+    std::cout << "cannot open " << argv[2] << std::endl;
+    return 1;
+  }
+  const Long64_t ntuplesize = ntuplefile->GetSize();
+  ntuplefile.reset();
+  auto ntuple = ROOT::Experimental::RNTupleReader::Open("event_ntuple", argv[2]);
+
+  std::cout << std::setw(8) << "format" << std::setw(14) << "file size MB" << std::setw(10) << "events"
+            << std::setw(14) << "values" << std::setw(12) << "read ms" << std::setw(14) << "events/s" << std::endl;
+
+  double treetime = 0;
+  double ntupletime = 0;
+  unsigned long treevalues = 0;
+  unsigned long ntuplevalues = 0;
+  for (const auto &col : columns)
+  {
+    std::string branchname = col.first + "_" + col.second;
+    if (!tree->GetBranch(branchname.c_str()))
+    {
+      branchname = col.second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::pair<double, unsigned long> treesum = readTree(tree, branchname);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    treetime += elapsed.count();
+    treevalues += treesum.second;
+
+    start = std::chrono::steady_clock::now();
+    std::pair<double, unsigned long> ntuplesum = readNtuple(*ntuple, col);
+    elapsed = std::chrono::steady_clock::now() - start;
+    ntupletime += elapsed.count();
+    ntuplevalues += ntuplesum.second;
+
+    if (treesum.second != ntuplesum.second || treesum.first != ntuplesum.first)
+    {
+      std::cout << "WARNING: " << branchname << " and " << col.first << "." << col.second << " differ: "
+                << treesum.second << " values with sum " << treesum.first << " vs "
+                << ntuplesum.second << " values with sum " << ntuplesum.first << std::endl;
+    }
+  }
+
+  report("TTree", treesize, tree->GetEntries(), treevalues, treetime);
+  report("RNTuple", ntuplesize, ntuple->GetNEntries(), ntuplevalues, ntupletime);
+  return 0;
+}
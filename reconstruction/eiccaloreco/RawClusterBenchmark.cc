@@ -0,0 +1,306 @@
+// Standalone clustering benchmark: fills the tower container of each calorimeter
+// layout with synthetic showers and noise and runs the clusterers of this package
+// on it, no Geant4 simulation or Fun4AllServer needed.
+//
+// usage: clusterbenchmark [nevents] [showers per event] [noise occupancy] [layout|all] [nthreads]
+//
+// Only process_event of the clusterers is timed, filling the towers and resetting
+// the cluster container (done by the Fun4AllServer in a real job) are not.
+// The memory column is the largest growth of the resident memory over the events
+// of a clusterer, relative to before its node tree was built. Memory the allocator
+// kept from an earlier clusterer is reused and not counted again.
+
+#include <RawClusterBuilderHelper.h>
+#include <RawClusterBuilderkLM.h>
+#include <RawClusterBuilderkMA.h>
+#include <RawClusterBuilderkMAParallel.h>
+#include <RawClusterBuilderkV3.h>
+
+#include <calobase/RawClusterContainer.h>
+#include <calobase/RawTower.h>
+#include <calobase/RawTowerContainer.h>
+#include <calobase/RawTowerDefs.h>
+#include <calobase/RawTowerGeomContainerv1.h>
+#include <calobase/RawTowerGeomv1.h>
+#include <calobase/RawTowerv1.h>
+#include <calobase/RawTowerv2.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  typedef struct
+  {
+    std::string name;
+    RawTowerDefs::CalorimeterId caloId;
+    int neta;
+    int nphi;
+    int nl;
+    // barrel calorimeters wrap around in phi, forward ones are x/y grids
+    bool barrel;
+  } caloLayout;
+
+  // same phi segmentation as RawClusterBuilderHelper::caloTowersPhi for the barrel calorimeters
+  const std::vector<caloLayout> layouts = {
+      {"CEMC", RawTowerDefs::CEMC, 96, 100, 1, true},
+      {"HCALOUT", RawTowerDefs::HCALOUT, 24, 64, 1, true},
+      {"BECAL", RawTowerDefs::BECAL, 64, 128, 1, true},
+      {"FEMC", RawTowerDefs::FEMC, 100, 100, 1, false},
+      {"EEMC", RawTowerDefs::EEMC, 60, 60, 1, false},
+      {"DRCALO", RawTowerDefs::DRCALO, 120, 120, 1, false},
+      {"LFHCAL", RawTowerDefs::LFHCAL, 54, 54, 7, false}};
+
+  enum algorithm
+  {
+    kV3,
+    kMA,
+    kMAParallel,
+    kLM,
+    kMAPool
+  };
+  const std::vector<std::pair<algorithm, std::string>> algorithms = {
+      {kV3, "kV3"}, {kMA, "kMA"}, {kMAParallel, "kMAParallel"}, {kLM, "kLM"}, {kMAPool, "kMA+pool"}};
+
+  // tower key -> energy of one synthetic event
+  typedef std::map<RawTowerDefs::keytype, float> syntheticEvent;
+
+  RawTowerDefs::keytype towerKey(const caloLayout &layout, int ieta, int iphi, int il)
+  {
+    if (layout.nl > 1)
+    {
+      return RawTowerDefs::encode_towerid(layout.caloId, ieta, iphi, il);
+    }
+    return RawTowerDefs::encode_towerid(layout.caloId, ieta, iphi);
+  }
+
+  // showers with an exponential lateral profile of about one tower and a falling
+  // longitudinal profile, on top of noise in a fraction of all towers
+  std::vector<syntheticEvent> generateEvents(const caloLayout &layout, int nevents, int nshowers, float occupancy, std::mt19937 &rng)
+  {
+    std::uniform_int_distribution<int> rndEta(0, layout.neta - 1);
+    std::uniform_int_distribution<int> rndPhi(0, layout.nphi - 1);
+    std::uniform_int_distribution<int> rndL(0, layout.nl - 1);
+    std::uniform_real_distribution<float> rndShowerE(1., 20.);
+    std::exponential_distribution<float> rndNoiseE(10.);
+    const int nnoise = occupancy * layout.neta * layout.nphi * layout.nl;
+
+    std::vector<syntheticEvent> events(nevents);
+    for (auto &event : events)
+    {
+      for (int ishower = 0; ishower < nshowers; ishower++)
+      {
+        const int ceta = rndEta(rng);
+        const int cphi = rndPhi(rng);
+        const float e = rndShowerE(rng);
+        double norm = 0;
+        for (int deta = -2; deta <= 2; deta++)
+        {
+          for (int dphi = -2; dphi <= 2; dphi++)
+          {
+            for (int il = 0; il < layout.nl; il++)
+            {
+              norm += std::exp(-std::sqrt(deta * deta + dphi * dphi) / 0.7 - il / 2.);
+            }
+          }
+        }
+        for (int deta = -2; deta <= 2; deta++)
+        {
+          for (int dphi = -2; dphi <= 2; dphi++)
+          {
+            const int ieta = ceta + deta;
+            int iphi = cphi + dphi;
+            if (layout.barrel)
+            {
+              iphi = (iphi + layout.nphi) % layout.nphi;
+            }
+            if (ieta < 0 || ieta >= layout.neta || iphi < 0 || iphi >= layout.nphi) continue;
+            for (int il = 0; il < layout.nl; il++)
+            {
+              event[towerKey(layout, ieta, iphi, il)] += e * std::exp(-std::sqrt(deta * deta + dphi * dphi) / 0.7 - il / 2.) / norm;
+            }
+          }
+        }
+      }
+      for (int inoise = 0; inoise < nnoise; inoise++)
+      {
+        event[towerKey(layout, rndEta(rng), rndPhi(rng), rndL(rng))] += rndNoiseE(rng);
+      }
+    }
+    return events;
+  }
+
+  RawTowerGeomContainer *buildGeometry(const caloLayout &layout)
+  {
+    RawTowerGeomContainerv1 *geoms = new RawTowerGeomContainerv1(layout.caloId);
+    for (int ieta = 0; ieta < layout.neta; ieta++)
+    {
+      for (int iphi = 0; iphi < layout.nphi; iphi++)
+      {
+        for (int il = 0; il < layout.nl; il++)
+        {
+          RawTowerGeomv1 *geom = new RawTowerGeomv1(towerKey(layout, ieta, iphi, il));
+          if (layout.barrel)
+          {
+            const double eta = -1.5 + 3. * (ieta + 0.5) / layout.neta;
+            const double phi = 2 * M_PI * (iphi + 0.5) / layout.nphi;
+            geom->set_center_x(100. * std::cos(phi));
+            geom->set_center_y(100. * std::sin(phi));
+            geom->set_center_z(100. * std::sinh(eta));
+          }
+          else
+          {
+            geom->set_center_x(2. * (ieta - 0.5 * layout.neta + 0.5));
+            geom->set_center_y(2. * (iphi - 0.5 * layout.nphi + 0.5));
+            geom->set_center_z(300. + 10. * il);
+          }
+          geoms->add_tower_geometry(geom);
+        }
+      }
+    }
+    return geoms;
+  }
+
+  RawClusterBuilderHelper *makeClusterer(const algorithm algo, const std::string &detector, const int nthreads)
+  {
+    RawClusterBuilderHelper *builder = nullptr;
+    switch (algo)
+    {
+    case kV3:
+      builder = new RawClusterBuilderkV3("RawClusterBuilderkV3_" + detector);
+      break;
+    case kMA:
+      builder = new RawClusterBuilderkMA("RawClusterBuilderkMA_" + detector);
+      break;
+    case kMAParallel:
+    {
+      RawClusterBuilderkMAParallel *parallel = new RawClusterBuilderkMAParallel("RawClusterBuilderkMAParallel_" + detector);
+      parallel->set_nthreads(nthreads);
+      builder = parallel;
+      break;
+    }
+    case kLM:
+      builder = new RawClusterBuilderkLM("RawClusterBuilderkLM_" + detector);
+      break;
+    case kMAPool:
+      builder = new RawClusterBuilderkMA("RawClusterBuilderkMA_" + detector);
+      builder->set_use_cluster_pool(true);
+      break;
+    }
+    builder->Detector(detector);
+    builder->set_seed_e(0.5);
+    builder->set_agg_e(0.1);
+    return builder;
+  }
+
+  // current resident memory of the process in MB, 0 if /proc is not available
+  double residentMemory()
+  {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0;
+    long resident = 0;
+    if (!(statm >> size >> resident))
+    {
+      return 0;
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1048576.);
+  }
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+  const int nevents = (argc > 1) ? std::atoi(argv[1]) : 100;
+  const int nshowers = (argc > 2) ? std::atoi(argv[2]) : 10;
+  const float occupancy = (argc > 3) ? std::atof(argv[3]) : 0.01;
+  const std::string selected = (argc > 4) ? argv[4] : "all";
+  const int nthreads = (argc > 5) ? std::atoi(argv[5]) : 4;
+
+  std::cout << "clusterbenchmark: " << nevents << " events, " << nshowers << " showers per event, noise occupancy "
+            << occupancy << ", " << nthreads << " threads for kMAParallel" << std::endl;
+  std::cout << std::setw(10) << "layout" << std::setw(13) << "algorithm" << std::setw(12) << "towers/evt"
+            << std::setw(12) << "clus/evt" << std::setw(12) << "ms/evt" << std::setw(14) << "towers/s"
+            << std::setw(14) << "clusters/s" << std::setw(14) << "mem incr MB" << std::endl;
+
+  std::mt19937 rng(42);
+  for (const auto &layout : layouts)
+  {
+    if (selected != "all" && selected != layout.name) continue;
+
+    // the same events for all clusterers
+    const std::vector<syntheticEvent> events = generateEvents(layout, nevents, nshowers, occupancy, rng);
+
+    for (const auto &algo : algorithms)
+    {
+      const double baseMemory = residentMemory();
+      // fresh node tree per clusterer, each one creates its own CLUSTER_<det> node
+      PHCompositeNode *topNode = new PHCompositeNode("TOP");
+      PHCompositeNode *dstNode = new PHCompositeNode("DST");
+      topNode->addNode(dstNode);
+      PHCompositeNode *runNode = new PHCompositeNode("RUN");
+      topNode->addNode(runNode);
+      PHCompositeNode *detNode = new PHCompositeNode(layout.name);
+      dstNode->addNode(detNode);
+      RawTowerContainer *towers = new RawTowerContainer(layout.caloId);
+      detNode->addNode(new PHIODataNode<PHObject>(towers, "TOWER_CALIB_" + layout.name, "PHObject"));
+      runNode->addNode(new PHIODataNode<PHObject>(buildGeometry(layout), "TOWERGEOM_" + layout.name, "PHObject"));
+
+      RawClusterBuilderHelper *builder = makeClusterer(algo.first, layout.name, nthreads);
+      builder->InitRun(topNode);
+      RawClusterContainer *clusters = findNode::getClass<RawClusterContainer>(topNode, "CLUSTER_" + layout.name);
+
+      double walltime = 0;
+      unsigned long ntowers = 0;
+      unsigned long nclusters = 0;
+      double maxMemory = baseMemory;
+      for (const auto &event : events)
+      {
+        towers->Reset();
+        clusters->Reset();
+        for (const auto &tower_pair : event)
+        {
+          RawTower *tower = (layout.nl > 1) ? static_cast<RawTower *>(new RawTowerv2(tower_pair.first)) : new RawTowerv1(tower_pair.first);
+          tower->set_energy(tower_pair.second);
+          towers->AddTower(tower_pair.first, tower);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        builder->process_event(topNode);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        walltime += elapsed.count();
+        ntowers += towers->size();
+        nclusters += clusters->size();
+        maxMemory = std::max(maxMemory, residentMemory());
+      }
+      builder->End(topNode);
+
+      std::cout << std::setw(10) << layout.name << std::setw(13) << algo.second
+                << std::setw(12) << (nevents > 0 ? ntowers / nevents : 0)
+                << std::setw(12) << (nevents > 0 ? nclusters / nevents : 0)
+                << std::setw(12) << std::setprecision(4) << (nevents > 0 ? 1e3 * walltime / nevents : 0)
+                << std::setw(14) << std::setprecision(4) << (walltime > 0 ? ntowers / walltime : 0)
+                << std::setw(14) << std::setprecision(4) << (walltime > 0 ? nclusters / walltime : 0)
+                << std::setw(14) << std::setprecision(4) << maxMemory - baseMemory << std::endl;
+
+      delete builder;
+      delete topNode;
+    }
+  }
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <RawClusterBuilderHelper.h>
+#include <RawClusterContainerPool.h>
 
 #include <calobase/RawCluster.h>
 #include <calobase/RawClusterContainer.h>
@@ -38,6 +39,10 @@ RawClusterBuilderHelper::RawClusterBuilderHelper(const std::string &name)
   , _agg_e(0.1)
   , detector("NONE")
   , _clusters(nullptr)
+  , _cluster_pool(nullptr)
+  , _use_cluster_pool(false)
+  , _use_tower_map_energy(false)
+  , _towers(nullptr)
 {
 }
 
@@ -53,14 +58,32 @@ int RawClusterBuilderHelper::InitRun(PHCompositeNode *topNode)
     throw;
   }
 
+  std::string towergeomnodename = "TOWERGEOM_" + detector;
+  RawTowerGeomContainer *towergeom = findNode::getClass<RawTowerGeomContainer>(topNode, towergeomnodename);
+  if (towergeom)
+  {
+    _towerGeomCache.Build(towergeom);
+    _towerGeomE.resize(_towerGeomCache.size());
+  }
+
   return Fun4AllReturnCodes::EVENT_OK;
 }
 int RawClusterBuilderHelper::process_event(PHCompositeNode *topNode)
+{
+  int ret = GetNodes(topNode);
+  if (ret != Fun4AllReturnCodes::EVENT_OK)
+  {
+    return ret;
+  }
+  return ClusterTowers();
+}
+
+int RawClusterBuilderHelper::GetNodes(PHCompositeNode *topNode)
 {
   std::string towernodename = "TOWER_CALIB_" + detector;
   // Grab the towers
-  RawTowerContainer *towers = findNode::getClass<RawTowerContainer>(topNode, towernodename);
-  if (!towers)
+  _towers = findNode::getClass<RawTowerContainer>(topNode, towernodename);
+  if (!_towers)
   {
     std::cout << PHWHERE << ": Could not find node " << towernodename << std::endl;
     return Fun4AllReturnCodes::DISCARDEVENT;
@@ -72,11 +95,31 @@ int RawClusterBuilderHelper::process_event(PHCompositeNode *topNode)
     std::cout << PHWHERE << ": Could not find node " << towergeomnodename << std::endl;
     return Fun4AllReturnCodes::ABORTEVENT;
   }
+  if (_towerGeomCache.empty())
+  {
+    _towerGeomCache.Build(towergeom);
+    _towerGeomE.resize(_towerGeomCache.size());
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int RawClusterBuilderHelper::ClusterTowers()
+{
+  RawTowerContainer *towers = _towers;
 
   // make the list of towers above threshold
   std::vector<towersStrct> input_towers;
   // towers in the current cluster
   int towers_added = 0;
+  // bin ranges of the towers for the occupancy grid
+  int minEta = 0;
+  int maxEta = -1;
+  int minPhi = 0;
+  int maxPhi = -1;
+  int minL = 0;
+  int maxL = -1;
+  // towers come in key order, so the geometry index search continues from the last one
+  int geomIndex = 0;
   RawTowerContainer::ConstRange begin_end = towers->getTowers();
   for (RawTowerContainer::ConstIterator itr = begin_end.first; itr != begin_end.second; ++itr)
   {
@@ -84,26 +127,66 @@ int RawClusterBuilderHelper::process_event(PHCompositeNode *topNode)
     RawTowerDefs::keytype towerid = itr->first;
     if (tower->get_energy() > _agg_e)
     {
+      int index = _towerGeomCache.Index(towerid, geomIndex);
+      if (index >= 0)
+      {
+        _towerGeomE[index] = tower->get_energy();
+        geomIndex = index;
+      }
       towersStrct tempTower;
       tempTower.tower_E = tower->get_energy();
       tempTower.tower_iEta = tower->get_bineta();
       tempTower.tower_iPhi = tower->get_binphi();
       tempTower.tower_iL = 0;
-      if (towerid == RawTowerDefs::LFHCAL)
+      if (towers->getCalorimeterID() == RawTowerDefs::LFHCAL)
       {
         tempTower.tower_iL = tower->get_binl();
       }
       tempTower.tower_trueID = towerid;  // currently unsigned -> signed, will this matter?
       tempTower.twr = itr->second;
       input_towers.push_back(tempTower);
+      if (towers_added == 0)
+      {
+        minEta = maxEta = tempTower.tower_iEta;
+        minPhi = maxPhi = tempTower.tower_iPhi;
+        minL = maxL = tempTower.tower_iL;
+      }
+      else
+      {
+        minEta = std::min(minEta, tempTower.tower_iEta);
+        maxEta = std::max(maxEta, tempTower.tower_iEta);
+        minPhi = std::min(minPhi, tempTower.tower_iPhi);
+        maxPhi = std::max(maxPhi, tempTower.tower_iPhi);
+        minL = std::min(minL, tempTower.tower_iL);
+        maxL = std::max(maxL, tempTower.tower_iL);
+      }
       towers_added++;
     }
   }
 
-  cluster(input_towers, towers->getCalorimeterID());
+  // Next we'll sort the towers from most energetic to least
+  // This is from https://github.com/FriederikeBock/AnalysisSoftwareEIC/blob/642aeb13b13271820dfee59efe93380e58456289/treeAnalysis/clusterizer.cxx#L281
+  std::sort(input_towers.begin(), input_towers.end(), &towerECompare);
+
+  // and index them in the (eta, phi, l) grid for the neighbour lookup, barrel calorimeters wrap around in phi
+  int caloId = towers->getCalorimeterID();
+  int nPhiWrap = IsForwardCalorimeter(caloId) ? 0 : caloTowersPhi(caloId);
+  _towerGrid.Reset(minEta, maxEta, minPhi, maxPhi, minL, maxL, nPhiWrap, input_towers.size());
+  for (unsigned int i = 0; i < input_towers.size(); i++)
+  {
+    _towerGrid.Insert(i, input_towers[i].tower_iEta, input_towers[i].tower_iPhi, input_towers[i].tower_iL);
+  }
+
+  cluster(input_towers, caloId);
 
   // Sum x, y, z, e
   // from https://github.com/ECCE-EIC/coresoftware/blob/ae0526adf82f49cb8906d447411b90287de6a56e/offline/packages/CaloReco/RawClusterBuilderGraph.cc#L202
+  // the towers of all clusters are flattened into dense geometry indices and energies, then
+  // energy, centroid and second moments are computed for all clusters in one go
+  _clusterOffsets.clear();
+  _clusterTowerIndex.clear();
+  _clusterTowerE.clear();
+  _clusterOffsets.push_back(0);
   for (const auto &cluster_pair : _clusters->getClustersMap())
   {
     RawClusterDefs::keytype clusterid = cluster_pair.first;
@@ -112,48 +195,46 @@ int RawClusterBuilderHelper::process_event(PHCompositeNode *topNode)
     assert(cluster);
     assert(cluster->get_id() == clusterid);
 
-    double sum_x(0);
-    double sum_y(0);
-    double sum_z(0);
-    double sum_e(0);
-
-    for (const auto tower_pair : cluster->get_towermap())
+    // the tower map is ordered by key, so the search continues from the last tower
+    int index = 0;
+    for (const auto &tower_pair : cluster->get_towermap())
     {
-      const RawTower *rawtower = towers->getTower(tower_pair.first);
-      const RawTowerGeom *rawtowergeom = towergeom->get_tower_geometry(tower_pair.first);
-
-      assert(rawtower);
-      assert(rawtowergeom);
-      const double e = rawtower->get_energy();
-
-      sum_e += e;
-
-      if (e > 0)
+      index = _towerGeomCache.Index(tower_pair.first, index);
+      assert(index >= 0);
+      if (index < 0)
       {
-        sum_x += e * rawtowergeom->get_center_x();
-        sum_y += e * rawtowergeom->get_center_y();
-        sum_z += e * rawtowergeom->get_center_z();
+        std::cout << PHWHERE << ": no geometry for tower " << tower_pair.first << " in TOWERGEOM_" << detector << std::endl;
+        index = 0;
+        continue;
       }
-    }  //     for (const auto tower_pair : cluster->get_towermap())
+      _clusterTowerIndex.push_back(index);
+      _clusterTowerE.push_back(_use_tower_map_energy ? tower_pair.second : _towerGeomE[index]);
+    }
+    _clusterOffsets.push_back(_clusterTowerIndex.size());
+  }
+  _towerGeomCache.ComputeMoments(_clusterOffsets, _clusterTowerIndex, _clusterTowerE, _clusterMoments);
 
-    cluster->set_energy(sum_e);
+  unsigned int icl = 0;
+  for (const auto &cluster_pair : _clusters->getClustersMap())
+  {
+    RawCluster *cluster = cluster_pair.second;
+    const RawClusterTowerGeomCache::clusterMoments &moments = _clusterMoments[icl++];
 
-    if (sum_e > 0)
-    {
-      sum_x /= sum_e;
-      sum_y /= sum_e;
-      sum_z /= sum_e;
+    cluster->set_energy(moments.e);
 
-      cluster->set_r(sqrt(sum_y * sum_y + sum_x * sum_x));
-      cluster->set_phi(atan2(sum_y, sum_x));
+    if (moments.e > 0)
+    {
+      cluster->set_r(sqrt(moments.y * moments.y + moments.x * moments.x));
+      cluster->set_phi(atan2(moments.y, moments.x));
 
-      cluster->set_z(sum_z);
+      cluster->set_z(moments.z);
     }
 
     if (Verbosity() > 1)
     {
       std::cout << "RawClusterBuilderGraph constucted ";
       cluster->identify();
+      std::cout << "\tsigma eta: " << moments.sigma_eta << "\tsigma phi: " << moments.sigma_phi << "\tdispersion: " << moments.dispersion << std::endl;
     }  //  for (const auto & cluster_pair : _clusters->getClustersMap())
 
     // The output of the cluster will be in the RawClusterContainer class
@@ -176,9 +257,23 @@ int RawClusterBuilderHelper::process_event(PHCompositeNode *topNode)
 
 int RawClusterBuilderHelper::End(PHCompositeNode * /*topNode*/)
 {
+  if (_cluster_pool)
+  {
+    std::cout << Name() << ": cluster pool allocated " << _cluster_pool->get_nallocated()
+              << " clusters, allocations avoided: " << _cluster_pool->get_nrecycled() << std::endl;
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
+RawCluster *RawClusterBuilderHelper::NewCluster()
+{
+  if (_cluster_pool)
+  {
+    return _cluster_pool->NewCluster();
+  }
+  return new RawClusterv1();
+}
+
 bool RawClusterBuilderHelper::IsForwardCalorimeter(int caloID)
 {
   switch (caloID)
@@ -253,7 +348,15 @@ void RawClusterBuilderHelper::CreateNodes(PHCompositeNode *topNode)
     dstNode->addNode(DetNode);
   }
 
-  _clusters = new RawClusterContainer();
+  if (_use_cluster_pool)
+  {
+    _cluster_pool = new RawClusterContainerPool();
+    _clusters = _cluster_pool;
+  }
+  else
+  {
+    _clusters = new RawClusterContainer();
+  }
   ClusterNodeName = "CLUSTER_" + detector;
   PHIODataNode<PHObject> *clusterNode = new PHIODataNode<PHObject>(_clusters, ClusterNodeName, "PHObject");
   DetNode->addNode(clusterNode);
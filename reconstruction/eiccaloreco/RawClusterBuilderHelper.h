@@ -3,13 +3,21 @@
 
 #include <calobase/RawClusterContainer.h>
 #include <calobase/RawTower.h>
+#include <calobase/RawTowerContainer.h>
 #include <calobase/RawTowerDefs.h>
 
 #include <fun4all/SubsysReco.h>
 
 #include <phool/PHCompositeNode.h>
 
+#include "RawClusterTowerGeomCache.h"
+#include "RawClusterTowerGrid.h"
+
 #include <string>
+#include <vector>
+
+class RawCluster;
+class RawClusterContainerPool;
 
 class RawClusterBuilderHelper : public SubsysReco
 {
@@ -32,9 +40,19 @@ class RawClusterBuilderHelper : public SubsysReco
   int process_event(PHCompositeNode *topNode) override;
   int End(PHCompositeNode *topNode) override;
 
+  // process_event in two steps: the node lookups and the clustering itself, which does not
+  // touch the node tree, so several detectors can be clustered concurrently
+  int GetNodes(PHCompositeNode *topNode);
+  int ClusterTowers();
+
   void Detector(const std::string &d) { detector = d; }
   void set_seed_e(const float e) { _seed_e = e; }
   void set_agg_e(const float e) { _agg_e = e; }
+  // keep the cluster objects in a RawClusterContainerPool and reuse them in the next event
+  void set_use_cluster_pool(const bool b) { _use_cluster_pool = b; }
+
+  // energy, centroid and shower shape of the clusters of the last event, in the order of the cluster map
+  const std::vector<RawClusterTowerGeomCache::clusterMoments> &get_cluster_moments() const { return _clusterMoments; }
 
  protected:
   float _seed_e;
@@ -43,8 +61,28 @@ class RawClusterBuilderHelper : public SubsysReco
   std::string ClusterNodeName;
 
   RawClusterContainer *_clusters;
+  // same container as _clusters if the cluster pool is used
+  RawClusterContainerPool *_cluster_pool;
+  bool _use_cluster_pool;
+  // clusters store a share of the tower energy (kLM), use it for energy and position
+  bool _use_tower_map_energy;
+  RawTowerContainer *_towers;
+  // occupancy grid of input_towers, indices refer to the positions in input_towers
+  RawClusterTowerGrid _towerGrid;
+  // tower geometry, cached in InitRun
+  RawClusterTowerGeomCache _towerGeomCache;
+  // energy of the towers above threshold by dense geometry index
+  std::vector<double> _towerGeomE;
+  // flattened towers of all clusters for the moment kernel
+  std::vector<unsigned int> _clusterOffsets;
+  std::vector<int> _clusterTowerIndex;
+  std::vector<double> _clusterTowerE;
+  std::vector<RawClusterTowerGeomCache::clusterMoments> _clusterMoments;
 
+  // input_towers are sorted by decreasing energy and indexed in _towerGrid
   virtual void cluster(std::vector<towersStrct> &input_towers, uint caloId) { return; };
+  // new cluster for cluster(), recycled from the cluster pool if it is used
+  RawCluster *NewCluster();
 
   int caloTowersPhi(int caloID);
   bool IsForwardCalorimeter(int caloID);
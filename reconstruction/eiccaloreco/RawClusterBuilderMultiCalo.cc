@@ -0,0 +1,204 @@
+#include <RawClusterBuilderHelper.h>
+#include <RawClusterBuilderMultiCalo.h>
+#include <RawClusterBuilderkMA.h>
+#include <RawClusterBuilderkLM.h>
+#include <RawClusterBuilderkMAParallel.h>
+#include <RawClusterBuilderkV3.h>
+
+#include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/SubsysReco.h>
+
+#include <phool/PHCompositeNode.h>
+
+#include <TROOT.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+RawClusterBuilderMultiCalo::RawClusterBuilderMultiCalo(const std::string &name)
+  : SubsysReco(name)
+  , _nthreads(1)
+  , _use_cluster_pool(false)
+  , _nevents(0)
+  , _generation(0)
+  , _next_job(0)
+  , _jobs_done(0)
+  , _stop(false)
+{
+}
+
+RawClusterBuilderMultiCalo::~RawClusterBuilderMultiCalo()
+{
+  stop_workers();
+  for (auto builder : _builders)
+  {
+    delete builder;
+  }
+}
+
+void RawClusterBuilderMultiCalo::add_detector(const std::string &d, const algorithm algo, const float seed_e, const float agg_e)
+{
+  RawClusterBuilderHelper *builder = nullptr;
+  switch (algo)
+  {
+  case kV3:
+    builder = new RawClusterBuilderkV3("RawClusterBuilderkV3_" + d);
+    break;
+  case kMA:
+    builder = new RawClusterBuilderkMA("RawClusterBuilderkMA_" + d);
+    break;
+  case kMAParallel:
+    builder = new RawClusterBuilderkMAParallel("RawClusterBuilderkMAParallel_" + d);
+    break;
+  case kLM:
+    builder = new RawClusterBuilderkLM("RawClusterBuilderkLM_" + d);
+    break;
+  default:
+    std::cout << Name() << ": unknown algorithm " << algo << " for " << d << ", not clustering it" << std::endl;
+    return;
+  }
+  builder->Detector(d);
+  builder->set_seed_e(seed_e);
+  builder->set_agg_e(agg_e);
+  builder->set_use_cluster_pool(_use_cluster_pool);
+  _builders.push_back(builder);
+  _detectors.push_back(d);
+  _walltime.push_back(0);
+}
+
+int RawClusterBuilderMultiCalo::InitRun(PHCompositeNode *topNode)
+{
+  for (auto builder : _builders)
+  {
+    builder->Verbosity(Verbosity());
+    int ret = builder->InitRun(topNode);
+    if (ret != Fun4AllReturnCodes::EVENT_OK)
+    {
+      return ret;
+    }
+  }
+
+  if (_nthreads > 1 && _workers.empty())
+  {
+    // the clusters are ROOT objects created on the worker threads
+    ROOT::EnableThreadSafety();
+    _stop = false;
+    for (int i = 1; i < _nthreads; i++)
+    {
+      _workers.push_back(std::thread(&RawClusterBuilderMultiCalo::worker_loop, this));
+    }
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int RawClusterBuilderMultiCalo::process_event(PHCompositeNode *topNode)
+{
+  // all node lookups happen here, the jobs only work on the containers
+  for (auto builder : _builders)
+  {
+    int ret = builder->GetNodes(topNode);
+    if (ret != Fun4AllReturnCodes::EVENT_OK)
+    {
+      return ret;
+    }
+  }
+  _nevents++;
+
+  if (_workers.empty())
+  {
+    _next_job = 0;
+    run_jobs();
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _next_job = 0;
+    _jobs_done = 0;
+    _generation++;
+  }
+  _cv_start.notify_all();
+  // this thread takes jobs as well
+  run_jobs();
+  std::unique_lock<std::mutex> lock(_mutex);
+  _cv_done.wait(lock, [this] { return _jobs_done == _builders.size(); });
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int RawClusterBuilderMultiCalo::End(PHCompositeNode *topNode)
+{
+  stop_workers();
+
+  double total = 0;
+  std::cout << Name() << ": clustering wall time per event with " << _nthreads << " threads" << std::endl;
+  for (unsigned int i = 0; i < _builders.size(); i++)
+  {
+    total += _walltime[i];
+    std::cout << "\t" << std::setw(10) << _detectors[i] << ": "
+              << (_nevents > 0 ? 1e3 * _walltime[i] / _nevents : 0) << " ms" << std::endl;
+    _builders[i]->End(topNode);
+  }
+  std::cout << "\t" << std::setw(10) << "sum" << ": " << (_nevents > 0 ? 1e3 * total / _nevents : 0) << " ms" << std::endl;
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+void RawClusterBuilderMultiCalo::worker_loop()
+{
+  unsigned int generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cv_start.wait(lock, [this, generation] { return _stop || _generation != generation; });
+      if (_stop)
+      {
+        return;
+      }
+      generation = _generation;
+    }
+    run_jobs();
+  }
+}
+
+void RawClusterBuilderMultiCalo::run_jobs()
+{
+  while (true)
+  {
+    unsigned int job = _next_job++;
+    if (job >= _builders.size())
+    {
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    _builders[job]->ClusterTowers();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    _walltime[job] += elapsed.count();
+
+    if (!_workers.empty())
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (++_jobs_done == _builders.size())
+      {
+        _cv_done.notify_one();
+      }
+    }
+  }
+}
+
+void RawClusterBuilderMultiCalo::stop_workers()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _cv_start.notify_all();
+  for (auto &worker : _workers)
+  {
+    worker.join();
+  }
+  _workers.clear();
+}
@@ -0,0 +1,69 @@
+#ifndef EICCALORECO_RAWCLUSTERBUILDERMULTICALO_H
+#define EICCALORECO_RAWCLUSTERBUILDERMULTICALO_H
+
+#include <fun4all/SubsysReco.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PHCompositeNode;
+class RawClusterBuilderHelper;
+
+// Clusters several calorimeters concurrently on a pool of threads.
+// Every detector gets its own clusterer (kV3, kMA, kMAParallel or kLM) writing to
+// its own CLUSTER_<det> node, so the detectors share no mutable state and the
+// clusters are the same as with one clusterer module per detector.
+class RawClusterBuilderMultiCalo : public SubsysReco
+{
+ public:
+  enum algorithm
+  {
+    kV3 = 0,
+    kMA = 1,
+    kMAParallel = 2,
+    kLM = 3
+  };
+
+  RawClusterBuilderMultiCalo(const std::string &name = "RawClusterBuilderMultiCalo");
+  ~RawClusterBuilderMultiCalo() override;
+
+  int InitRun(PHCompositeNode *topNode) override;
+  int process_event(PHCompositeNode *topNode) override;
+  int End(PHCompositeNode *topNode) override;
+
+  void add_detector(const std::string &d, const algorithm algo, const float seed_e = 0.5, const float agg_e = 0.1);
+  // number of threads including the one running process_event, 1 clusters all detectors sequentially
+  void set_nthreads(const int n) { _nthreads = n; }
+  // reuse the cluster objects between events, for the detectors added after this call
+  void set_use_cluster_pool(const bool b) { _use_cluster_pool = b; }
+
+ private:
+  void worker_loop();
+  void run_jobs();
+  void stop_workers();
+
+  int _nthreads;
+  bool _use_cluster_pool;
+
+  std::vector<RawClusterBuilderHelper *> _builders;
+  std::vector<std::string> _detectors;
+  // wall time spent clustering per detector in seconds
+  std::vector<double> _walltime;
+  unsigned int _nevents;
+
+  // worker pool, process_event starts a new generation of jobs (one per detector)
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _cv_start;
+  std::condition_variable _cv_done;
+  unsigned int _generation;
+  std::atomic<unsigned int> _next_job;
+  unsigned int _jobs_done;
+  bool _stop;
+};
+
+#endif  // EICCALORECO_RAWCLUSTERBUILDERMULTICALO_H
@@ -0,0 +1,176 @@
+#include <RawClusterBuilderHelper.h>
+#include <RawClusterBuilderkLM.h>
+#include <RawClusterTowerGrid.h>
+
+#include <calobase/RawCluster.h>
+#include <calobase/RawClusterContainer.h>
+#include <calobase/RawTower.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // (eta, phi, l) offsets of the towers around a tower in the same layer and in front/behind it
+  const int neighbourOffsets[10][3] = {
+      {-1, -1, 0}, {-1, 0, 0}, {-1, 1, 0}, {0, -1, 0}, {0, 1, 0}, {1, -1, 0}, {1, 0, 0}, {1, 1, 0},
+      {0, 0, -1}, {0, 0, 1}};
+}  // namespace
+
+RawClusterBuilderkLM::RawClusterBuilderkLM(const std::string &name)
+  : RawClusterBuilderHelper(name)
+  , _profile_radius(1.0)
+  , _max_radius(3)
+  , _max_iterations(10)
+  , _tolerance(1e-3)
+{
+  // shared towers only contribute their share to the cluster energy and position
+  _use_tower_map_energy = true;
+}
+
+void RawClusterBuilderkLM::cluster(std::vector<towersStrct> &input_towers, uint caloId)
+{
+  const int ntowers = input_towers.size();
+  const int nPhiWrap = IsForwardCalorimeter(caloId) ? 0 : caloTowersPhi(caloId);
+
+  // local maxima above seed threshold. The towers are sorted from most energetic to least
+  // in RawClusterBuilderHelper::process_event, so a tower is a local maximum if all its
+  // neighbours come later in the list, which also resolves ties between equal energies
+  std::vector<int> maxima;
+  std::vector<int> max_of(ntowers, -1);
+  for (int tit = 0; tit < ntowers && input_towers[tit].tower_E > _seed_e; tit++)
+  {
+    const towersStrct &refTower = input_towers[tit];
+    bool ismax = true;
+    for (const auto &offset : neighbourOffsets)
+    {
+      for (int ait = _towerGrid.First(refTower.tower_iEta + offset[0], refTower.tower_iPhi + offset[1], refTower.tower_iL + offset[2]);
+           ait != RawClusterTowerGrid::kEmpty; ait = _towerGrid.Next(ait))
+      {
+        if (ait < tit) ismax = false;
+      }
+    }
+    if (ismax)
+    {
+      max_of[tit] = maxima.size();
+      maxima.push_back(tit);
+    }
+  }
+  const int nmax = maxima.size();
+
+  // collect the towers around each maximum, other maxima are never shared
+  _pair_tower.clear();
+  _pair_max.clear();
+  _pair_weight.clear();
+  std::vector<int> visited(ntowers, -1);
+  std::vector<int> cluster_towers;
+  for (int imax = 0; imax < nmax; imax++)
+  {
+    const towersStrct &maxTower = input_towers[maxima[imax]];
+    cluster_towers.clear();
+    cluster_towers.push_back(maxima[imax]);
+    visited[maxima[imax]] = imax;
+    _pair_tower.push_back(maxima[imax]);
+    _pair_max.push_back(imax);
+    _pair_weight.push_back(1.);
+    for (unsigned int tit = 0; tit < cluster_towers.size(); tit++)
+    {
+      const towersStrct &refTower = input_towers[cluster_towers[tit]];
+      for (const auto &offset : neighbourOffsets)
+      {
+        for (int ait = _towerGrid.First(refTower.tower_iEta + offset[0], refTower.tower_iPhi + offset[1], refTower.tower_iL + offset[2]);
+             ait != RawClusterTowerGrid::kEmpty; ait = _towerGrid.Next(ait))
+        {
+          if (visited[ait] == imax || max_of[ait] >= 0) continue;
+          // only aggregate towers with lower energy than current tower
+          if (input_towers[ait].tower_E >= (refTower.tower_E + _agg_e)) continue;
+
+          const int deta = input_towers[ait].tower_iEta - maxTower.tower_iEta;
+          const int dl = input_towers[ait].tower_iL - maxTower.tower_iL;
+          int dphi = input_towers[ait].tower_iPhi - maxTower.tower_iPhi;
+          if (nPhiWrap > 0)
+          {
+            if (dphi > nPhiWrap / 2) dphi -= nPhiWrap;
+            if (dphi < -nPhiWrap / 2) dphi += nPhiWrap;
+          }
+          if (std::max(std::abs(deta), std::abs(dphi)) > _max_radius) continue;
+
+          visited[ait] = imax;
+          cluster_towers.push_back(ait);
+          _pair_tower.push_back(ait);
+          _pair_max.push_back(imax);
+          _pair_weight.push_back(std::exp(-std::sqrt(deta * deta + dphi * dphi + dl * dl) / _profile_radius));
+        }
+      }
+    }
+  }
+  const unsigned int npairs = _pair_tower.size();
+
+  // share the tower energies: fraction of tower t in cluster k = A_k w_kt / sum_j A_j w_jt,
+  // the amplitudes A_k start at the maximum tower energy and are updated with the shared energies
+  std::vector<double> amplitude(nmax);
+  std::vector<double> new_amplitude(nmax);
+  std::vector<double> denom(ntowers, 0);
+  for (int imax = 0; imax < nmax; imax++)
+  {
+    amplitude[imax] = input_towers[maxima[imax]].tower_E;
+  }
+  auto fill_denom = [&]() {
+    for (unsigned int p = 0; p < npairs; p++)
+    {
+      denom[_pair_tower[p]] = 0;
+    }
+    for (unsigned int p = 0; p < npairs; p++)
+    {
+      denom[_pair_tower[p]] += amplitude[_pair_max[p]] * _pair_weight[p];
+    }
+  };
+  int niterations = 0;
+  bool converged = false;
+  while (!converged && niterations < _max_iterations)
+  {
+    fill_denom();
+    std::fill(new_amplitude.begin(), new_amplitude.end(), 0.);
+    for (unsigned int p = 0; p < npairs; p++)
+    {
+      const int t = _pair_tower[p];
+      if (denom[t] > 0)
+      {
+        new_amplitude[_pair_max[p]] += input_towers[t].tower_E * amplitude[_pair_max[p]] * _pair_weight[p] / denom[t];
+      }
+    }
+    converged = true;
+    for (int imax = 0; imax < nmax; imax++)
+    {
+      if (std::abs(new_amplitude[imax] - amplitude[imax]) > _tolerance * std::abs(amplitude[imax])) converged = false;
+    }
+    amplitude.swap(new_amplitude);
+    niterations++;
+  }
+  // denominators for the final amplitudes
+  fill_denom();
+
+  // one cluster per maximum in the order of the maxima
+  std::vector<RawCluster *> clusters(nmax);
+  for (int imax = 0; imax < nmax; imax++)
+  {
+    clusters[imax] = NewCluster();
+    _clusters->AddCluster(clusters[imax]);
+  }
+  for (unsigned int p = 0; p < npairs; p++)
+  {
+    const int t = _pair_tower[p];
+    const double fraction = (denom[t] > 0) ? amplitude[_pair_max[p]] * _pair_weight[p] / denom[t] : 1.;
+    clusters[_pair_max[p]]->addTower(input_towers[t].twr->get_id(), fraction * input_towers[t].tower_E);
+  }
+
+  if (Verbosity() > 2)
+  {
+    std::cout << Name() << ": " << nmax << " local maxima, " << npairs << " tower/maximum pairs from "
+              << ntowers << " towers, energy sharing converged after " << niterations << " iterations" << std::endl;
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef EICCALORECO_RAWCLUSTERBUILDERKLM_H
+#define EICCALORECO_RAWCLUSTERBUILDERKLM_H
+
+#include <RawClusterBuilderHelper.h>
+
+#include <string>
+#include <vector>
+
+// Local maximum clustering with energy sharing between overlapping showers.
+// Every local maximum above seed threshold starts a cluster. From each maximum
+// the towers within _max_radius are collected like kMA does (only towers with
+// lower energy than the tower they are reached from, up to _agg_e), towers
+// reached from several maxima are shared. The shared tower energy is split
+// according to the cluster amplitudes times an exponential shower profile,
+// exp(-d / _profile_radius) with d the distance to the maximum in towers.
+// The amplitudes are updated iteratively until they change by less than
+// _tolerance or _max_iterations is reached.
+class RawClusterBuilderkLM : public RawClusterBuilderHelper
+{
+ public:
+  RawClusterBuilderkLM(const std::string &name);
+
+  // shower profile radius and max. distance of a tower from its maximum, in towers
+  void set_profile_radius(const float r) { _profile_radius = r; }
+  void set_max_radius(const int r) { _max_radius = r; }
+  void set_max_iterations(const int n) { _max_iterations = n; }
+  void set_tolerance(const float t) { _tolerance = t; }
+
+ protected:
+  void cluster(std::vector<towersStrct> &input_towers, uint caloId) override;
+
+ private:
+  float _profile_radius;
+  int _max_radius;
+  int _max_iterations;
+  float _tolerance;
+
+  // one entry per (tower, maximum) pair: tower index, maximum number and profile weight
+  std::vector<int> _pair_tower;
+  std::vector<int> _pair_max;
+  std::vector<double> _pair_weight;
+};
+
+#endif
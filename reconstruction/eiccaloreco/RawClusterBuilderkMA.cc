@@ -1,5 +1,6 @@
 #include <RawClusterBuilderHelper.h>
 #include <RawClusterBuilderkMA.h>
+#include <RawClusterTowerGrid.h>
 
 #include <calobase/RawCluster.h>
 #include <calobase/RawClusterContainer.h>
@@ -22,93 +23,69 @@
 #include <phool/getClass.h>
 #include <phool/phool.h>
 
-#include <TMath.h>
-
 #include <algorithm>
 #include <cassert>
+#include <iostream>
 #include <string>
 #include <utility>
+#include <vector>
+
+const int RawClusterBuilderkMA::neighbourOffsets[18][3] = {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1},
+    {-1, -1, 0}, {-1, 1, 0}, {1, -1, 0}, {1, 1, 0},
+    {-1, 0, -1}, {-1, 0, 1}, {1, 0, -1}, {1, 0, 1},
+    {0, -1, -1}, {0, -1, 1}, {0, 1, -1}, {0, 1, 1}};
 
 RawClusterBuilderkMA::RawClusterBuilderkMA(const std::string &name)
   : RawClusterBuilderHelper(name)
 {
 }
 
-void RawClusterBuilderkMA::cluster(std::vector<towersStrct> &input_towers, uint caloId)
+void RawClusterBuilderkMA::cluster(std::vector<towersStrct> &input_towers, uint /*caloId*/)
 {
-  std::sort(input_towers.begin(), input_towers.end(), &towerECompare);
-  std::vector<towersStrct> cluster_towers;
-  while (!input_towers.empty())
+  // the towers are sorted from most energetic to least in RawClusterBuilderHelper::process_event
+  // towers already added to a cluster are flagged instead of erased from the list
+  std::vector<bool> tower_used(input_towers.size(), false);
+  std::vector<int> cluster_towers;
+  for (unsigned int sit = 0; sit < input_towers.size(); sit++)
   {
-    cluster_towers.clear();
+    if (tower_used[sit]) continue;
+    // always start with highest energetic tower, all remaining ones are below seed threshold
+    if (input_towers[sit].tower_E <= _seed_e) break;
 
-    // always start with highest energetic tower
-    if (input_towers.at(0).tower_E > _seed_e)
+    // std::cout << "new cluster" << std::endl;
+    cluster_towers.clear();
+    // fill seed cell information into current cluster
+    cluster_towers.push_back(sit);
+    tower_used[sit] = true;
+    RawCluster *cluster = NewCluster();
+    _clusters->AddCluster(cluster);
+    cluster->addTower(input_towers[sit].twr->get_id(), input_towers[sit].tower_E);
+    // std::cout << "running MA" << std::endl;
+    for (unsigned int tit = 0; tit < cluster_towers.size(); tit++)
     {
-      // std::cout << "new cluster" << std::endl;
-      // fill seed cell information into current cluster
-      cluster_towers.push_back(input_towers.at(0));
-      RawCluster *cluster = new RawClusterv1();
-      _clusters->AddCluster(cluster);
-      cluster->addTower(input_towers.at(0).twr->get_id(), input_towers.at(0).tower_E);
-      // std::cout << "running MA" << std::endl;
-      // remove seed tower from sample
-      input_towers.erase(input_towers.begin());
-      for (int tit = 0; tit < (int) cluster_towers.size(); tit++)
+      // std::cout << "recurse" << std::endl;
+      // Now go recursively to all neighbours and add them to the cluster if they fulfill the conditions
+      const towersStrct &refTower = input_towers[cluster_towers[tit]];
+      int refC = 0;
+      for (const auto &offset : neighbourOffsets)
       {
-        // std::cout << "recurse" << std::endl;
-        // Now go recursively to all neighbours and add them to the cluster if they fulfill the conditions
-        int iEtaTwr = cluster_towers.at(tit).tower_iEta;
-        int iPhiTwr = cluster_towers.at(tit).tower_iPhi;
-        int iLTwr = cluster_towers.at(tit).tower_iL;
-        int refC = 0;
-        for (int ait = 0; ait < (int) input_towers.size(); ait++)
+        for (int ait = _towerGrid.First(refTower.tower_iEta + offset[0], refTower.tower_iPhi + offset[1], refTower.tower_iL + offset[2]);
+             ait != RawClusterTowerGrid::kEmpty; ait = _towerGrid.Next(ait))
         {
-          int iEtaTwrAgg = input_towers.at(ait).tower_iEta;
-          int iPhiTwrAgg = input_towers.at(ait).tower_iPhi;
-          int iLTwrAgg = input_towers.at(ait).tower_iL;
-
-          if (!IsForwardCalorimeter(caloId))
-          {
-            if (iPhiTwr < 5 && iPhiTwrAgg > caloTowersPhi(caloId) - 5)
-            {
-              iPhiTwrAgg = iPhiTwrAgg - caloTowersPhi(caloId);
-            }
-            if (iPhiTwr > caloTowersPhi(caloId) - 5 && iPhiTwrAgg < 5)
-            {
-              iPhiTwr = iPhiTwr - caloTowersPhi(caloId);
-            }
-          }
-
-          int deltaL = TMath::Abs(iLTwrAgg - iLTwr);
-          int deltaPhi = TMath::Abs(iPhiTwrAgg - iPhiTwr);
-          int deltaEta = TMath::Abs(iEtaTwrAgg - iEtaTwr);
-          // std::cout << "DeltaL: " << deltaL;
-          // std::cout << "\tDeltaPhi: " << deltaPhi;
-          // std::cout << "\tDeltaEta: " << deltaEta << std::endl;
-          bool neighbor = (deltaL + deltaPhi + deltaEta == 1);
-          bool corner2D = (deltaL == 0 && deltaPhi == 1 && deltaEta == 1) || (deltaL == 1 && deltaPhi == 0 && deltaEta == 1) || (deltaL == 1 && deltaPhi == 1 && deltaEta == 0);
-          // first condition asks for V3-like neighbors, while second condition also checks diagonally attached towers
-          if (neighbor || corner2D)
-          {
-            // only aggregate towers with lower energy than current tower
-            // if(caloId != RawTowerDefs::LFHCAL){  // TODO Why?
-            if (input_towers.at(ait).tower_E >= (cluster_towers.at(tit).tower_E + _agg_e)) continue;
-            // }
-            cluster_towers.push_back(input_towers.at(ait));
-            // std::cout << "added a tower to the cluster" << std::endl;
-            cluster->addTower(input_towers.at(ait).twr->get_id(), input_towers.at(ait).tower_E);  // Add tower to cluster)
-            input_towers.erase(input_towers.begin() + ait);
-            if (Verbosity() > 2) std::cout << "aggregated: " << iEtaTwrAgg << "\t" << iPhiTwrAgg << "\t" << iLTwrAgg << "\t E:" << input_towers.at(ait).tower_E << "\t reference: " << refC << "\t" << iEtaTwr << "\t" << iPhiTwr << "\t" << iLTwr << "\t cond.: \t" << neighbor << "\t" << corner2D << "\t  diffs: " << deltaEta << "\t" << deltaPhi << "\t" << deltaL << std::endl;
-            ait--;
-            refC++;
-          }
+          if (tower_used[ait]) continue;
+          // only aggregate towers with lower energy than current tower
+          // if(caloId != RawTowerDefs::LFHCAL){  // TODO Why?
+          if (input_towers[ait].tower_E >= (refTower.tower_E + _agg_e)) continue;
+          // }
+          cluster_towers.push_back(ait);
+          tower_used[ait] = true;
+          // std::cout << "added a tower to the cluster" << std::endl;
+          cluster->addTower(input_towers[ait].twr->get_id(), input_towers[ait].tower_E);  // Add tower to cluster)
+          if (Verbosity() > 2) std::cout << "aggregated: " << input_towers[ait].tower_iEta << "\t" << input_towers[ait].tower_iPhi << "\t" << input_towers[ait].tower_iL << "\t E:" << input_towers[ait].tower_E << "\t reference: " << refC << "\t" << refTower.tower_iEta << "\t" << refTower.tower_iPhi << "\t" << refTower.tower_iL << "\t offset: \t" << offset[0] << "\t" << offset[1] << "\t" << offset[2] << std::endl;
+          refC++;
         }
       }
     }
-    else
-    {
-      input_towers.clear();
-    }
   }
 }
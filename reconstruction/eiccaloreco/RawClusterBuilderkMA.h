@@ -13,6 +13,9 @@ class RawClusterBuilderkMA : public RawClusterBuilderHelper
 
  protected:
   void cluster(std::vector<RawClusterBuilderHelper::towersStrct> &input_towers, uint caloId) override;
+
+  // (eta, phi, l) offsets of the V3-like neighbours followed by the diagonally attached towers
+  static const int neighbourOffsets[18][3];
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include <RawClusterBuilderHelper.h>
+#include <RawClusterBuilderkMAParallel.h>
+#include <RawClusterTowerGrid.h>
+
+#include <calobase/RawCluster.h>
+#include <calobase/RawClusterContainer.h>
+#include <calobase/RawClusterv1.h>
+#include <calobase/RawTower.h>
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/PHCompositeNode.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+RawClusterBuilderkMAParallel::RawClusterBuilderkMAParallel(const std::string &name)
+  : RawClusterBuilderkMA(name)
+  , _nthreads(1)
+  , _compare_kMA(false)
+  , _ncompared(0)
+  , _nmismatched(0)
+  , _round_towers(nullptr)
+  , _round_tiles(0)
+  , _next_tile(0)
+  , _pending_tiles(0)
+  , _generation(0)
+  , _stop(false)
+{
+}
+
+RawClusterBuilderkMAParallel::~RawClusterBuilderkMAParallel()
+{
+  stopWorkers();
+}
+
+int RawClusterBuilderkMAParallel::End(PHCompositeNode *topNode)
+{
+  if (_compare_kMA)
+  {
+    std::cout << Name() << ": compared " << _ncompared << " events with kMA, "
+              << _nmismatched << " events with different clusters" << std::endl;
+  }
+  return RawClusterBuilderkMA::End(topNode);
+}
+
+void RawClusterBuilderkMAParallel::cluster(std::vector<towersStrct> &input_towers, uint caloId)
+{
+  // the towers are sorted from most energetic to least in RawClusterBuilderHelper::process_event,
+  // so the index of a seed is its rank. Towers not reached by any seed keep label ntowers
+  const int ntowers = input_towers.size();
+  if (ntowers == 0)
+  {
+    return;
+  }
+  int minEta = input_towers[0].tower_iEta;
+  int maxEta = minEta;
+  for (const auto &tower : input_towers)
+  {
+    minEta = std::min(minEta, tower.tower_iEta);
+    maxEta = std::max(maxEta, tower.tower_iEta);
+  }
+  // tiles are slices in eta, at least one eta bin wide
+  const int nEta = maxEta - minEta + 1;
+  const int ntiles = std::max(1, std::min(_nthreads, nEta));
+
+  _label.assign(ntowers, ntowers);
+  _tile.resize(ntowers);
+  _work.resize(ntiles);
+  _outbox.resize(ntiles);
+  for (int i = 0; i < ntowers; i++)
+  {
+    _tile[i] = ((input_towers[i].tower_iEta - minEta) * ntiles) / nEta;
+    // every tower above seed threshold which is not reached by a more energetic seed starts a cluster
+    if (input_towers[i].tower_E > _seed_e)
+    {
+      _label[i] = i;
+      _work[_tile[i]].push_back(std::make_pair(i, i));
+    }
+  }
+
+  bool changed = true;
+  while (changed)
+  {
+    for (auto &work : _work)
+    {
+      std::make_heap(work.begin(), work.end(), std::greater<std::pair<int, int>>());
+    }
+    if (ntiles == 1)
+    {
+      propagate_tile(input_towers, 0);
+    }
+    else
+    {
+      _round_towers = &input_towers;
+      runTiles(ntiles);
+      _round_towers = nullptr;
+    }
+    // merge across tile borders, the receiving tile continues from there in the next round
+    changed = false;
+    for (auto &outbox : _outbox)
+    {
+      for (const auto &entry : outbox)
+      {
+        if (entry.first < _label[entry.second])
+        {
+          _label[entry.second] = entry.first;
+          _work[_tile[entry.second]].push_back(entry);
+          changed = true;
+        }
+      }
+      outbox.clear();
+    }
+  }
+
+  // one cluster per surviving seed, created in seed order like kMA does
+  std::vector<RawCluster *> seed_cluster(ntowers, nullptr);
+  for (int i = 0; i < ntowers; i++)
+  {
+    if (_label[i] == i)
+    {
+      seed_cluster[i] = NewCluster();
+      _clusters->AddCluster(seed_cluster[i]);
+    }
+  }
+  for (int i = 0; i < ntowers; i++)
+  {
+    if (_label[i] < ntowers)
+    {
+      seed_cluster[_label[i]]->addTower(input_towers[i].twr->get_id(), input_towers[i].tower_E);
+    }
+  }
+  if (Verbosity() > 2)
+  {
+    std::cout << Name() << ": " << _clusters->size() << " clusters from " << ntowers << " towers on " << ntiles << " tiles" << std::endl;
+  }
+
+  if (_compare_kMA && !compare_kMA(input_towers, caloId))
+  {
+    _nmismatched++;
+  }
+}
+
+void RawClusterBuilderkMAParallel::propagate_tile(const std::vector<towersStrct> &input_towers, int tile)
+{
+  // Dijkstra-like: always continue from the most energetic seed, so every tower is settled once.
+  // Only labels of this tile are written, labels for towers in other tiles go to the outbox
+  std::vector<std::pair<int, int>> &work = _work[tile];
+  std::vector<std::pair<int, int>> &outbox = _outbox[tile];
+  const std::greater<std::pair<int, int>> heapcomp;
+  while (!work.empty())
+  {
+    std::pop_heap(work.begin(), work.end(), heapcomp);
+    const int label = work.back().first;
+    const int tit = work.back().second;
+    work.pop_back();
+    if (label != _label[tit]) continue;  // reached by a more energetic seed in the meantime
+
+    const towersStrct &refTower = input_towers[tit];
+    for (const auto &offset : neighbourOffsets)
+    {
+      for (int ait = _towerGrid.First(refTower.tower_iEta + offset[0], refTower.tower_iPhi + offset[1], refTower.tower_iL + offset[2]);
+           ait != RawClusterTowerGrid::kEmpty; ait = _towerGrid.Next(ait))
+      {
+        // only aggregate towers with lower energy than current tower
+        if (input_towers[ait].tower_E >= (refTower.tower_E + _agg_e)) continue;
+        if (_tile[ait] != tile)
+        {
+          outbox.push_back(std::make_pair(label, ait));
+        }
+        else if (label < _label[ait])
+        {
+          _label[ait] = label;
+          work.push_back(std::make_pair(label, ait));
+          std::push_heap(work.begin(), work.end(), heapcomp);
+        }
+      }
+    }
+  }
+}
+
+void RawClusterBuilderkMAParallel::startWorkers()
+{
+  _stop = false;
+  for (int ithread = 1; ithread < _nthreads; ithread++)
+  {
+    _workers.emplace_back(&RawClusterBuilderkMAParallel::workerLoop, this);
+  }
+}
+
+void RawClusterBuilderkMAParallel::runTiles(const int ntiles)
+{
+  if (_workers.empty())
+  {
+    startWorkers();
+  }
+  std::unique_lock<std::mutex> lock(_pool_mutex);
+  _round_tiles = ntiles;
+  _next_tile = 0;
+  _pending_tiles = ntiles;
+  _generation++;
+  _cv_start.notify_all();
+  takeTiles(lock);
+  _cv_done.wait(lock, [this] { return _pending_tiles == 0; });
+}
+
+void RawClusterBuilderkMAParallel::takeTiles(std::unique_lock<std::mutex> &lock)
+{
+  while (_next_tile < _round_tiles)
+  {
+    const int tile = _next_tile++;
+    lock.unlock();
+    propagate_tile(*_round_towers, tile);
+    lock.lock();
+    if (--_pending_tiles == 0)
+    {
+      _cv_done.notify_one();
+    }
+  }
+}
+
+void RawClusterBuilderkMAParallel::workerLoop()
+{
+  unsigned long generation = 0;
+  std::unique_lock<std::mutex> lock(_pool_mutex);
+  while (true)
+  {
+    _cv_start.wait(lock, [this, generation] { return _stop || _generation != generation; });
+    if (_stop)
+    {
+      return;
+    }
+    generation = _generation;
+    takeTiles(lock);
+  }
+}
+
+void RawClusterBuilderkMAParallel::stopWorkers()
+{
+  if (_workers.empty())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_pool_mutex);
+    _stop = true;
+  }
+  _cv_start.notify_all();
+  for (auto &worker : _workers)
+  {
+    worker.join();
+  }
+  _workers.clear();
+}
+
+bool RawClusterBuilderkMAParallel::compare_kMA(std::vector<towersStrct> &input_towers, uint caloId)
+{
+  _ncompared++;
+  // run the sequential kMA into a private container, the input towers are not modified by it
+  RawClusterContainer *clusters = _clusters;
+  RawClusterContainer reference;
+  _clusters = &reference;
+  RawClusterBuilderkMA::cluster(input_towers, caloId);
+  _clusters = clusters;
+
+  bool same = (reference.size() == _clusters->size());
+  if (same)
+  {
+    RawClusterContainer::ConstIterator refiter = reference.getClusters().first;
+    for (const auto &cluster_pair : _clusters->getClustersMap())
+    {
+      if (cluster_pair.second->get_towermap() != refiter->second->get_towermap())
+      {
+        same = false;
+        break;
+      }
+      ++refiter;
+    }
+  }
+  if (!same && Verbosity() > 0)
+  {
+    std::cout << Name() << ": different clusters than kMA, " << _clusters->size()
+              << " clusters vs " << reference.size() << " from kMA" << std::endl;
+  }
+  reference.Reset();
+  return same;
+}
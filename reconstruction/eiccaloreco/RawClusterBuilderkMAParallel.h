@@ -0,0 +1,74 @@
+#ifndef EICCALORECO_RAWCLUSTERBUILDERKMAPARALLEL_H
+#define EICCALORECO_RAWCLUSTERBUILDERKMAPARALLEL_H
+
+#include <RawClusterBuilderkMA.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class PHCompositeNode;
+
+// kMA clustering as seeded, energy ordered connected component labelling.
+// A tower belongs to the most energetic seed which can reach it through kMA
+// neighbours, which is exactly what the sequential kMA flood fill produces.
+// Labels (seed ranks) are propagated in parallel on tiles of the (eta, phi, l)
+// lattice, labels crossing a tile border are exchanged between rounds until
+// nothing changes anymore.
+class RawClusterBuilderkMAParallel : public RawClusterBuilderkMA
+{
+ public:
+  RawClusterBuilderkMAParallel(const std::string &name);
+  ~RawClusterBuilderkMAParallel() override;
+
+  int End(PHCompositeNode *topNode) override;
+
+  void set_nthreads(const int n) { _nthreads = n; }
+  // also run the sequential kMA on every event and count the events with different clusters
+  void set_compare_kMA(const bool b) { _compare_kMA = b; }
+
+ protected:
+  void cluster(std::vector<towersStrct> &input_towers, uint caloId) override;
+
+ private:
+  void propagate_tile(const std::vector<towersStrct> &input_towers, int tile);
+  // start the _nthreads - 1 worker threads, done once on the first round with more than one tile
+  void startWorkers();
+  // propagate all tiles of one round on the workers and this thread, returns when all are done
+  void runTiles(const int ntiles);
+  // propagate tiles of the current round until none is left, lock is on _pool_mutex
+  void takeTiles(std::unique_lock<std::mutex> &lock);
+  void workerLoop();
+  void stopWorkers();
+  bool compare_kMA(std::vector<towersStrct> &input_towers, uint caloId);
+
+  int _nthreads;
+  bool _compare_kMA;
+  unsigned int _ncompared;
+  unsigned int _nmismatched;
+
+  // per tower: seed rank of its cluster (= index of the seed in input_towers) and tile
+  std::vector<int> _label;
+  std::vector<int> _tile;
+  // per tile: towers to visit and labels to pass on to towers of other tiles
+  std::vector<std::vector<std::pair<int, int>>> _work;
+  std::vector<std::vector<std::pair<int, int>>> _outbox;
+
+  // persistent workers, the tiles of a propagation round are taken in order by them and the
+  // thread calling runTiles, so no threads are started per round or per event
+  std::vector<std::thread> _workers;
+  std::mutex _pool_mutex;  // guards the round state below
+  std::condition_variable _cv_start;
+  std::condition_variable _cv_done;
+  const std::vector<towersStrct> *_round_towers;
+  int _round_tiles;
+  int _next_tile;
+  int _pending_tiles;
+  unsigned long _generation;  // rounds handed to the workers
+  bool _stop;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "RawClusterBuilderkV3.h"
 #include "RawClusterBuilderHelper.h"
+#include "RawClusterTowerGrid.h"
 
 #include <calobase/RawCluster.h>
 #include <calobase/RawClusterContainer.h>
@@ -39,67 +40,52 @@ RawClusterBuilderkV3::RawClusterBuilderkV3(const std::string &name)
 {
 }
 
-void RawClusterBuilderkV3::cluster(std::vector<towersStrct> &input_towers, uint caloId)
+void RawClusterBuilderkV3::cluster(std::vector<towersStrct> &input_towers, uint /*caloId*/)
 {
-  // Next we'll sort the towers from most energetic to least
-  // This is from https://github.com/FriederikeBock/AnalysisSoftwareEIC/blob/642aeb13b13271820dfee59efe93380e58456289/treeAnalysis/clusterizer.cxx#L281
-  std::sort(input_towers.begin(), input_towers.end(), &towerECompare);
-  std::vector<towersStrct> cluster_towers;
+  // direct neighbours in (eta, phi), the layer is not considered for kV3
+  static const int neighbourOffsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+  // the towers are sorted from most energetic to least in RawClusterBuilderHelper::process_event
+  // towers already added to a cluster are flagged instead of erased from the list
+  std::vector<bool> tower_used(input_towers.size(), false);
+  std::vector<int> cluster_towers;
   // And run kV3 clustering
-  while (!input_towers.empty())
+  for (unsigned int sit = 0; sit < input_towers.size(); sit++)
   {
+    if (tower_used[sit]) continue;
+    // always start with highest energetic tower, all remaining ones are below seed threshold
+    if (input_towers[sit].tower_E <= _seed_e) break;
+
     cluster_towers.clear();
-    // always start with highest energetic tower
-    if (input_towers.at(0).tower_E > _seed_e)
+    RawCluster *cluster = NewCluster();
+    _clusters->AddCluster(cluster);  // Add cluster to cluster container
+    // fill seed cell information into current cluster
+    cluster->addTower(input_towers[sit].twr->get_id(), input_towers[sit].tower_E);
+    // std::cout << "Started new cluster! " << input_towers[sit].tower_E << std::endl;
+    cluster_towers.push_back(sit);
+    tower_used[sit] = true;
+    // kV3 Clustering
+    for (unsigned int tit = 0; tit < cluster_towers.size(); tit++)
     {
-      RawCluster *cluster = new RawClusterv1();
-      _clusters->AddCluster(cluster);  // Add cluster to cluster container
-      // fill seed cell information into current cluster
-      cluster->addTower(input_towers.at(0).twr->get_id(), input_towers.at(0).tower_E);
-      // std::cout << "Started new cluster! " << input_towers.at(0).tower_E << std::endl;
-      cluster_towers.push_back(input_towers.at(0));
-      // kV3 Clustering
-      input_towers.erase(input_towers.begin());
-      for (int tit = 0; tit < (int) cluster_towers.size(); tit++)
+      // Now go recursively to the next 4 neighbours and add them to the cluster if they fulfill the conditions
+      const towersStrct &refTower = input_towers[cluster_towers[tit]];
+      for (int il = _towerGrid.MinL(); il <= _towerGrid.MaxL(); il++)
       {
-        // Now go recursively to the next 4 neighbours and add them to the cluster if they fulfill the conditions
-        int iEtaTwr = cluster_towers.at(tit).tower_iEta;
-        int iPhiTwr = cluster_towers.at(tit).tower_iPhi;
-        for (int ait = 0; ait < (int) input_towers.size(); ait++)
+        for (const auto &offset : neighbourOffsets)
         {
-          int iEtaTwrAgg = input_towers.at(ait).tower_iEta;
-          int iPhiTwrAgg = input_towers.at(ait).tower_iPhi;
-
-          if (!IsForwardCalorimeter(caloId))
-          {
-            if (iPhiTwr < 5 && iPhiTwrAgg > caloTowersPhi(caloId) - 5)
-            {
-              iPhiTwrAgg = iPhiTwrAgg - caloTowersPhi(caloId);
-            }
-            if (iPhiTwr > caloTowersPhi(caloId) - 5 && iPhiTwrAgg < 5)
-            {
-              iPhiTwr = iPhiTwr - caloTowersPhi(caloId);
-            }
-          }
-          int deltaEta = std::abs(iEtaTwrAgg - iEtaTwr);
-          int deltaPhi = std::abs(iPhiTwrAgg - iPhiTwr);
-
-          if ((deltaEta + deltaPhi) == 1)
+          for (int ait = _towerGrid.First(refTower.tower_iEta + offset[0], refTower.tower_iPhi + offset[1], il);
+               ait != RawClusterTowerGrid::kEmpty; ait = _towerGrid.Next(ait))
           {
+            if (tower_used[ait]) continue;
             // only aggregate towers with lower energy than current tower
-            if (input_towers.at(ait).tower_E >= (cluster_towers.at(tit).tower_E + _agg_e)) continue;
-            cluster->addTower(input_towers.at(ait).twr->get_id(), input_towers.at(ait).tower_E);  // Add tower to cluster
-            // std::cout << "Added a tower to the cluster! " << input_towers.at(ait).tower_E << std::endl;
-            cluster_towers.push_back(input_towers.at(ait));
-            input_towers.erase(input_towers.begin() + ait);
-            ait--;
+            if (input_towers[ait].tower_E >= (refTower.tower_E + _agg_e)) continue;
+            cluster->addTower(input_towers[ait].twr->get_id(), input_towers[ait].tower_E);  // Add tower to cluster
+            // std::cout << "Added a tower to the cluster! " << input_towers[ait].tower_E << std::endl;
+            cluster_towers.push_back(ait);
+            tower_used[ait] = true;
           }
         }
       }
     }
-    else
-    {
-      input_towers.clear();
-    }
   }
 }
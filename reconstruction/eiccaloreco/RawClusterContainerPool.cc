@@ -0,0 +1,58 @@
+#include "RawClusterContainerPool.h"
+
+#include <calobase/RawCluster.h>
+#include <calobase/RawClusterContainer.h>
+#include <calobase/RawClusterv1.h>
+
+#include <iostream>
+#include <vector>
+
+RawClusterContainerPool::RawClusterContainerPool()
+  : _nallocated(0)
+  , _nrecycled(0)
+{
+}
+
+RawClusterContainerPool::~RawClusterContainerPool()
+{
+  for (auto cluster : _pool)
+  {
+    delete cluster;
+  }
+}
+
+void RawClusterContainerPool::Reset()
+{
+  for (auto &cluster_pair : getClustersMap())
+  {
+    _pool.push_back(cluster_pair.second);
+  }
+  getClustersMap().clear();
+}
+
+void RawClusterContainerPool::identify(std::ostream &os) const
+{
+  os << "RawClusterContainerPool, number of clusters: " << size()
+     << ", allocated: " << _nallocated << ", recycled: " << _nrecycled << std::endl;
+}
+
+RawCluster *RawClusterContainerPool::NewCluster()
+{
+  while (!_pool.empty())
+  {
+    RawCluster *cluster = _pool.back();
+    _pool.pop_back();
+    RawClusterv1 *clusterv1 = dynamic_cast<RawClusterv1 *>(cluster);
+    if (clusterv1)
+    {
+      // back to the state of a new cluster
+      *clusterv1 = RawClusterv1();
+      _nrecycled++;
+      return clusterv1;
+    }
+    // only RawClusterv1 are recycled, anything else added from outside is dropped
+    delete cluster;
+  }
+  _nallocated++;
+  return new RawClusterv1();
+}
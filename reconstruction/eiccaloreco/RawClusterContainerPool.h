@@ -0,0 +1,41 @@
+#ifndef EICCALORECO_RAWCLUSTERCONTAINERPOOL_H
+#define EICCALORECO_RAWCLUSTERCONTAINERPOOL_H
+
+#include <calobase/RawClusterContainer.h>
+
+#include <iostream>
+#include <vector>
+
+class RawCluster;
+
+// RawClusterContainer which keeps its clusters for the next event.
+// Reset() moves the clusters into a pool instead of deleting them and
+// NewCluster() hands out a cleared cluster from the pool, so after the
+// first events no cluster objects are allocated anymore.
+// The tower maps of the clusters are std::maps owned by RawClusterv1,
+// their nodes are still allocated per tower.
+class RawClusterContainerPool : public RawClusterContainer
+{
+ public:
+  RawClusterContainerPool();
+  ~RawClusterContainerPool() override;
+
+  void Reset() override;
+  void identify(std::ostream &os = std::cout) const override;
+
+  // cleared RawClusterv1 from the pool, a new one if the pool is empty.
+  // It still has to be added with AddCluster
+  RawCluster *NewCluster();
+
+  unsigned long get_nallocated() const { return _nallocated; }
+  unsigned long get_nrecycled() const { return _nrecycled; }
+
+ private:
+  std::vector<RawCluster *> _pool;  //! clusters kept from the last events
+  unsigned long _nallocated;        //!
+  unsigned long _nrecycled;         //!
+
+  ClassDefOverride(RawClusterContainerPool, 1)
+};
+
+#endif  // EICCALORECO_RAWCLUSTERCONTAINERPOOL_H
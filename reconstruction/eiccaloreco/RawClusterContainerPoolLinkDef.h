@@ -0,0 +1,5 @@
+#ifdef __CINT__
+
+#pragma link C++ class RawClusterContainerPool + ;
+
+#endif /* __CINT__ */
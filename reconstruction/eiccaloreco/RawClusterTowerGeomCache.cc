@@ -0,0 +1,126 @@
+#include "RawClusterTowerGeomCache.h"
+
+#include <calobase/RawTowerDefs.h>
+#include <calobase/RawTowerGeom.h>
+#include <calobase/RawTowerGeomContainer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void RawClusterTowerGeomCache::Build(RawTowerGeomContainer *towergeom)
+{
+  _key.clear();
+  _center_x.clear();
+  _center_y.clear();
+  _center_z.clear();
+  _eta.clear();
+  _phi.clear();
+
+  // the geometry map is ordered by key, so is the cache
+  RawTowerGeomContainer::ConstRange begin_end = towergeom->get_tower_geometries();
+  for (RawTowerGeomContainer::ConstIterator itr = begin_end.first; itr != begin_end.second; ++itr)
+  {
+    const RawTowerGeom *geom = itr->second;
+    _key.push_back(itr->first);
+    _center_x.push_back(geom->get_center_x());
+    _center_y.push_back(geom->get_center_y());
+    _center_z.push_back(geom->get_center_z());
+    _eta.push_back(geom->get_eta());
+    _phi.push_back(geom->get_phi());
+  }
+}
+
+int RawClusterTowerGeomCache::Index(RawTowerDefs::keytype key, int start) const
+{
+  std::vector<RawTowerDefs::keytype>::const_iterator it = std::lower_bound(_key.begin() + start, _key.end(), key);
+  if (it == _key.end() || *it != key)
+  {
+    return -1;
+  }
+  return it - _key.begin();
+}
+
+void RawClusterTowerGeomCache::ComputeMoments(const std::vector<unsigned int> &offsets, const std::vector<int> &towerIndex,
+                                              const std::vector<double> &towerE, std::vector<clusterMoments> &moments)
+{
+  // gather the geometry of all cluster towers once, the sums below then only run over contiguous arrays
+  const unsigned int ntowers = towerIndex.size();
+  _gather_x.resize(ntowers);
+  _gather_y.resize(ntowers);
+  _gather_z.resize(ntowers);
+  _gather_eta.resize(ntowers);
+  _gather_phi.resize(ntowers);
+  for (unsigned int i = 0; i < ntowers; i++)
+  {
+    const int index = towerIndex[i];
+    _gather_x[i] = _center_x[index];
+    _gather_y[i] = _center_y[index];
+    _gather_z[i] = _center_z[index];
+    _gather_eta[i] = _eta[index];
+    _gather_phi[i] = _phi[index];
+  }
+
+  const unsigned int nclusters = offsets.empty() ? 0 : offsets.size() - 1;
+  moments.resize(nclusters);
+  for (unsigned int icl = 0; icl < nclusters; icl++)
+  {
+    const unsigned int begin = offsets[icl];
+    const unsigned int end = offsets[icl + 1];
+    // phi is summed relative to the first tower so clusters across the +-pi border come out right
+    const double phi_ref = (begin < end) ? _gather_phi[begin] : 0;
+
+    double sum_e(0);
+    double sum_w(0);
+    double sum_x(0);
+    double sum_y(0);
+    double sum_z(0);
+    double sum_eta(0);
+    double sum_eta2(0);
+    double sum_dphi(0);
+    double sum_dphi2(0);
+    for (unsigned int i = begin; i < end; i++)
+    {
+      const double e = towerE[i];
+      // only positive energies enter the weighted positions
+      const double w = (e > 0) ? e : 0;
+      double dphi = _gather_phi[i] - phi_ref;
+      dphi -= (dphi > M_PI) ? 2 * M_PI : ((dphi < -M_PI) ? -2 * M_PI : 0);
+
+      sum_e += e;
+      sum_w += w;
+      sum_x += w * _gather_x[i];
+      sum_y += w * _gather_y[i];
+      sum_z += w * _gather_z[i];
+      sum_eta += w * _gather_eta[i];
+      sum_eta2 += w * _gather_eta[i] * _gather_eta[i];
+      sum_dphi += w * dphi;
+      sum_dphi2 += w * dphi * dphi;
+    }
+
+    clusterMoments &cm = moments[icl];
+    cm.e = sum_e;
+    cm.x = cm.y = cm.z = 0;
+    cm.eta = cm.phi = 0;
+    cm.sigma_eta = cm.sigma_phi = cm.dispersion = 0;
+    if (sum_e > 0)
+    {
+      cm.x = sum_x / sum_e;
+      cm.y = sum_y / sum_e;
+      cm.z = sum_z / sum_e;
+    }
+    if (sum_w > 0)
+    {
+      const double mean_dphi = sum_dphi / sum_w;
+      cm.eta = sum_eta / sum_w;
+      cm.phi = phi_ref + mean_dphi;
+      if (cm.phi > M_PI) cm.phi -= 2 * M_PI;
+      if (cm.phi <= -M_PI) cm.phi += 2 * M_PI;
+      const double var_eta = std::max(0., sum_eta2 / sum_w - cm.eta * cm.eta);
+      const double var_phi = std::max(0., sum_dphi2 / sum_w - mean_dphi * mean_dphi);
+      cm.sigma_eta = std::sqrt(var_eta);
+      cm.sigma_phi = std::sqrt(var_phi);
+      cm.dispersion = std::sqrt(var_eta + var_phi);
+    }
+  }
+}
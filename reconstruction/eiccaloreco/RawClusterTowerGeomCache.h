@@ -0,0 +1,65 @@
+#ifndef EICCALORECO_RAWCLUSTERTOWERGEOMCACHE_H
+#define EICCALORECO_RAWCLUSTERTOWERGEOMCACHE_H
+
+#include <calobase/RawTowerDefs.h>
+
+#include <vector>
+
+class RawTowerGeomContainer;
+
+// Structure of arrays copy of the tower geometry, filled once in InitRun.
+// Towers are addressed by a dense index (their position in key order), so
+// the per event cluster kernel works on contiguous arrays instead of
+// looking up RawTowerGeom objects in the geometry map for every tower.
+class RawClusterTowerGeomCache
+{
+ public:
+  // energy, centroid and energy weighted second moments of one cluster
+  typedef struct
+  {
+    double e;
+    double x;
+    double y;
+    double z;
+    double eta;
+    double phi;
+    // energy weighted widths in eta and phi (phi relative to the cluster phi)
+    double sigma_eta;
+    double sigma_phi;
+    // sqrt(sigma_eta^2 + sigma_phi^2)
+    double dispersion;
+  } clusterMoments;
+
+  RawClusterTowerGeomCache() {}
+  ~RawClusterTowerGeomCache() {}
+
+  void Build(RawTowerGeomContainer *towergeom);
+  bool empty() const { return _key.empty(); }
+  unsigned int size() const { return _key.size(); }
+
+  // dense index of the tower with the given key or -1, searching from dense index "start" on.
+  // Keys looked up in increasing order can pass the previous result to avoid searching again
+  int Index(RawTowerDefs::keytype key, int start = 0) const;
+
+  // Compute the moments of all clusters in one pass. The towers of cluster i are
+  // towerIndex[offsets[i]] ... towerIndex[offsets[i+1]-1] with energies towerE[...]
+  void ComputeMoments(const std::vector<unsigned int> &offsets, const std::vector<int> &towerIndex,
+                      const std::vector<double> &towerE, std::vector<clusterMoments> &moments);
+
+ private:
+  std::vector<RawTowerDefs::keytype> _key;
+  std::vector<double> _center_x;
+  std::vector<double> _center_y;
+  std::vector<double> _center_z;
+  std::vector<double> _eta;
+  std::vector<double> _phi;
+
+  // geometry of the cluster towers gathered into contiguous arrays for the kernel
+  std::vector<double> _gather_x;
+  std::vector<double> _gather_y;
+  std::vector<double> _gather_z;
+  std::vector<double> _gather_eta;
+  std::vector<double> _gather_phi;
+};
+
+#endif  // EICCALORECO_RAWCLUSTERTOWERGEOMCACHE_H
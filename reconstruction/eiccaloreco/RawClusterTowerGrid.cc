@@ -0,0 +1,87 @@
+#include "RawClusterTowerGrid.h"
+
+RawClusterTowerGrid::RawClusterTowerGrid()
+  : _minEta(0)
+  , _minPhi(0)
+  , _minL(0)
+  , _maxL(-1)
+  , _nEta(0)
+  , _nPhi(0)
+  , _nL(0)
+  , _nPhiWrap(0)
+{
+}
+
+void RawClusterTowerGrid::Reset(int minEta, int maxEta, int minPhi, int maxPhi, int minL, int maxL, int nPhiWrap, unsigned int nTowers)
+{
+  // only touch the cells used in the last event, everything else is still empty
+  for (int cell : _filled)
+  {
+    _head[cell] = kEmpty;
+  }
+  _filled.clear();
+
+  _minEta = minEta;
+  _minL = minL;
+  _maxL = maxL;
+  _nEta = maxEta - minEta + 1;
+  _nL = maxL - minL + 1;
+  // the wrap around needs the full phi range starting at bin 0
+  if (nPhiWrap > 0 && minPhi >= 0 && maxPhi < nPhiWrap)
+  {
+    _nPhiWrap = nPhiWrap;
+    _minPhi = 0;
+    _nPhi = nPhiWrap;
+  }
+  else
+  {
+    _nPhiWrap = 0;
+    _minPhi = minPhi;
+    _nPhi = maxPhi - minPhi + 1;
+  }
+  if (nTowers == 0)
+  {
+    _nEta = _nPhi = _nL = 0;
+  }
+
+  unsigned int ncells = _nEta * _nPhi * _nL;
+  if (_head.size() < ncells)
+  {
+    _head.resize(ncells, kEmpty);
+  }
+  _next.assign(nTowers, kEmpty);
+}
+
+void RawClusterTowerGrid::Insert(int index, int iEta, int iPhi, int iL)
+{
+  int cell = ((iL - _minL) * _nPhi + (iPhi - _minPhi)) * _nEta + (iEta - _minEta);
+  if (_head[cell] == kEmpty)
+  {
+    _filled.push_back(cell);
+  }
+  _next[index] = _head[cell];
+  _head[cell] = index;
+}
+
+int RawClusterTowerGrid::First(int iEta, int iPhi, int iL) const
+{
+  int eta = iEta - _minEta;
+  int l = iL - _minL;
+  int phi = iPhi - _minPhi;
+  if (_nPhiWrap > 0)
+  {
+    if (phi < 0)
+    {
+      phi += _nPhiWrap;
+    }
+    else if (phi >= _nPhiWrap)
+    {
+      phi -= _nPhiWrap;
+    }
+  }
+  if (eta < 0 || eta >= _nEta || phi < 0 || phi >= _nPhi || l < 0 || l >= _nL)
+  {
+    return kEmpty;
+  }
+  return _head[(l * _nPhi + phi) * _nEta + eta];
+}
@@ -0,0 +1,52 @@
+#ifndef EICCALORECO_RAWCLUSTERTOWERGRID_H
+#define EICCALORECO_RAWCLUSTERTOWERGRID_H
+
+#include <vector>
+
+// Dense (iEta, iPhi, iL) occupancy grid over the towers above threshold of one event.
+// Every cell holds the index of the first tower in it, further towers in the same
+// cell are chained via Next(), so neighbour queries are O(1) instead of a scan over
+// all towers. If phi wrapping is enabled phi bin -1 maps to nPhiWrap - 1 and vice versa.
+// Only the cells filled in the previous event are cleared on Reset, so the cost per
+// event grows with the number of towers and not with the size of the calorimeter.
+class RawClusterTowerGrid
+{
+ public:
+  static constexpr int kEmpty = -1;
+
+  RawClusterTowerGrid();
+  ~RawClusterTowerGrid() {}
+
+  // set up the grid for towers within the given (inclusive) bin ranges
+  // nPhiWrap > 0 enables the phi wrap around for barrel calorimeters with nPhiWrap bins
+  void Reset(int minEta, int maxEta, int minPhi, int maxPhi, int minL, int maxL, int nPhiWrap, unsigned int nTowers);
+  // add tower with index "index" (in the input tower list) to its cell
+  void Insert(int index, int iEta, int iPhi, int iL);
+
+  // first tower in cell (iEta, iPhi, iL) or kEmpty, bins outside of the grid are empty
+  int First(int iEta, int iPhi, int iL) const;
+  // next tower in the same cell or kEmpty
+  int Next(int index) const { return _next[index]; }
+
+  int MinL() const { return _minL; }
+  int MaxL() const { return _maxL; }
+
+ private:
+  int _minEta;
+  int _minPhi;
+  int _minL;
+  int _maxL;
+  int _nEta;
+  int _nPhi;
+  int _nL;
+  int _nPhiWrap;
+
+  // cell -> first tower index
+  std::vector<int> _head;
+  // tower index -> next tower index in the same cell
+  std::vector<int> _next;
+  // cells filled since the last Reset
+  std::vector<int> _filled;
+};
+
+#endif  // EICCALORECO_RAWCLUSTERTOWERGRID_H
@@ -51,6 +51,60 @@ enum PIDCandidate
   InvalidCandiate = 0
 };
 
+//! number of PID candidates and detectors (without PIDAll) for fixed size storage
+static const int nPIDCandidates = 5;
+static const int nPIDDetectors = 8;
+
+//! PID candidates and detectors in the order of their dense index
+const PIDCandidate PIDCandidates[nPIDCandidates] = {ElectronCandiate, MuonCandiate, PionCandiate, KaonCandiate, ProtonCandiate};
+const PIDDetector PIDDetectors[nPIDDetectors] = {mRICH, DIRC, dRICH_AeroGel, dRICH_Gas, GasRICH, ETTL, CTTL, FTTL};
+
+//! dense index of a PID candidate, -1 for InvalidCandiate or unknown values
+inline int getPIDCandidateIndex(const PIDCandidate pid)
+{
+  switch (pid)
+  {
+  case ElectronCandiate:
+    return 0;
+  case MuonCandiate:
+    return 1;
+  case PionCandiate:
+    return 2;
+  case KaonCandiate:
+    return 3;
+  case ProtonCandiate:
+    return 4;
+  default:
+    return -1;
+  }
+}
+
+//! dense index of a PID detector, -1 for PIDAll, InvalidDetector or unknown values
+inline int getPIDDetectorIndex(const PIDDetector det)
+{
+  switch (det)
+  {
+  case mRICH:
+    return 0;
+  case DIRC:
+    return 1;
+  case dRICH_AeroGel:
+    return 2;
+  case dRICH_Gas:
+    return 3;
+  case GasRICH:
+    return 4;
+  case ETTL:
+    return 5;
+  case CTTL:
+    return 6;
+  case FTTL:
+    return 7;
+  default:
+    return -1;
+  }
+}
+
 //! convert PID detector node names in to ID number for the container.
 PIDDetector getPIDDetector(const std::string& name);
 
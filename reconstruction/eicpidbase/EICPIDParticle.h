@@ -29,6 +29,7 @@ class EICPIDParticle : public PHObject
   virtual float get_SumLogLikelyhood(EICPIDDefs::PIDCandidate) const { return 0; }
   virtual float get_LogLikelyhood(EICPIDDefs::PIDCandidate, EICPIDDefs::PIDDetector) const { return m_minLogLikelihood; }
   virtual void set_LogLikelyhood(EICPIDDefs::PIDCandidate, EICPIDDefs::PIDDetector, float) {}
+  virtual bool has_LogLikelyhood(EICPIDDefs::PIDCandidate, EICPIDDefs::PIDDetector) const { return false; }
 
   enum PROPERTY_TYPE
   {  //
@@ -41,6 +42,7 @@ class EICPIDParticle : public PHObject
   //! Procedure to add a new PROPERTY tag:
   //! 1.add new tag below with unique value,
   //! 2.add a short name to EICPIDParticle::m_propertyInfo
+  //! 3.give it the next dense index in get_property_index and increase nProperties
   enum PROPERTY
   {
     Truth_PID = 0,
@@ -56,6 +58,31 @@ class EICPIDParticle : public PHObject
     prop_MAX_NUMBER = UCHAR_MAX
   };
 
+  //! number of defined properties, for fixed size storage
+  static const int nProperties = 6;
+
+  //! dense index of a defined property, -1 for the other ids
+  static int get_property_index(const PROPERTY prop_id)
+  {
+    switch (prop_id)
+    {
+    case Truth_PID:
+      return 0;
+    case Truth_momentum:
+      return 1;
+    case Truth_eta:
+      return 2;
+    case CTTL_beta:
+      return 3;
+    case ETTL_beta:
+      return 4;
+    case FTTL_beta:
+      return 5;
+    default:
+      return -1;
+    }
+  }
+
   // property info definition in the EICPIDParticle.cc file
   const static std::map<PROPERTY,
                         std::pair<const std::string, EICPIDParticle::PROPERTY_TYPE> >
@@ -72,9 +99,10 @@ class EICPIDParticle : public PHObject
   static bool check_property(const PROPERTY prop_id, const PROPERTY_TYPE prop_type);
   static std::string get_property_type(const PROPERTY_TYPE prop_type);
 
- protected:
+  //! log likelihood of a candidate that a detector did not evaluate
   static constexpr float m_minLogLikelihood = -100;
 
+ protected:
   virtual unsigned int get_property_nocheck(const PROPERTY /*prop_id*/) const { return UINT_MAX; }
   virtual void set_property_nocheck(const PROPERTY /*prop_id*/, const unsigned int) { return; }
   ClassDefOverride(EICPIDParticle, 1)
@@ -6,7 +6,7 @@
 
 #include <cstdlib>
 #include "EICPIDParticle.h"
-#include "EICPIDParticlev1.h"
+#include "EICPIDParticlev2.h"
 
 using namespace std;
 
@@ -58,7 +58,7 @@ EICPIDParticleContainer::Iterator EICPIDParticleContainer::findOrAddPIDParticle(
   EICPIDParticleContainer::Iterator it = m_particleMap.find(key);
   if (it == m_particleMap.end())
   {
-    m_particleMap[key] = new EICPIDParticlev1();
+    m_particleMap[key] = new EICPIDParticlev2();
     it = m_particleMap.find(key);
     EICPIDParticle* mhit = it->second;
     mhit->set_id(key);
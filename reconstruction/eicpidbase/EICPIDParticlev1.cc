@@ -93,6 +93,12 @@ void EICPIDParticlev1::set_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDef
   m_LogLikelyhoodMap[key] = LogLikelyhood;
 }
 
+bool EICPIDParticlev1::has_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const
+{
+  const LogLikelyhoodMapKey_t key(pid, det);
+  return m_LogLikelyhoodMap.find(key) != m_LogLikelyhoodMap.end();
+}
+
 bool EICPIDParticlev1::has_property(const PROPERTY prop_id) const
 {
   prop_map_t::const_iterator i = prop_map.find(prop_id);
@@ -27,6 +27,7 @@ class EICPIDParticlev1 : public EICPIDParticle
   float get_SumLogLikelyhood(EICPIDDefs::PIDCandidate pid) const override;
   float get_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const override;
   void set_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det, float LogLikelyhood) override;
+  bool has_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const override;
 
   bool has_property(const PROPERTY prop_id) const override;
   float get_property_float(const PROPERTY prop_id) const override;
@@ -0,0 +1,270 @@
+#include "EICPIDParticlev2.h"
+
+#include <phool/phool.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include "EICPIDDefs.h"
+
+using namespace std;
+
+EICPIDParticlev2::EICPIDParticlev2(const EICPIDParticle* g4hit)
+{
+  CopyFrom(g4hit);
+}
+
+void EICPIDParticlev2::Reset()
+{
+  m_id = -1;
+  fill(m_prop_data, m_prop_data + nProperties, 0);
+  m_prop_mask = 0;
+  for (int icand = 0; icand < EICPIDDefs::nPIDCandidates; icand++)
+  {
+    for (int idet = 0; idet < EICPIDDefs::nPIDDetectors; idet++)
+    {
+      m_LogLikelyhood[icand][idet] = 0;
+    }
+    m_LogLikelyhoodMask[icand] = 0;
+    m_SumLogLikelyhood[icand] = 0;
+  }
+}
+
+void EICPIDParticlev2::identify(ostream& os) const
+{
+  unsigned int nLogLikelyhood = 0;
+  unsigned int nProperty = 0;
+  for (int i = 0; i < nProperties; i++)
+  {
+    if (m_prop_mask & (1U << i)) nProperty++;
+  }
+  for (int icand = 0; icand < EICPIDDefs::nPIDCandidates; icand++)
+  {
+    for (int idet = 0; idet < EICPIDDefs::nPIDDetectors; idet++)
+    {
+      if (m_LogLikelyhoodMask[icand] & (1U << idet)) nLogLikelyhood++;
+    }
+  }
+  os << "Class " << this->ClassName();
+  os << " id: " << m_id
+     << ", number of LogLikelyhoods = " << nLogLikelyhood
+     << ", number of properties = " << nProperty
+     << endl;
+  for (int icand = 0; icand < EICPIDDefs::nPIDCandidates; icand++)
+  {
+    for (int idet = 0; idet < EICPIDDefs::nPIDDetectors; idet++)
+    {
+      if (!(m_LogLikelyhoodMask[icand] & (1U << idet))) continue;
+
+      os << "\t"
+         << "PID Candidate " << EICPIDDefs::PIDCandidates[icand] << " from detector ID " << EICPIDDefs::PIDDetectors[idet]
+         << " " << EICPIDDefs::getPIDDetectorName(EICPIDDefs::PIDDetectors[idet]);
+      os << " :\t LogLikelyhood = " << m_LogLikelyhood[icand][idet] << endl;
+    }
+  }
+  for (const auto& info : m_propertyInfo)
+  {
+    const PROPERTY prop_id = info.first;
+    if (find_property(prop_id) < 0) continue;
+
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    os << "\t" << prop_id << ":\t" << property_info.first << " = \t";
+    switch (property_info.second)
+    {
+    case type_int:
+      os << get_property_int(prop_id);
+      break;
+    case type_uint:
+      os << get_property_uint(prop_id);
+      break;
+    case type_float:
+      os << get_property_float(prop_id);
+      break;
+    default:
+      os << " unknown type ";
+    }
+    os << endl;
+  }
+}
+
+float EICPIDParticlev2::get_SumLogLikelyhood(EICPIDDefs::PIDCandidate pid) const
+{
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  if (icand < 0) return 0;
+
+  return m_SumLogLikelyhood[icand];
+}
+
+float EICPIDParticlev2::get_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const
+{
+  if (det == EICPIDDefs::PIDAll) return get_SumLogLikelyhood(pid);
+
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  const int idet = EICPIDDefs::getPIDDetectorIndex(det);
+  if (icand < 0 || idet < 0 || !(m_LogLikelyhoodMask[icand] & (1U << idet)))
+    return m_minLogLikelihood;
+  else
+    return m_LogLikelyhood[icand][idet];
+}
+
+void EICPIDParticlev2::set_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det, float LogLikelyhood)
+{
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  const int idet = EICPIDDefs::getPIDDetectorIndex(det);
+  if (icand < 0 || idet < 0)
+  {
+    cout << PHWHERE << " PID Candidate " << pid << " from detector ID " << det
+         << " does not fit into the likelihood matrix, ignored" << endl;
+    return;
+  }
+
+  m_LogLikelyhood[icand][idet] = LogLikelyhood;
+  m_LogLikelyhoodMask[icand] |= (1U << idet);
+
+  // sum in detector order like the map of EICPIDParticlev1, overwriting a value does not accumulate rounding errors
+  float LL = 0;
+  for (int i = 0; i < EICPIDDefs::nPIDDetectors; i++)
+  {
+    if (m_LogLikelyhoodMask[icand] & (1U << i)) LL += m_LogLikelyhood[icand][i];
+  }
+  m_SumLogLikelyhood[icand] = LL;
+}
+
+bool EICPIDParticlev2::has_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const
+{
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  const int idet = EICPIDDefs::getPIDDetectorIndex(det);
+  if (icand < 0 || idet < 0) return false;
+
+  return m_LogLikelyhoodMask[icand] & (1U << idet);
+}
+
+bool EICPIDParticlev2::has_property(const PROPERTY prop_id) const
+{
+  return find_property(prop_id) >= 0;
+}
+
+float EICPIDParticlev2::get_property_float(const PROPERTY prop_id) const
+{
+  if (!check_property(prop_id, type_float))
+  {
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    cout << PHWHERE << " Property " << property_info.first << " with id "
+         << prop_id << " is of type " << get_property_type(property_info.second)
+         << " not " << get_property_type(type_float) << endl;
+    exit(1);
+  }
+  const int i = find_property(prop_id);
+
+  if (i >= 0) return u_property(m_prop_data[i]).fdata;
+
+  return NAN;
+}
+
+int EICPIDParticlev2::get_property_int(const PROPERTY prop_id) const
+{
+  if (!check_property(prop_id, type_int))
+  {
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    cout << PHWHERE << " Property " << property_info.first << " with id "
+         << prop_id << " is of type " << get_property_type(property_info.second)
+         << " not " << get_property_type(type_int) << endl;
+    exit(1);
+  }
+  const int i = find_property(prop_id);
+
+  if (i >= 0) return u_property(m_prop_data[i]).idata;
+
+  return INT_MIN;
+}
+
+unsigned int
+EICPIDParticlev2::get_property_uint(const PROPERTY prop_id) const
+{
+  if (!check_property(prop_id, type_uint))
+  {
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    cout << PHWHERE << " Property " << property_info.first << " with id "
+         << prop_id << " is of type " << get_property_type(property_info.second)
+         << " not " << get_property_type(type_uint) << endl;
+    exit(1);
+  }
+  const int i = find_property(prop_id);
+
+  if (i >= 0) return u_property(m_prop_data[i]).uidata;
+
+  return UINT_MAX;
+}
+
+void EICPIDParticlev2::set_property(const PROPERTY prop_id, const float value)
+{
+  if (!check_property(prop_id, type_float))
+  {
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    cout << PHWHERE << " Property " << property_info.first << " with id "
+         << prop_id << " is of type " << get_property_type(property_info.second)
+         << " not " << get_property_type(type_float) << endl;
+    exit(1);
+  }
+  store_property(prop_id, u_property(value).get_storage());
+}
+
+void EICPIDParticlev2::set_property(const PROPERTY prop_id, const int value)
+{
+  if (!check_property(prop_id, type_int))
+  {
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    cout << PHWHERE << " Property " << property_info.first << " with id "
+         << prop_id << " is of type " << get_property_type(property_info.second)
+         << " not " << get_property_type(type_int) << endl;
+    exit(1);
+  }
+  store_property(prop_id, u_property(value).get_storage());
+}
+
+void EICPIDParticlev2::set_property(const PROPERTY prop_id, const unsigned int value)
+{
+  if (!check_property(prop_id, type_uint))
+  {
+    pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+    cout << PHWHERE << " Property " << property_info.first << " with id "
+         << prop_id << " is of type " << get_property_type(property_info.second)
+         << " not " << get_property_type(type_uint) << endl;
+    exit(1);
+  }
+  store_property(prop_id, u_property(value).get_storage());
+}
+
+unsigned int
+EICPIDParticlev2::get_property_nocheck(const PROPERTY prop_id) const
+{
+  const int i = find_property(prop_id);
+  if (i >= 0)
+  {
+    return m_prop_data[i];
+  }
+  return UINT_MAX;
+}
+
+int EICPIDParticlev2::find_property(const PROPERTY prop_id) const
+{
+  const int i = get_property_index(prop_id);
+  if (i < 0 || !(m_prop_mask & (1U << i))) return -1;
+
+  return i;
+}
+
+void EICPIDParticlev2::store_property(const prop_id_t prop_id, const prop_storage_t data)
+{
+  const int i = get_property_index(static_cast<PROPERTY>(prop_id));
+  if (i < 0)
+  {
+    cout << PHWHERE << " Property id " << (int) prop_id << " has no storage index, ignored" << endl;
+    return;
+  }
+  m_prop_data[i] = data;
+  m_prop_mask |= (1U << i);
+}
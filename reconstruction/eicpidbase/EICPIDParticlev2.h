@@ -0,0 +1,103 @@
+// TeLogLikelyhood emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef EICPID_EICPIDParticleV2_H
+#define EICPID_EICPIDParticleV2_H
+
+#include <climits>  // for INT_MIN, ULONG_LONG_MAX
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include "EICPIDDefs.h"
+#include "EICPIDParticle.h"
+
+//! PID particle with the log likelihoods in a fixed candidate x detector matrix
+//! with a presence mask, the per candidate sums are updated in set_LogLikelyhood.
+//! The properties are kept in a fixed array indexed by get_property_index with a presence mask
+//! instead of a std::map
+class EICPIDParticlev2 : public EICPIDParticle
+{
+ public:
+  EICPIDParticlev2() = default;
+  explicit EICPIDParticlev2(const EICPIDParticle* g4hit);
+  ~EICPIDParticlev2() override = default;
+  void identify(std::ostream& os = std::cout) const override;
+  void Reset() override;
+
+  EICPIDDefs::keytype get_id() const override { return m_id; }
+  void set_id(const EICPIDDefs::keytype i) override { m_id = i; }
+
+  float get_SumLogLikelyhood(EICPIDDefs::PIDCandidate pid) const override;
+  float get_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const override;
+  void set_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det, float LogLikelyhood) override;
+  bool has_LogLikelyhood(EICPIDDefs::PIDCandidate pid, EICPIDDefs::PIDDetector det) const override;
+
+  bool has_property(const PROPERTY prop_id) const override;
+  float get_property_float(const PROPERTY prop_id) const override;
+  int get_property_int(const PROPERTY prop_id) const override;
+  unsigned int get_property_uint(const PROPERTY prop_id) const override;
+  void set_property(const PROPERTY prop_id, const float value) override;
+  void set_property(const PROPERTY prop_id, const int value) override;
+  void set_property(const PROPERTY prop_id, const unsigned int value) override;
+
+ protected:
+  unsigned int get_property_nocheck(const PROPERTY prop_id) const override;
+  void set_property_nocheck(const PROPERTY prop_id, const unsigned int ui) override { store_property(prop_id, ui); }
+
+  EICPIDDefs::keytype m_id = -1;
+
+  //! storage types for additional property
+  typedef uint8_t prop_id_t;
+  typedef uint32_t prop_storage_t;
+
+  //! convert between 32bit inputs and storage type prop_storage_t
+  union u_property
+  {
+    float fdata;
+    int32_t idata;
+    uint32_t uidata;
+
+    u_property(int32_t in)
+      : idata(in)
+    {
+    }
+    u_property(uint32_t in)
+      : uidata(in)
+    {
+    }
+    u_property(float in)
+      : fdata(in)
+    {
+    }
+    u_property()
+      : uidata(0)
+    {
+    }
+
+    prop_storage_t get_storage() const { return uidata; }
+  };
+
+  //! dense index of a property that is set, -1 if it is not set
+  int find_property(const PROPERTY prop_id) const;
+  //! set or overwrite a property, ids without a dense index are ignored
+  void store_property(const prop_id_t prop_id, const prop_storage_t data);
+
+  //! values of the additional properties, see get_property_index
+  prop_storage_t m_prop_data[nProperties] = {};
+  //! one bit per property index for the properties that are set
+  uint8_t m_prop_mask = 0;
+
+  //! log likelihoods per (candidate, detector) index, see EICPIDDefs::getPIDCandidateIndex and getPIDDetectorIndex
+  float m_LogLikelyhood[EICPIDDefs::nPIDCandidates][EICPIDDefs::nPIDDetectors] = {};
+  //! one bit per detector index for the log likelihoods that are set
+  uint8_t m_LogLikelyhoodMask[EICPIDDefs::nPIDCandidates] = {};
+  //! sum of the log likelihoods that are set, per candidate index
+  float m_SumLogLikelyhood[EICPIDDefs::nPIDCandidates] = {};
+
+  static_assert(EICPIDDefs::nPIDDetectors <= 8, "presence mask of EICPIDParticlev2 has 8 bits");
+  static_assert(nProperties <= 8, "property mask of EICPIDParticlev2 has 8 bits");
+
+  ClassDefOverride(EICPIDParticlev2, 1)
+};
+
+#endif
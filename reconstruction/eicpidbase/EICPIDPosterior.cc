@@ -0,0 +1,246 @@
+#include "EICPIDPosterior.h"
+
+#include "EICPIDParticle.h"
+#include "EICPIDParticleContainer.h"
+#include "EICPIDPosteriorContainer.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/SubsysReco.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+#include <phool/phool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+EICPIDPosterior::EICPIDPosterior(const std::string &name)
+  : SubsysReco(name)
+  , m_InputNodeName("EICPIDParticleMap")
+  , m_OutputNodeName("EICPIDPosteriorMap")
+  , m_PIDParticles(nullptr)
+  , m_Posteriors(nullptr)
+{
+  fill(m_Prior, m_Prior + EICPIDDefs::nPIDCandidates, 1.);
+  fill(m_UseDetector, m_UseDetector + EICPIDDefs::nPIDDetectors, true);
+}
+
+void EICPIDPosterior::set_prior(EICPIDDefs::PIDCandidate pid, float prior)
+{
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  if (icand < 0 || prior < 0)
+  {
+    cout << PHWHERE << " invalid prior " << prior << " for PID Candidate " << pid << ", ignored" << endl;
+    return;
+  }
+  m_Prior[icand] = prior;
+}
+
+void EICPIDPosterior::set_use_detector(EICPIDDefs::PIDDetector det, bool use)
+{
+  const int idet = EICPIDDefs::getPIDDetectorIndex(det);
+  if (idet < 0)
+  {
+    cout << PHWHERE << " invalid detector ID " << det << ", ignored" << endl;
+    return;
+  }
+  m_UseDetector[idet] = use;
+}
+
+int EICPIDPosterior::InitRun(PHCompositeNode *topNode)
+{
+  m_PIDParticles = findNode::getClass<EICPIDParticleContainer>(topNode, m_InputNodeName);
+  if (!m_PIDParticles)
+  {
+    cout << Name() << "::" << __PRETTY_FUNCTION__
+         << " " << m_InputNodeName << " Node missing, doing bail out!" << endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  try
+  {
+    CreateNodes(topNode);
+  }
+  catch (std::exception &e)
+  {
+    cout << e.what() << endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  if (Verbosity())
+  {
+    cout << Name() << "::" << __PRETTY_FUNCTION__ << " priors:";
+    for (int icand = 0; icand < EICPIDDefs::nPIDCandidates; icand++)
+    {
+      cout << " " << EICPIDDefs::PIDCandidates[icand] << " = " << m_Prior[icand];
+    }
+    cout << ", detectors:";
+    for (int idet = 0; idet < EICPIDDefs::nPIDDetectors; idet++)
+    {
+      if (m_UseDetector[idet]) cout << " " << EICPIDDefs::getPIDDetectorName(EICPIDDefs::PIDDetectors[idet]);
+    }
+    cout << endl;
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int EICPIDPosterior::process_event(PHCompositeNode * /*topNode*/)
+{
+  const unsigned int ntracks = m_PIDParticles->size();
+  const int ncand = EICPIDDefs::nPIDCandidates;
+  const int ndet = EICPIDDefs::nPIDDetectors;
+
+  m_Posteriors->Reset();
+  m_Posteriors->resize(ntracks);
+  if (ntracks == 0)
+  {
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+
+  // pack the likelihoods of the used detectors, the particle map iterates in key order
+  m_LogLikelyhood.assign(ncand * ndet * ntracks, 0);
+  m_nDetectors.assign(ntracks, 0);
+  vector<EICPIDDefs::keytype> &ids = m_Posteriors->get_ids();
+  unsigned int i = 0;
+  EICPIDParticleContainer::ConstRange range = m_PIDParticles->getPIDParticles();
+  for (EICPIDParticleContainer::ConstIterator iter = range.first; iter != range.second; ++iter, ++i)
+  {
+    const EICPIDParticle *particle = iter->second;
+    ids[i] = iter->first;
+    for (int idet = 0; idet < ndet; idet++)
+    {
+      if (!m_UseDetector[idet]) continue;
+
+      bool evaluated[EICPIDDefs::nPIDCandidates];
+      bool found = false;
+      for (int icand = 0; icand < ncand; icand++)
+      {
+        evaluated[icand] = particle->has_LogLikelyhood(EICPIDDefs::PIDCandidates[icand], EICPIDDefs::PIDDetectors[idet]);
+        found = found || evaluated[icand];
+      }
+      // a detector without any likelihood for this track does not contribute, one that evaluated
+      // only some candidates gives the others its floor instead of the best possible 0
+      if (!found) continue;
+      m_nDetectors[i]++;
+      for (int icand = 0; icand < ncand; icand++)
+      {
+        m_LogLikelyhood[(icand * ndet + idet) * ntracks + i] = evaluated[icand]
+                                                                   ? particle->get_LogLikelyhood(EICPIDDefs::PIDCandidates[icand], EICPIDDefs::PIDDetectors[idet])
+                                                                   : EICPIDParticle::m_minLogLikelihood;
+      }
+    }
+  }
+
+  // combined log likelihoods, sum over the detectors for all tracks at once
+  float *combined = m_Posteriors->get_CombinedLogLikelyhoods().data();
+  const float *loglikelyhood = m_LogLikelyhood.data();
+  fill(combined, combined + ncand * ntracks, 0.f);
+  for (int icand = 0; icand < ncand; icand++)
+  {
+    float *comb = combined + icand * ntracks;
+    for (int idet = 0; idet < ndet; idet++)
+    {
+      if (!m_UseDetector[idet]) continue;
+
+      const float *ll = loglikelyhood + (icand * ndet + idet) * ntracks;
+      for (unsigned int t = 0; t < ntracks; t++)
+      {
+        comb[t] += ll[t];
+      }
+    }
+  }
+
+  // posteriors P(c) = prior(c) exp(LL(c) - max LL) / sum, subtracting the maximum keeps exp in range
+  float *posterior = m_Posteriors->get_Posteriors().data();
+  m_Norm.assign(ntracks, -INFINITY);
+  float *norm = m_Norm.data();
+  for (int icand = 0; icand < ncand; icand++)
+  {
+    const float *comb = combined + icand * ntracks;
+    for (unsigned int t = 0; t < ntracks; t++)
+    {
+      norm[t] = max(norm[t], comb[t]);
+    }
+  }
+  for (int icand = 0; icand < ncand; icand++)
+  {
+    const float *comb = combined + icand * ntracks;
+    float *post = posterior + icand * ntracks;
+    const float prior = m_Prior[icand];
+    for (unsigned int t = 0; t < ntracks; t++)
+    {
+      post[t] = prior * exp(comb[t] - norm[t]);
+    }
+  }
+  fill(norm, norm + ntracks, 0.f);
+  for (int icand = 0; icand < ncand; icand++)
+  {
+    const float *post = posterior + icand * ntracks;
+    for (unsigned int t = 0; t < ntracks; t++)
+    {
+      norm[t] += post[t];
+    }
+  }
+  for (int icand = 0; icand < ncand; icand++)
+  {
+    float *post = posterior + icand * ntracks;
+    for (unsigned int t = 0; t < ntracks; t++)
+    {
+      post[t] = (norm[t] > 0) ? post[t] / norm[t] : 0;
+    }
+  }
+
+  // best candidate, the first one of equal posteriors
+  int *best = m_Posteriors->get_BestCandidates().data();
+  fill(norm, norm + ntracks, -1.f);
+  for (int icand = 0; icand < ncand; icand++)
+  {
+    const float *post = posterior + icand * ntracks;
+    const int candidate = EICPIDDefs::PIDCandidates[icand];
+    for (unsigned int t = 0; t < ntracks; t++)
+    {
+      const bool better = post[t] > norm[t];
+      norm[t] = better ? post[t] : norm[t];
+      best[t] = better ? candidate : best[t];
+    }
+  }
+  // no likelihood from any used detector, the posteriors are the priors
+  for (unsigned int t = 0; t < ntracks; t++)
+  {
+    if (m_nDetectors[t] == 0) best[t] = EICPIDDefs::InvalidCandiate;
+  }
+
+  if (Verbosity() > 1)
+  {
+    m_Posteriors->identify();
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+void EICPIDPosterior::CreateNodes(PHCompositeNode *topNode)
+{
+  PHNodeIterator iter(topNode);
+  PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
+  if (!dstNode)
+  {
+    cout << Name() << "::" << __PRETTY_FUNCTION__
+         << "DST Node missing, doing nothing." << endl;
+    throw std::runtime_error("Failed to find DST node in EICPIDPosterior::CreateNodes");
+  }
+
+  m_Posteriors = findNode::getClass<EICPIDPosteriorContainer>(dstNode, m_OutputNodeName);
+  if (!m_Posteriors)
+  {
+    m_Posteriors = new EICPIDPosteriorContainer();
+    PHIODataNode<PHObject> *posteriorNode = new PHIODataNode<PHObject>(m_Posteriors, m_OutputNodeName, "PHObject");
+    dstNode->addNode(posteriorNode);
+  }
+}
@@ -0,0 +1,63 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef EICPID_EICPIDPosterior_H
+#define EICPID_EICPIDPosterior_H
+
+#include <fun4all/SubsysReco.h>
+
+#include <string>
+#include <vector>
+
+#include "EICPIDDefs.h"
+
+class EICPIDParticleContainer;
+class EICPIDPosteriorContainer;
+class PHCompositeNode;
+
+//! combine the PID log likelihoods of all tracks of an event into posterior probabilities
+//! default input DST node is EICPIDParticleMap
+//! default output DST node is EICPIDPosteriorMap (EICPIDPosteriorContainer)
+//!
+//! The likelihoods of all tracks are packed once per event into candidate and detector
+//! major arrays, so the sums over detectors, the posteriors and the best candidates are
+//! computed in loops over all tracks instead of per track lookups
+class EICPIDPosterior : public SubsysReco
+{
+ public:
+  EICPIDPosterior(const std::string &name = "EICPIDPosterior");
+  ~EICPIDPosterior() override {}
+
+  int InitRun(PHCompositeNode *topNode) override;
+  int process_event(PHCompositeNode *topNode) override;
+
+  //! prior probability of a candidate, the priors do not need to be normalized. Default is 1 for all candidates
+  void set_prior(EICPIDDefs::PIDCandidate pid, float prior);
+  //! include the likelihoods of a detector in the combination, all detectors are used by default
+  void set_use_detector(EICPIDDefs::PIDDetector det, bool use);
+
+  void set_input_node(const std::string &name) { m_InputNodeName = name; }
+  void set_output_node(const std::string &name) { m_OutputNodeName = name; }
+
+ protected:
+  void CreateNodes(PHCompositeNode *topNode);
+
+  std::string m_InputNodeName;
+  std::string m_OutputNodeName;
+
+  float m_Prior[EICPIDDefs::nPIDCandidates];
+  bool m_UseDetector[EICPIDDefs::nPIDDetectors];
+
+  EICPIDParticleContainer *m_PIDParticles;
+  EICPIDPosteriorContainer *m_Posteriors;
+
+  //! packed log likelihoods of the event, element (icand * nPIDDetectors + idet) * ntracks + i.
+  //! 0 for all candidates of a detector without likelihoods for the track, the floor
+  //! EICPIDParticle::m_minLogLikelihood for the candidates a detector did not evaluate
+  std::vector<float> m_LogLikelyhood;
+  //! number of used detectors with a likelihood per track
+  std::vector<int> m_nDetectors;
+  //! work array for the normalization of the posteriors
+  std::vector<float> m_Norm;
+};
+
+#endif
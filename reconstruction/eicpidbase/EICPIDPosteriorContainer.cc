@@ -0,0 +1,67 @@
+#include "EICPIDPosteriorContainer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void EICPIDPosteriorContainer::Reset()
+{
+  m_id.clear();
+  m_CombinedLogLikelyhood.clear();
+  m_Posterior.clear();
+  m_BestCandidate.clear();
+}
+
+int EICPIDPosteriorContainer::isValid() const
+{
+  return size() > 0;
+}
+
+void EICPIDPosteriorContainer::identify(ostream& os) const
+{
+  os << "Number of PID posteriors: " << size() << endl;
+  for (unsigned int i = 0; i < size(); i++)
+  {
+    os << "PIDParticles ID " << m_id[i] << ": best candidate " << m_BestCandidate[i];
+    for (int icand = 0; icand < EICPIDDefs::nPIDCandidates; icand++)
+    {
+      os << ", P(" << EICPIDDefs::PIDCandidates[icand] << ") = " << m_Posterior[icand * size() + i];
+    }
+    os << endl;
+  }
+}
+
+int EICPIDPosteriorContainer::find(EICPIDDefs::keytype key) const
+{
+  vector<EICPIDDefs::keytype>::const_iterator it = lower_bound(m_id.begin(), m_id.end(), key);
+  if (it == m_id.end() || *it != key)
+  {
+    return -1;
+  }
+  return it - m_id.begin();
+}
+
+float EICPIDPosteriorContainer::get_CombinedLogLikelyhood(unsigned int i, EICPIDDefs::PIDCandidate pid) const
+{
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  if (icand < 0 || i >= size()) return NAN;
+
+  return m_CombinedLogLikelyhood[icand * size() + i];
+}
+
+float EICPIDPosteriorContainer::get_Posterior(unsigned int i, EICPIDDefs::PIDCandidate pid) const
+{
+  const int icand = EICPIDDefs::getPIDCandidateIndex(pid);
+  if (icand < 0 || i >= size()) return NAN;
+
+  return m_Posterior[icand * size() + i];
+}
+
+void EICPIDPosteriorContainer::resize(unsigned int ntracks)
+{
+  m_id.resize(ntracks);
+  m_CombinedLogLikelyhood.resize(ntracks * EICPIDDefs::nPIDCandidates);
+  m_Posterior.resize(ntracks * EICPIDDefs::nPIDCandidates);
+  m_BestCandidate.resize(ntracks);
+}
@@ -0,0 +1,56 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef EICPID_EICPIDPosteriorCONTAINER_H
+#define EICPID_EICPIDPosteriorCONTAINER_H
+
+#include <phool/PHObject.h>
+
+#include <iostream>
+#include <vector>
+
+#include "EICPIDDefs.h"
+
+//! combined log likelihoods, posterior probabilities and best PID candidate of all
+//! PID particles of an event, filled by EICPIDPosterior. The per candidate arrays
+//! are candidate major, element icand * size() + i for track i and candidate index
+//! icand (EICPIDDefs::getPIDCandidateIndex)
+class EICPIDPosteriorContainer : public PHObject
+{
+ public:
+  EICPIDPosteriorContainer() {}
+  ~EICPIDPosteriorContainer() override {}
+
+  void Reset() override;
+  int isValid() const override;
+  void identify(std::ostream& os = std::cout) const override;
+
+  //! number of tracks
+  unsigned int size() const { return m_id.size(); }
+  //! index of the track with this key, -1 if there is none
+  int find(EICPIDDefs::keytype key) const;
+
+  EICPIDDefs::keytype get_id(unsigned int i) const { return m_id[i]; }
+  float get_CombinedLogLikelyhood(unsigned int i, EICPIDDefs::PIDCandidate pid) const;
+  float get_Posterior(unsigned int i, EICPIDDefs::PIDCandidate pid) const;
+  //! InvalidCandiate if no detector provided a likelihood for the track
+  EICPIDDefs::PIDCandidate get_BestCandidate(unsigned int i) const { return static_cast<EICPIDDefs::PIDCandidate>(m_BestCandidate[i]); }
+
+  //! resize all arrays for ntracks tracks
+  void resize(unsigned int ntracks);
+
+  //! direct access to the arrays, the track keys are sorted
+  std::vector<EICPIDDefs::keytype>& get_ids() { return m_id; }
+  std::vector<float>& get_CombinedLogLikelyhoods() { return m_CombinedLogLikelyhood; }
+  std::vector<float>& get_Posteriors() { return m_Posterior; }
+  std::vector<int>& get_BestCandidates() { return m_BestCandidate; }
+
+ protected:
+  std::vector<EICPIDDefs::keytype> m_id;
+  std::vector<float> m_CombinedLogLikelyhood;
+  std::vector<float> m_Posterior;
+  std::vector<int> m_BestCandidate;
+
+  ClassDefOverride(EICPIDPosteriorContainer, 1)
+};
+
+#endif
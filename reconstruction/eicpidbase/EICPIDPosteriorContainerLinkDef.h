@@ -0,0 +1,5 @@
+#ifdef __CINT__
+
+#pragma link C++ class EICPIDPosteriorContainer + ;
+
+#endif /* __CINT__ */
@@ -0,0 +1,96 @@
+// Checks of EICPIDPosterior on a small node tree, run by make check.
+//
+// usage: testeicpidposterior
+
+#include "EICPIDDefs.h"
+#include "EICPIDParticlev2.h"
+#include "EICPIDParticleContainer.h"
+#include "EICPIDPosterior.h"
+#include "EICPIDPosteriorContainer.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+
+#include <iostream>
+#include <string>
+
+namespace
+{
+  int nfailed = 0;
+
+  void check(const bool ok, const std::string &what)
+  {
+    if (!ok)
+    {
+      std::cout << "FAILED: " << what << std::endl;
+      nfailed++;
+    }
+  }
+
+  EICPIDParticle *makeParticle(const EICPIDDefs::keytype id)
+  {
+    EICPIDParticle *particle = new EICPIDParticlev2();
+    particle->set_id(id);
+    return particle;
+  }
+}  // namespace
+
+int main()
+{
+  PHCompositeNode *topNode = new PHCompositeNode("TOP");
+  PHCompositeNode *dstNode = new PHCompositeNode("DST");
+  topNode->addNode(dstNode);
+  EICPIDParticleContainer *particles = new EICPIDParticleContainer();
+  dstNode->addNode(new PHIODataNode<PHObject>(particles, "EICPIDParticleMap", "PHObject"));
+
+  // track 0: the mRICH reports only pion and kaon, the other candidates were not evaluated
+  EICPIDParticle *partial = makeParticle(0);
+  partial->set_LogLikelyhood(EICPIDDefs::PionCandiate, EICPIDDefs::mRICH, -1);
+  partial->set_LogLikelyhood(EICPIDDefs::KaonCandiate, EICPIDDefs::mRICH, -5);
+  particles->AddPIDParticle(partial);
+
+  // track 1: the mRICH reports only pion and kaon, the DIRC all candidates and prefers the kaon
+  EICPIDParticle *combined = makeParticle(1);
+  combined->set_LogLikelyhood(EICPIDDefs::PionCandiate, EICPIDDefs::mRICH, -4);
+  combined->set_LogLikelyhood(EICPIDDefs::KaonCandiate, EICPIDDefs::mRICH, -2);
+  for (int icand = 0; icand < EICPIDDefs::nPIDCandidates; icand++)
+  {
+    const EICPIDDefs::PIDCandidate pid = EICPIDDefs::PIDCandidates[icand];
+    combined->set_LogLikelyhood(pid, EICPIDDefs::DIRC, (pid == EICPIDDefs::KaonCandiate) ? -1 : -3);
+  }
+  particles->AddPIDParticle(combined);
+
+  // track 2: no likelihoods at all
+  particles->AddPIDParticle(makeParticle(2));
+
+  EICPIDPosterior posterior;
+  check(posterior.InitRun(topNode) == Fun4AllReturnCodes::EVENT_OK, "InitRun");
+  check(posterior.process_event(topNode) == Fun4AllReturnCodes::EVENT_OK, "process_event");
+  EICPIDPosteriorContainer *posteriors = findNode::getClass<EICPIDPosteriorContainer>(topNode, "EICPIDPosteriorMap");
+  check(posteriors && posteriors->size() == 3, "one posterior per track");
+  if (nfailed)
+  {
+    return 1;
+  }
+
+  check(posteriors->get_BestCandidate(0) == EICPIDDefs::PionCandiate, "partial detector: pion is best");
+  check(posteriors->get_CombinedLogLikelyhood(0, EICPIDDefs::ProtonCandiate) == EICPIDParticle::m_minLogLikelihood,
+        "partial detector: proton gets the floor");
+  check(posteriors->get_Posterior(0, EICPIDDefs::ProtonCandiate) < posteriors->get_Posterior(0, EICPIDDefs::KaonCandiate),
+        "partial detector: proton less likely than kaon");
+  check(posteriors->get_BestCandidate(1) == EICPIDDefs::KaonCandiate, "partial and full detector: kaon is best");
+  check(posteriors->get_CombinedLogLikelyhood(1, EICPIDDefs::ElectronCandiate) == EICPIDParticle::m_minLogLikelihood - 3,
+        "partial and full detector: electron sums the floor and the DIRC");
+  check(posteriors->get_BestCandidate(2) == EICPIDDefs::InvalidCandiate, "no likelihoods: no best candidate");
+
+  if (nfailed == 0)
+  {
+    std::cout << "testeicpidposterior: all checks passed" << std::endl;
+  }
+  delete topNode;
+  return nfailed ? 1 : 0;
+}
@@ -2,30 +2,76 @@
 
 #include "RawTowerZDC.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 
 using namespace std;
 
+RawTowerZDCContainer::Iterator::Iterator(const RawTowerZDCContainer *container, unsigned int index)
+  : _container(container)
+  , _index(index)
+  , _value(0, nullptr)
+{
+  if (_index < _container->_slot.size())
+  {
+    RawTowerZDC *tower = _container->_tower_list[_container->_slot[_index]];
+    _value = make_pair(tower->get_id(), tower);
+  }
+}
+
+RawTowerZDCContainer::Iterator &
+RawTowerZDCContainer::Iterator::operator++()
+{
+  *this = Iterator(_container, _container->nextOccupied(_index + 1));
+  return *this;
+}
+
+RawTowerZDCContainer::Iterator
+RawTowerZDCContainer::Iterator::operator++(int)
+{
+  Iterator tmp(*this);
+  ++(*this);
+  return tmp;
+}
+
 void RawTowerZDCContainer::compress(const double emin)
 {
-  if (emin <= 0)  // no need to loop through the map if we don't apply a cut
+  if (emin <= 0)  // no need to loop through the towers if we don't apply a cut
   {
     return;
   }
-  Iterator itr = _towers.begin();
-  Iterator last = _towers.end();
-  for (; itr != last;)
+  if (!_indexed)
+  {
+    buildIndex(_n1, _n2, _n3);
+  }
+  unsigned int pos = 0;
+  while (pos < _tower_list.size())
   {
-    RawTowerZDC *tower = (itr->second);
+    RawTowerZDC *tower = _tower_list[pos];
     if (tower->get_energy() < emin)
     {
+      int index = denseIndex(tower->get_id());
+      if (index >= 0)
+      {
+        clearSlot(index);
+      }
       delete tower;
-      _towers.erase(itr++);
+      // fill the gap with the last tower
+      _tower_list[pos] = _tower_list.back();
+      _tower_list.pop_back();
+      if (pos < _tower_list.size())
+      {
+        index = denseIndex(_tower_list[pos]->get_id());
+        if (index >= 0)
+        {
+          setSlot(index, pos);
+        }
+      }
     }
     else
     {
-      ++itr;
+      ++pos;
     }
   }
 }
@@ -33,23 +79,33 @@ void RawTowerZDCContainer::compress(const double emin)
 RawTowerZDCContainer::ConstRange
 RawTowerZDCContainer::getTowers(void) const
 {
-  return make_pair(_towers.begin(), _towers.end());
+  if (!_indexed)
+  {
+    buildIndex(_n1, _n2, _n3);
+  }
+  return make_pair(ConstIterator(this, nextOccupied(0)), ConstIterator(this, _slot.size()));
 }
 
 RawTowerZDCContainer::Range
 RawTowerZDCContainer::getTowers(void)
 {
-  return make_pair(_towers.begin(), _towers.end());
+  if (!_indexed)
+  {
+    buildIndex(_n1, _n2, _n3);
+  }
+  return make_pair(Iterator(this, nextOccupied(0)), Iterator(this, _slot.size()));
+}
+
+void RawTowerZDCContainer::setIndexRange(const unsigned int n1, const unsigned int n2, const unsigned int n3)
+{
+  buildIndex(max(_n1, n1), max(_n2, n2), max(_n3, n3));
 }
 
 RawTowerZDCContainer::ConstIterator
 RawTowerZDCContainer::AddTower(const unsigned int ieta, const int unsigned iphi, const int unsigned il, RawTowerZDC *rawtower)
 {
   RawTowerZDCDefs::keytype key = RawTowerZDCDefs::encode_towerid_zdc(_caloid, ieta, iphi, il);
-  _towers[key] = rawtower;
-  rawtower->set_id(key);  // force tower key to be synced to container key
-
-  return _towers.find(key);
+  return AddTower(key, rawtower);
 }
 
 RawTowerZDCContainer::ConstIterator
@@ -61,20 +117,45 @@ RawTowerZDCContainer::AddTower(RawTowerZDCDefs::keytype key, RawTowerZDC *twr)
          << _caloid << ", requested CaloID = " << RawTowerZDCDefs::decode_caloid(key) << " based on key " << key << endl;
     exit(2);
   }
+  if (!_indexed)
+  {
+    buildIndex(_n1, _n2, _n3);
+  }
+
+  int index = denseIndex(key);
+  if (index < 0)
+  {
+    // outside of the index space, grow it by at least half of its size to keep the rebuilds rare
+    const unsigned int i1 = RawTowerZDCDefs::decode_index1zdc(key);
+    const unsigned int i2 = RawTowerZDCDefs::decode_index2zdc(key);
+    const unsigned int i3 = RawTowerZDCDefs::decode_index3zdc(key);
+    buildIndex((i1 < _n1) ? _n1 : min(max(i1 + 1, _n1 + _n1 / 2), RawTowerZDCDefs::maxbitsIndex1),
+               (i2 < _n2) ? _n2 : min(max(i2 + 1, _n2 + _n2 / 2), RawTowerZDCDefs::maxbitsIndex2),
+               (i3 < _n3) ? _n3 : min(max(i3 + 1, _n3 + _n3 / 2), RawTowerZDCDefs::maxbitsIndex3));
+    index = denseIndex(key);
+  }
 
-  _towers[key] = twr;
   twr->set_id(key);  // force tower key to be synced to container key
+  if (_slot[index] >= 0)
+  {
+    _tower_list[_slot[index]] = twr;
+  }
+  else
+  {
+    setSlot(index, _tower_list.size());
+    _tower_list.push_back(twr);
+  }
 
-  return _towers.find(key);
+  return ConstIterator(this, index);
 }
 
 RawTowerZDC *
 RawTowerZDCContainer::getTower(RawTowerZDCDefs::keytype key)
 {
-  ConstIterator it = _towers.find(key);
-  if (it != _towers.end())
+  int pos = findTower(key);
+  if (pos >= 0)
   {
-    return it->second;
+    return _tower_list[pos];
   }
   return NULL;
 }
@@ -82,10 +163,10 @@ RawTowerZDCContainer::getTower(RawTowerZDCDefs::keytype key)
 const RawTowerZDC *
 RawTowerZDCContainer::getTower(RawTowerZDCDefs::keytype key) const
 {
-  ConstIterator it = _towers.find(key);
-  if (it != _towers.end())
+  int pos = findTower(key);
+  if (pos >= 0)
   {
-    return it->second;
+    return _tower_list[pos];
   }
   return NULL;
 }
@@ -107,31 +188,131 @@ RawTowerZDCContainer::getTower(const unsigned int ieta, const unsigned int iphi,
 
 int RawTowerZDCContainer::isValid() const
 {
-  return (!_towers.empty());
+  return (!_tower_list.empty());
 }
 
 void RawTowerZDCContainer::Reset()
 {
-  while (_towers.begin() != _towers.end())
+  for (auto tower : _tower_list)
   {
-    delete _towers.begin()->second;
-    _towers.erase(_towers.begin());
+    if (_indexed)
+    {
+      int index = denseIndex(tower->get_id());
+      if (index >= 0)
+      {
+        clearSlot(index);
+      }
+    }
+    delete tower;
+  }
+  _tower_list.clear();
+  if (!_indexed)
+  {
+    buildIndex(_n1, _n2, _n3);
   }
 }
 
 void RawTowerZDCContainer::identify(std::ostream &os) const
 {
-  os << "RawTowerZDCContainer, number of towers: " << size() << std::endl;
+  os << "RawTowerZDCContainer, number of towers: " << size()
+     << ", index range: " << _n1 << " x " << _n2 << " x " << _n3 << std::endl;
 }
 
 double
 RawTowerZDCContainer::getTotalEdep() const
 {
   double totalenergy = 0;
-  ConstIterator iter;
-  for (iter = _towers.begin(); iter != _towers.end(); ++iter)
+  for (auto tower : _tower_list)
   {
-    totalenergy += iter->second->get_energy();
+    totalenergy += tower->get_energy();
   }
   return totalenergy;
 }
+
+int RawTowerZDCContainer::denseIndex(RawTowerZDCDefs::keytype key) const
+{
+  if (RawTowerZDCDefs::decode_caloid(key) != _caloid)
+  {
+    return -1;
+  }
+  const unsigned int i1 = RawTowerZDCDefs::decode_index1zdc(key);
+  const unsigned int i2 = RawTowerZDCDefs::decode_index2zdc(key);
+  const unsigned int i3 = RawTowerZDCDefs::decode_index3zdc(key);
+  if (i1 >= _n1 || i2 >= _n2 || i3 >= _n3)
+  {
+    return -1;
+  }
+  return (i1 * _n2 + i2) * _n3 + i3;
+}
+
+int RawTowerZDCContainer::findTower(RawTowerZDCDefs::keytype key) const
+{
+  if (!_indexed)
+  {
+    buildIndex(_n1, _n2, _n3);
+  }
+  int index = denseIndex(key);
+  if (index < 0)
+  {
+    return -1;
+  }
+  return _slot[index];
+}
+
+unsigned int RawTowerZDCContainer::nextOccupied(unsigned int index) const
+{
+  unsigned int word = index / 64;
+  if (word >= _occupancy.size())
+  {
+    return _slot.size();
+  }
+  unsigned long long bits = _occupancy[word] & (~0ULL << (index % 64));
+  while (bits == 0)
+  {
+    if (++word >= _occupancy.size())
+    {
+      return _slot.size();
+    }
+    bits = _occupancy[word];
+  }
+  return word * 64 + __builtin_ctzll(bits);
+}
+
+void RawTowerZDCContainer::buildIndex(unsigned int n1, unsigned int n2, unsigned int n3) const
+{
+  for (auto tower : _tower_list)
+  {
+    n1 = max(n1, RawTowerZDCDefs::decode_index1zdc(tower->get_id()) + 1);
+    n2 = max(n2, RawTowerZDCDefs::decode_index2zdc(tower->get_id()) + 1);
+    n3 = max(n3, RawTowerZDCDefs::decode_index3zdc(tower->get_id()) + 1);
+  }
+  _n1 = n1;
+  _n2 = n2;
+  _n3 = n3;
+  _slot.assign(n1 * n2 * n3, -1);
+  _occupancy.assign((_slot.size() + 63) / 64, 0);
+  for (unsigned int pos = 0; pos < _tower_list.size(); pos++)
+  {
+    int index = denseIndex(_tower_list[pos]->get_id());
+    if (index < 0)
+    {
+      cout << "RawTowerZDCContainer::buildIndex - Error - tower with key " << _tower_list[pos]->get_id()
+           << " does not belong to container with CaloID " << _caloid << endl;
+      continue;
+    }
+    setSlot(index, pos);
+  }
+  _indexed = true;
+}
+
+void RawTowerZDCContainer::setSlot(unsigned int index, int position) const
+{
+  _slot[index] = position;
+  _occupancy[index / 64] |= (1ULL << (index % 64));
+}
+
+void RawTowerZDCContainer::clearSlot(unsigned int index) const
+{
+  _slot[index] = -1;
+  _occupancy[index / 64] &= ~(1ULL << (index % 64));
+}
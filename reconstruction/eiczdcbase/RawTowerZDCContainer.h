@@ -6,17 +6,51 @@
 #include <phool/PHObject.h>
 
 #include <iostream>
-#include <map>
 #include <utility>
+#include <vector>
 
 class RawTowerZDC;
 
+/*! Container of the towers of one ZDC sub detector.
+ *
+ * Since class version 2 the towers are kept in a flat array instead of a std::map.
+ * A dense index over the (index1, index2, index3) space of the tower keys points
+ * into this array, so tower lookups do not need a tree search, and an occupancy
+ * bitmap over the same space lets the iteration skip the empty towers while still
+ * visiting the towers in key order like the map did. Only the flat array is
+ * written out, the index is rebuilt after reading. Version 1 files (std::map)
+ * are converted by a read rule in RawTowerZDCContainerLinkDef.h.
+ */
 class RawTowerZDCContainer : public PHObject
 {
  public:
-  typedef std::map<RawTowerZDCDefs::keytype, RawTowerZDC *> Map;
-  typedef Map::iterator Iterator;
-  typedef Map::const_iterator ConstIterator;
+  //! iterator over the occupied towers in key order, dereferences to a (key, tower) pair like the former map iterator
+  class Iterator
+  {
+   public:
+    typedef std::pair<RawTowerZDCDefs::keytype, RawTowerZDC *> value_type;
+
+    Iterator()
+      : _container(nullptr)
+      , _index(0)
+      , _value(0, nullptr)
+    {
+    }
+    Iterator(const RawTowerZDCContainer *container, unsigned int index);
+
+    const value_type &operator*() const { return _value; }
+    const value_type *operator->() const { return &_value; }
+    Iterator &operator++();
+    Iterator operator++(int);
+    bool operator==(const Iterator &rhs) const { return _index == rhs._index; }
+    bool operator!=(const Iterator &rhs) const { return _index != rhs._index; }
+
+   private:
+    const RawTowerZDCContainer *_container;
+    unsigned int _index;
+    value_type _value;
+  };
+  typedef Iterator ConstIterator;
   typedef std::pair<Iterator, Iterator> Range;
   typedef std::pair<ConstIterator, ConstIterator> ConstRange;
 
@@ -34,6 +68,10 @@ class RawTowerZDCContainer : public PHObject
   void setCalorimeterID(RawTowerZDCDefs::CalorimeterId caloid) { _caloid = caloid; }
   RawTowerZDCDefs::CalorimeterId getCalorimeterID() { return _caloid; }
 
+  //! reserve the index space for towers with index1 < n1, index2 < n2 and index3 < n3,
+  //! otherwise it grows with the tower keys added
+  void setIndexRange(const unsigned int n1, const unsigned int n2, const unsigned int n3);
+
   ConstIterator AddTower(const unsigned int ieta, const unsigned int iphi, const unsigned int il, RawTowerZDC *twr);
   ConstIterator AddTower(RawTowerZDCDefs::keytype key, RawTowerZDC *twr);
 
@@ -47,15 +85,38 @@ class RawTowerZDCContainer : public PHObject
   ConstRange getTowers(void) const;
   Range getTowers(void);
 
-  unsigned int size() const { return _towers.size(); }
+  unsigned int size() const { return _tower_list.size(); }
   void compress(const double emin);
   double getTotalEdep() const;
 
  protected:
-  RawTowerZDCDefs::CalorimeterId _caloid;
-  Map _towers;
+  //! dense index of a tower key, -1 if the key is outside the index space
+  int denseIndex(RawTowerZDCDefs::keytype key) const;
+  //! position of the tower in the flat array, -1 if the tower is not in the container
+  int findTower(RawTowerZDCDefs::keytype key) const;
+  //! first occupied dense index at or after index, _slot.size() if there is none
+  unsigned int nextOccupied(unsigned int index) const;
+  //! (re)build the dense index and occupancy bitmap for the towers in the flat array
+  void buildIndex(unsigned int n1, unsigned int n2, unsigned int n3) const;
+  void setSlot(unsigned int index, int position) const;
+  void clearSlot(unsigned int index) const;
 
-  ClassDefOverride(RawTowerZDCContainer, 1)
+  RawTowerZDCDefs::CalorimeterId _caloid;
+  //! the towers of the event, in the order they were added
+  std::vector<RawTowerZDC *> _tower_list;
+
+  //! dense index space (index1, index2, index3), cell (i1 * _n2 + i2) * _n3 + i3
+  mutable unsigned int _n1 = 0;                 //!
+  mutable unsigned int _n2 = 0;                 //!
+  mutable unsigned int _n3 = 0;                 //!
+  //! position in _tower_list per cell, -1 for empty cells
+  mutable std::vector<int> _slot;               //!
+  //! one bit per cell, set for the occupied cells
+  mutable std::vector<unsigned long long> _occupancy;  //!
+  //! false after reading from file until the index is rebuilt
+  mutable bool _indexed = false;                //!
+
+  ClassDefOverride(RawTowerZDCContainer, 2)
 };
 
 #endif
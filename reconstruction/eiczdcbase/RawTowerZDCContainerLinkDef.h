@@ -2,4 +2,16 @@
 
 #pragma link C++ class RawTowerZDCContainer + ;
 
+// version 1 kept the towers in a std::map, version 2 in a flat array
+#pragma read sourceClass = "RawTowerZDCContainer" version = "[1]" \
+  source = "std::map<unsigned int, RawTowerZDC*> _towers" \
+  targetClass = "RawTowerZDCContainer" target = "_tower_list" \
+  code = "{ _tower_list.clear(); for (const auto &tower : onfile._towers) { _tower_list.push_back(tower.second); } }"
+
+// the dense tower index is not written out, rebuild it after reading
+#pragma read sourceClass = "RawTowerZDCContainer" version = "[1-]" \
+  source = "" \
+  targetClass = "RawTowerZDCContainer" target = "_indexed" \
+  code = "{ _indexed = false; }"
+
 #endif /* __CINT__ */
@@ -34,6 +34,18 @@ bool RawTowerZDCDeadMap::isDeadTower(const unsigned int /*ieta*/, const unsigned
   return false;
 }
 
+unsigned int RawTowerZDCDeadMap::maskDeadTowers(const std::vector<RawTowerZDCDefs::keytype>& keys, std::vector<char>& dead)
+{
+  unsigned int ndead = 0;
+  dead.resize(keys.size());
+  for (unsigned int i = 0; i < keys.size(); i++)
+  {
+    dead[i] = isDeadTower(keys[i]);
+    ndead += dead[i];
+  }
+  return ndead;
+}
+
 int RawTowerZDCDeadMap::isValid() const
 {
   return size() > 0;
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 class RawTowerZDCDeadMap : public PHObject
 {
@@ -27,6 +28,8 @@ class RawTowerZDCDeadMap : public PHObject
 
   virtual bool isDeadTower(RawTowerZDCDefs::keytype key);
   virtual bool isDeadTower(const unsigned int ieta, const unsigned int iphi);
+  //! set dead[i] for the dead towers among keys[i], returns the number of dead towers
+  virtual unsigned int maskDeadTowers(const std::vector<RawTowerZDCDefs::keytype> &keys, std::vector<char> &dead);
   //! return all towers
   virtual const Map &getDeadTowers(void) const;
   virtual Map &getDeadTowers(void);
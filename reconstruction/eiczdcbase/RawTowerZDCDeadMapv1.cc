@@ -0,0 +1,125 @@
+#include "RawTowerZDCDeadMapv1.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+void RawTowerZDCDeadMapv1::addDeadTower(const unsigned int ieta, const unsigned int iphi)
+{
+  addDeadTower(RawTowerZDCDefs::encode_towerid_zdc(_caloid, ieta, iphi, 0));
+}
+
+void RawTowerZDCDeadMapv1::addDeadTower(RawTowerZDCDefs::keytype key)
+{
+  _dead_towers.insert(key);
+  if (!_indexed)
+  {
+    return;
+  }
+  const unsigned int i1 = RawTowerZDCDefs::decode_index1zdc(key);
+  const unsigned int i2 = RawTowerZDCDefs::decode_index2zdc(key);
+  const unsigned int i3 = RawTowerZDCDefs::decode_index3zdc(key);
+  if (RawTowerZDCDefs::decode_caloid(key) != _caloid || i1 >= _n1 || i2 >= _n2 || i3 >= _n3)
+  {
+    // outside of the bitmap, rebuild it on the next lookup
+    _indexed = false;
+    return;
+  }
+  const unsigned int index = (i1 * _n2 + i2) * _n3 + i3;
+  _bits[index / 64] |= (1ULL << (index % 64));
+}
+
+bool RawTowerZDCDeadMapv1::isDeadTower(RawTowerZDCDefs::keytype key)
+{
+  if (!_indexed)
+  {
+    buildBitmap();
+  }
+  return testBit(key);
+}
+
+bool RawTowerZDCDeadMapv1::isDeadTower(const unsigned int ieta, const unsigned int iphi)
+{
+  return isDeadTower(RawTowerZDCDefs::encode_towerid_zdc(_caloid, ieta, iphi, 0));
+}
+
+unsigned int RawTowerZDCDeadMapv1::maskDeadTowers(const std::vector<RawTowerZDCDefs::keytype> &keys, std::vector<char> &dead)
+{
+  if (!_indexed)
+  {
+    buildBitmap();
+  }
+  unsigned int ndead = 0;
+  dead.resize(keys.size());
+  for (unsigned int i = 0; i < keys.size(); i++)
+  {
+    dead[i] = testBit(keys[i]);
+    ndead += dead[i];
+  }
+  return ndead;
+}
+
+RawTowerZDCDeadMap::Map &
+RawTowerZDCDeadMapv1::getDeadTowers(void)
+{
+  // the set can be modified by the caller
+  _indexed = false;
+  return _dead_towers;
+}
+
+void RawTowerZDCDeadMapv1::Reset()
+{
+  _dead_towers.clear();
+  _indexed = false;
+}
+
+void RawTowerZDCDeadMapv1::identify(std::ostream &os) const
+{
+  os << "RawTowerZDCDeadMapv1, number of dead towers: " << size() << std::endl;
+}
+
+bool RawTowerZDCDeadMapv1::testBit(RawTowerZDCDefs::keytype key) const
+{
+  if (RawTowerZDCDefs::decode_caloid(key) != _caloid)
+  {
+    return false;
+  }
+  const unsigned int i1 = RawTowerZDCDefs::decode_index1zdc(key);
+  const unsigned int i2 = RawTowerZDCDefs::decode_index2zdc(key);
+  const unsigned int i3 = RawTowerZDCDefs::decode_index3zdc(key);
+  if (i1 >= _n1 || i2 >= _n2 || i3 >= _n3)
+  {
+    return false;
+  }
+  const unsigned int index = (i1 * _n2 + i2) * _n3 + i3;
+  return (_bits[index / 64] >> (index % 64)) & 1ULL;
+}
+
+void RawTowerZDCDeadMapv1::buildBitmap()
+{
+  _n1 = _n2 = _n3 = 0;
+  for (auto key : _dead_towers)
+  {
+    if (RawTowerZDCDefs::decode_caloid(key) != _caloid)
+    {
+      cout << "RawTowerZDCDeadMapv1::buildBitmap - Error - dead tower with key " << key
+           << " does not belong to dead map with CaloID " << _caloid << endl;
+      continue;
+    }
+    _n1 = max(_n1, RawTowerZDCDefs::decode_index1zdc(key) + 1);
+    _n2 = max(_n2, RawTowerZDCDefs::decode_index2zdc(key) + 1);
+    _n3 = max(_n3, RawTowerZDCDefs::decode_index3zdc(key) + 1);
+  }
+  _bits.assign((_n1 * _n2 * _n3 + 63) / 64, 0);
+  for (auto key : _dead_towers)
+  {
+    if (RawTowerZDCDefs::decode_caloid(key) != _caloid)
+    {
+      continue;
+    }
+    const unsigned int index = (RawTowerZDCDefs::decode_index1zdc(key) * _n2 + RawTowerZDCDefs::decode_index2zdc(key)) * _n3 + RawTowerZDCDefs::decode_index3zdc(key);
+    _bits[index / 64] |= (1ULL << (index % 64));
+  }
+  _indexed = true;
+}
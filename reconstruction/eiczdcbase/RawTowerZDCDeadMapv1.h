@@ -0,0 +1,67 @@
+#ifndef EICZDCBASE_RAWTOWERZDCDEADMAPV1_H
+#define EICZDCBASE_RAWTOWERZDCDEADMAPV1_H
+
+#include "RawTowerZDCDeadMap.h"
+
+#include "RawTowerZDCDefs.h"
+
+#include <iostream>
+#include <vector>
+
+/*! Dead tower map of one ZDC sub detector.
+ *
+ * The dead tower keys are written out as a std::set, and a bitmap over the dense
+ * (index1, index2, index3) space of the keys is built on first use, so isDeadTower
+ * is a bit test instead of a tree search. The bitmap is not written out and is
+ * rebuilt after reading or after the set was modified through getDeadTowers().
+ */
+class RawTowerZDCDeadMapv1 : public RawTowerZDCDeadMap
+{
+ public:
+  RawTowerZDCDeadMapv1(RawTowerZDCDefs::CalorimeterId caloid = RawTowerZDCDefs::NONE)
+    : _caloid(caloid)
+  {
+  }
+  ~RawTowerZDCDeadMapv1() override {}
+
+  void Reset() override;
+  void identify(std::ostream &os = std::cout) const override;
+
+  void setCalorimeterID(RawTowerZDCDefs::CalorimeterId caloid) override { _caloid = caloid; }
+  RawTowerZDCDefs::CalorimeterId getCalorimeterID() override { return _caloid; }
+
+  //! towers with two indices are stored with index3 = 0
+  void addDeadTower(const unsigned int ieta, const unsigned int iphi) override;
+  void addDeadTower(RawTowerZDCDefs::keytype key) override;
+
+  bool isDeadTower(RawTowerZDCDefs::keytype key) override;
+  bool isDeadTower(const unsigned int ieta, const unsigned int iphi) override;
+  unsigned int maskDeadTowers(const std::vector<RawTowerZDCDefs::keytype> &keys, std::vector<char> &dead) override;
+
+  //! return all towers
+  const Map &getDeadTowers(void) const override { return _dead_towers; }
+  Map &getDeadTowers(void) override;
+
+  unsigned int size() const override { return _dead_towers.size(); }
+
+ protected:
+  //! bit test for a tower key, false for keys outside the bitmap
+  bool testBit(RawTowerZDCDefs::keytype key) const;
+  //! (re)build the bitmap for the towers in _dead_towers
+  void buildBitmap();
+
+  RawTowerZDCDefs::CalorimeterId _caloid;
+  Map _dead_towers;
+
+  //! dense index space (index1, index2, index3), bit (i1 * _n2 + i2) * _n3 + i3
+  unsigned int _n1 = 0;                  //!
+  unsigned int _n2 = 0;                  //!
+  unsigned int _n3 = 0;                  //!
+  std::vector<unsigned long long> _bits;  //!
+  //! false after reading from file until the bitmap is rebuilt
+  bool _indexed = false;                 //!
+
+  ClassDefOverride(RawTowerZDCDeadMapv1, 1)
+};
+
+#endif
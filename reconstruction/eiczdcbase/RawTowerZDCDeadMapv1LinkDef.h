@@ -0,0 +1,11 @@
+#ifdef __CINT__
+
+#pragma link C++ class RawTowerZDCDeadMapv1 + ;
+
+// the bitmap is not written out, rebuild it after reading
+#pragma read sourceClass = "RawTowerZDCDeadMapv1" version = "[1-]" \
+  source = "" \
+  targetClass = "RawTowerZDCDeadMapv1" target = "_indexed" \
+  code = "{ _indexed = false; }"
+
+#endif /* __CINT__ */
@@ -19,6 +19,7 @@
 #include <phool/PHObject.h>
 #include <phool/getClass.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
@@ -28,6 +29,7 @@
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -58,6 +60,10 @@ RawTowerZDCCalibration::RawTowerZDCCalibration(const std::string &name)
   _GeV_ADC_file(false)
   , _tower_type(-1)
   , _tower_calib_params(name)
+  , _validate_calibration(false)
+  , _table_n1(0)
+  , _table_n2(0)
+  , _table_n3(0)
 {
 }
 
@@ -85,6 +91,17 @@ int RawTowerZDCCalibration::InitRun(PHCompositeNode *topNode)
     std::cout << e.what() << std::endl;
     return Fun4AllReturnCodes::ABORTRUN;
   }
+
+  if (_calib_algorithm == kTower_by_tower_calibration)
+  {
+    const unsigned int nmissing = BuildCalibrationTable();
+    if (nmissing > 0 && _validate_calibration)
+    {
+      std::cout << Name() << "::" << detector << "::" << __PRETTY_FUNCTION__
+                << " calibration constants missing for " << nmissing << " towers, aborting run" << std::endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
@@ -96,6 +113,11 @@ int RawTowerZDCCalibration::process_event(PHCompositeNode */*topNode*/)
               << "Process event entered" << std::endl;
   }
 
+  if (_calib_algorithm == kTower_by_tower_calibration && !_table_status.empty())
+  {
+    return process_table();
+  }
+
   RawTowerZDCContainer::ConstRange begin_end = _raw_towers->getTowers();
   RawTowerZDCContainer::ConstIterator rtiter;
   for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
@@ -133,31 +155,7 @@ int RawTowerZDCCalibration::process_event(PHCompositeNode */*topNode*/)
     }
     else if (_calib_algorithm == kTower_by_tower_calibration)
     {
-      //      RawTowerZDCDefs::CalorimeterId caloid = RawTowerZDCDefs::decode_caloid(key);
-      const int eta = raw_tower->get_bineta();
-      const int phi = raw_tower->get_binphi();
-      const int twr   = raw_tower->get_binl();
-
-      double tower_by_tower_calib = 1.;
-      const string calib_const_name("calib_const_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr));
-
-      tower_by_tower_calib = _tower_calib_params.get_double_param(calib_const_name);
-
-      if (_pedestal_file == true)
-      {
-	const string pedestal_name("PedCentral_ADC_eta" + to_string(eta) + "_phi" + to_string(phi)+ "_twr" + to_string(twr));
-	_pedestal_ADC = _tower_calib_params.get_double_param(pedestal_name);
-      }
-
-      if (_GeV_ADC_file == true)
-      {
-	const string GeVperADCname("GeVperADC_eta" + to_string(eta) + "_phi" + to_string(phi)+ "_twr" + to_string(twr));
-	_calib_const_GeV_ADC = _tower_calib_params.get_double_param(GeVperADCname);
-      }
-       
-      const double raw_energy = raw_tower->get_energy();
-      const double calib_energy = (raw_energy - _pedestal_ADC) * _calib_const_GeV_ADC * tower_by_tower_calib;
-
+      const double calib_energy = tower_by_tower_energy(raw_tower);
 
       RawTowerZDC *calib_tower = new RawTowerZDCv1(*raw_tower);
       calib_tower->set_energy(calib_energy);
@@ -183,6 +181,181 @@ int RawTowerZDCCalibration::process_event(PHCompositeNode */*topNode*/)
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
+double RawTowerZDCCalibration::tower_by_tower_energy(const RawTowerZDC *raw_tower)
+{
+  const int eta = raw_tower->get_bineta();
+  const int phi = raw_tower->get_binphi();
+  const int twr   = raw_tower->get_binl();
+
+  double tower_by_tower_calib = 1.;
+  const string calib_const_name("calib_const_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr));
+
+  tower_by_tower_calib = _tower_calib_params.get_double_param(calib_const_name);
+
+  if (_pedestal_file == true)
+  {
+    const string pedestal_name("PedCentral_ADC_eta" + to_string(eta) + "_phi" + to_string(phi)+ "_twr" + to_string(twr));
+    _pedestal_ADC = _tower_calib_params.get_double_param(pedestal_name);
+  }
+
+  if (_GeV_ADC_file == true)
+  {
+    const string GeVperADCname("GeVperADC_eta" + to_string(eta) + "_phi" + to_string(phi)+ "_twr" + to_string(twr));
+    _calib_const_GeV_ADC = _tower_calib_params.get_double_param(GeVperADCname);
+  }
+
+  const double raw_energy = raw_tower->get_energy();
+  return (raw_energy - _pedestal_ADC) * _calib_const_GeV_ADC * tower_by_tower_calib;
+}
+
+unsigned int RawTowerZDCCalibration::BuildCalibrationTable()
+{
+  RawTowerZDCGeomContainer::ConstRange all_towers = rawtowergeom->get_tower_geometries();
+
+  _table_n1 = _table_n2 = _table_n3 = 0;
+  for (RawTowerZDCGeomContainer::ConstIterator it = all_towers.first; it != all_towers.second; ++it)
+  {
+    const RawTowerZDCDefs::keytype key = it->first;
+    _table_n1 = max(_table_n1, RawTowerZDCDefs::decode_index1zdc(key) + 1);
+    _table_n2 = max(_table_n2, RawTowerZDCDefs::decode_index2zdc(key) + 1);
+    _table_n3 = max(_table_n3, RawTowerZDCDefs::decode_index3zdc(key) + 1);
+  }
+  const unsigned int ncells = _table_n1 * _table_n2 * _table_n3;
+  _table_scale.assign(ncells, 0);
+  _table_offset.assign(ncells, 0);
+  _table_status.assign(ncells, kTable_skip);
+
+  unsigned int nmissing = 0;
+  for (RawTowerZDCGeomContainer::ConstIterator it = all_towers.first; it != all_towers.second; ++it)
+  {
+    const RawTowerZDCDefs::keytype key = it->first;
+    if (RawTowerZDCDefs::decode_caloid(key) != _raw_towers->getCalorimeterID())
+    {
+      continue;
+    }
+    if (_tower_type >= 0 && _tower_type != it->second->get_tower_type())
+    {
+      continue;
+    }
+    const int eta = RawTowerZDCDefs::decode_index1zdc(key);
+    const int phi = RawTowerZDCDefs::decode_index2zdc(key);
+    const int twr = RawTowerZDCDefs::decode_index3zdc(key);
+    const unsigned int cell = (eta * _table_n2 + phi) * _table_n3 + twr;
+
+    const string suffix("_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr));
+    std::vector<string> names(1, "calib_const" + suffix);
+    if (_pedestal_file)
+    {
+      names.push_back("PedCentral_ADC" + suffix);
+    }
+    if (_GeV_ADC_file)
+    {
+      names.push_back("GeVperADC" + suffix);
+    }
+    bool missing = false;
+    for (const auto &name : names)
+    {
+      if (!_tower_calib_params.exist_double_param(name))
+      {
+        missing = true;
+        if (_validate_calibration || Verbosity())
+        {
+          std::cout << Name() << "::" << detector << "::" << __PRETTY_FUNCTION__
+                    << " missing calibration constant " << name << std::endl;
+        }
+      }
+    }
+    if (missing)
+    {
+      _table_status[cell] = kTable_missing;
+      nmissing++;
+      continue;
+    }
+
+    const double pedestal = _pedestal_file ? _tower_calib_params.get_double_param("PedCentral_ADC" + suffix) : _pedestal_ADC;
+    const double GeV_ADC = _GeV_ADC_file ? _tower_calib_params.get_double_param("GeVperADC" + suffix) : _calib_const_GeV_ADC;
+    _table_scale[cell] = GeV_ADC * _tower_calib_params.get_double_param("calib_const" + suffix);
+    _table_offset[cell] = -pedestal * _table_scale[cell];
+    _table_status[cell] = kTable_ok;
+  }
+
+  if (Verbosity())
+  {
+    std::cout << Name() << "::" << detector << "::" << __PRETTY_FUNCTION__
+              << " calibration table for " << _table_n1 << " x " << _table_n2 << " x " << _table_n3
+              << " tower indices, towers with missing constants: " << nmissing << std::endl;
+  }
+  return nmissing;
+}
+
+int RawTowerZDCCalibration::process_table()
+{
+  // gather the towers with their constants
+  _kernel_tower.clear();
+  _kernel_energy.clear();
+  _kernel_scale.clear();
+  _kernel_offset.clear();
+  RawTowerZDCContainer::ConstRange begin_end = _raw_towers->getTowers();
+  for (RawTowerZDCContainer::ConstIterator rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
+  {
+    const RawTowerZDC *raw_tower = rtiter->second;
+    assert(raw_tower);
+
+    const unsigned int eta = RawTowerZDCDefs::decode_index1zdc(rtiter->first);
+    const unsigned int phi = RawTowerZDCDefs::decode_index2zdc(rtiter->first);
+    const unsigned int twr = RawTowerZDCDefs::decode_index3zdc(rtiter->first);
+    // towers outside of the geometry
+    assert(eta < _table_n1 && phi < _table_n2 && twr < _table_n3);
+    if (eta >= _table_n1 || phi >= _table_n2 || twr >= _table_n3)
+    {
+      continue;
+    }
+    const unsigned int cell = (eta * _table_n2 + phi) * _table_n3 + twr;
+    if (_table_status[cell] == kTable_skip)
+    {
+      continue;
+    }
+    if (_table_status[cell] == kTable_missing)
+    {
+      // no compiled constants, same lookup by name as without the table
+      RawTowerZDC *calib_tower = new RawTowerZDCv1(*raw_tower);
+      calib_tower->set_energy(tower_by_tower_energy(raw_tower));
+      _calib_towers->AddTower(rtiter->first, calib_tower);
+      continue;
+    }
+    _kernel_tower.push_back(raw_tower);
+    _kernel_energy.push_back(raw_tower->get_energy());
+    _kernel_scale.push_back(_table_scale[cell]);
+    _kernel_offset.push_back(_table_offset[cell]);
+  }
+
+  // calibration kernel, one fused multiply-add per tower
+  const unsigned int ntowers = _kernel_energy.size();
+  double *energy = _kernel_energy.data();
+  const double *scale = _kernel_scale.data();
+  const double *offset = _kernel_offset.data();
+  for (unsigned int i = 0; i < ntowers; i++)
+  {
+    energy[i] = fma(energy[i], scale[i], offset[i]);
+  }
+
+  for (unsigned int i = 0; i < ntowers; i++)
+  {
+    RawTowerZDC *calib_tower = new RawTowerZDCv1(*_kernel_tower[i]);
+    calib_tower->set_energy(energy[i]);
+    _calib_towers->AddTower(_kernel_tower[i]->get_id(), calib_tower);
+  }
+
+  if (Verbosity())
+  {
+    std::cout << Name() << "::" << detector << "::" << __PRETTY_FUNCTION__
+              << "input sum energy = " << _raw_towers->getTotalEdep()
+              << ", output sum digitalized value = "
+              << _calib_towers->getTotalEdep() << std::endl;
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
 int RawTowerZDCCalibration::End(PHCompositeNode */*topNode*/)
 {
   return Fun4AllReturnCodes::EVENT_OK;
@@ -7,8 +7,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 class PHCompositeNode;
+class RawTowerZDC;
 class RawTowerZDCContainer;
 class RawTowerZDCGeomContainer;
 
@@ -130,6 +132,14 @@ class RawTowerZDCCalibration : public SubsysReco
               << std::endl;
   }
 
+  //! check at InitRun that the tower by tower constants exist for all towers, report the
+  //! missing ones and abort the run instead of failing on the first tower that needs them
+  void
+  set_validate_calibration(const bool value)
+  {
+    _validate_calibration = value;
+  }
+
   //! Get the parameters for update. Useful fields are listed in SetDefaultParameters();
   PHParameters &
   GetCalibrationParameters()
@@ -141,6 +151,18 @@ class RawTowerZDCCalibration : public SubsysReco
   void
   CreateNodes(PHCompositeNode *topNode);
 
+  //! compile the tower by tower constants into the dense calibration table, returns the number of towers with missing constants
+  unsigned int
+  BuildCalibrationTable();
+
+  //! tower by tower calibration of one tower from the parameters by name
+  double
+  tower_by_tower_energy(const RawTowerZDC *raw_tower);
+
+  //! tower by tower calibration with the calibration table
+  int
+  process_table();
+
   enu_calib_algorithm _calib_algorithm;
 
   RawTowerZDCContainer *_calib_towers;
@@ -172,6 +194,32 @@ class RawTowerZDCCalibration : public SubsysReco
 
   //! Tower by tower calibration parameters
   PHParameters _tower_calib_params;
+
+  //! check the tower by tower constants at InitRun
+  bool _validate_calibration;
+
+  //! tower by tower calibration table, cell (i1 * _table_n2 + i2) * _table_n3 + i3 of the tower key indices
+  //! calibrated energy = raw energy * _table_scale + _table_offset
+  unsigned int _table_n1;
+  unsigned int _table_n2;
+  unsigned int _table_n3;
+  std::vector<double> _table_scale;
+  std::vector<double> _table_offset;
+  enum enu_table_status
+  {
+    //! not a tower of this detector or of another tower type
+    kTable_skip = 0,
+    kTable_ok = 1,
+    //! constants missing, calibrated from the parameters by name
+    kTable_missing = 2
+  };
+  std::vector<char> _table_status;
+
+  //! towers of the event for the calibration kernel
+  std::vector<const RawTowerZDC *> _kernel_tower;
+  std::vector<double> _kernel_energy;
+  std::vector<double> _kernel_scale;
+  std::vector<double> _kernel_offset;
 };
 
 #endif
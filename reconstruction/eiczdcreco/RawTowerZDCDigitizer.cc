@@ -8,6 +8,8 @@
 #include <eiczdcbase/RawTowerZDCGeomContainer.h>
 #include <eiczdcbase/RawTowerZDCv1.h>
 
+#include <ffaobjects/EventHeader.h>
+
 #include <fun4all/Fun4AllBase.h>  // for Fun4AllBase::VERBOSITY_MORE
 #include <fun4all/Fun4AllReturnCodes.h>
 #include <fun4all/SubsysReco.h>  // for SubsysReco
@@ -26,6 +28,7 @@
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_rng.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>    // for exit
 #include <exception>  // for exception
@@ -34,9 +37,29 @@
 #include <stdexcept>
 #include <string>
 #include <utility>  // for pair
+#include <vector>
 
 using namespace std;
 
+namespace
+{
+  // counter based random numbers for the batch digitization: splitmix64 finalizer of
+  // (stream, counter), the same stream and counter always give the same number
+  inline unsigned long long counter_hash(const unsigned long long stream, const unsigned long long counter)
+  {
+    unsigned long long z = stream + 0x9E3779B97F4A7C15ULL * (counter + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  // uniform in (0, 1) from the upper 53 bits
+  inline double counter_uniform(const unsigned long long stream, const unsigned long long counter)
+  {
+    return ((counter_hash(stream, counter) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+  }
+}  // namespace
+
 RawTowerZDCDigitizer::RawTowerZDCDigitizer(const std::string &name)
   : SubsysReco(name)
   , m_DigiAlgorithm(kNo_digitization)
@@ -57,16 +80,24 @@ RawTowerZDCDigitizer::RawTowerZDCDigitizer(const std::string &name)
   , m_TowerType(-1)
   , m_SiPMEffectivePixel(40000 * 4)  // sPHENIX EMCal default, 4x Hamamatsu S12572-015P MPPC [sPHENIX TDR]
   , _tower_params(name)
+  , m_SparseNoise(false)
+  , m_EventStamp(0)
+  , m_NoiseThreshold(NAN)
+  , m_NoiseProbability(NAN)
+  , m_BatchDigitization(false)
+  , m_EventCounter(0)
 {
   m_RandomGenerator = gsl_rng_alloc(gsl_rng_mt19937);
   m_Seed = PHRandomSeed();  // fixed seed handled in PHRandomSeed()
   // cout << Name() << " Random Seed: " << m_Seed << endl;
   gsl_rng_set(m_RandomGenerator, m_Seed);
+  m_BatchGenerator = gsl_rng_alloc(gsl_rng_taus2);
 }
 
 RawTowerZDCDigitizer::~RawTowerZDCDigitizer()
 {
   gsl_rng_free(m_RandomGenerator);
+  gsl_rng_free(m_BatchGenerator);
 }
 
 void RawTowerZDCDigitizer::set_seed(const unsigned int iseed)
@@ -98,10 +129,75 @@ int RawTowerZDCDigitizer::InitRun(PHCompositeNode *topNode)
     cout << e.what() << endl;
     return Fun4AllReturnCodes::ABORTRUN;
   }
+
+  if (m_BatchDigitization)
+  {
+    m_SparseNoise = false;
+  }
+  if (m_SparseNoise && (m_ZeroSuppressionFile || m_pedestalFile))
+  {
+    cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+         << " sparse noise needs the same pedestal and zero suppression for all towers, digitizing all towers" << endl;
+    m_SparseNoise = false;
+  }
+  if (m_SparseNoise || m_BatchDigitization)
+  {
+    // the geometry map is ordered by key, so is the candidate list
+    m_NoiseCandidates.clear();
+    m_BatchPedCentral.clear();
+    m_BatchPedWidth.clear();
+    m_BatchZeroSuppression.clear();
+    RawTowerZDCGeomContainer::ConstRange all_towers = m_RawTowerGeom->get_tower_geometries();
+    for (RawTowerZDCGeomContainer::ConstIterator it = all_towers.first; it != all_towers.second; ++it)
+    {
+      if (m_TowerType >= 0 && m_TowerType != it->second->get_tower_type())
+      {
+        continue;
+      }
+      m_NoiseCandidates.push_back(it->second->get_id());
+      if (m_BatchDigitization)
+      {
+        // pedestal and zero suppression per tower, looked up once instead of per event
+        const string suffix = "_eta" + to_string(it->second->get_bineta()) + "_phi" + to_string(it->second->get_binphi()) + "_twr" + to_string(it->second->get_binl());
+        m_BatchPedCentral.push_back(m_pedestalFile ? _tower_params.get_double_param("PedCentral_ADC" + suffix) : m_PedestalCentralADC);
+        const double width = m_pedestalFile ? _tower_params.get_double_param("PedWidth_ADC" + suffix) : m_PedestalWidthADC;
+        m_BatchPedWidth.push_back((width > 0) ? width : 0);
+        m_BatchZeroSuppression.push_back(m_ZeroSuppressionFile ? _tower_params.get_double_param("ZS_ADC" + suffix) : m_ZeroSuppressionADC);
+      }
+    }
+    m_NoiseStamp.assign(m_NoiseCandidates.size(), 0);
+    m_EventStamp = 0;
+    m_BatchEnergy.assign(m_NoiseCandidates.size(), 0);
+    m_BatchPedestal.assign(m_NoiseCandidates.size(), 0);
+    m_BatchSignal.assign(m_NoiseCandidates.size(), 0);
+    m_BatchSimTower.assign(m_NoiseCandidates.size(), nullptr);
+  }
+  if (m_SparseNoise)
+  {
+    // an empty tower gives sum_ADC = (int) pedestal, which passes zero suppression for
+    // (int) pedestal >= k with k the smallest integer above m_ZeroSuppressionADC.
+    // (int) truncates towards zero, so this is pedestal >= k for k > 0 and pedestal > k - 1 otherwise
+    const double k = floor(m_ZeroSuppressionADC) + 1;
+    m_NoiseThreshold = (k > 0) ? k : k - 1;
+    if (m_PedestalWidthADC > 0)
+    {
+      m_NoiseProbability = gsl_cdf_gaussian_Q(m_NoiseThreshold - m_PedestalCentralADC, m_PedestalWidthADC);
+    }
+    else
+    {
+      m_NoiseProbability = ((int) m_PedestalCentralADC > m_ZeroSuppressionADC) ? 1 : 0;
+    }
+    if (Verbosity())
+    {
+      cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+           << " sparse noise for " << m_NoiseCandidates.size() << " towers, probability for an empty tower to pass zero suppression "
+           << m_NoiseProbability << endl;
+    }
+  }
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
-int RawTowerZDCDigitizer::process_event(PHCompositeNode */*topNode*/)
+int RawTowerZDCDigitizer::process_event(PHCompositeNode *topNode)
 {
   if (Verbosity())
   {
@@ -119,100 +215,131 @@ int RawTowerZDCDigitizer::process_event(PHCompositeNode */*topNode*/)
     }
     cout << endl;
   }
-  // loop over all possible towers, even empty ones. The digitization can add towers containing
-  // pedestals
-  RawTowerZDCGeomContainer::ConstRange all_towers = m_RawTowerGeom->get_tower_geometries();
-
   double deadChanEnergy = 0;
 
-  for (RawTowerZDCGeomContainer::ConstIterator it = all_towers.first;
-       it != all_towers.second; ++it)
+  if (m_BatchDigitization)
   {
-    const RawTowerZDCDefs::keytype key = it->second->get_id();
-    //    RawTowerZDCDefs::CalorimeterId caloid = RawTowerZDCDefs::decode_caloid(key);
-    const int eta = it->second->get_bineta();
-    const int phi = it->second->get_binphi();
-    const int twr = it->second->get_binl();
-
-    if (m_ZeroSuppressionFile == true)
+    // the event number keeps the random numbers of an event independent of skipped events
+    // and of how the input is split into jobs, the module's event count is only a fallback
+    unsigned long long event = m_EventCounter;
+    EventHeader *evtheader = findNode::getClass<EventHeader>(topNode, "EventHeader");
+    if (evtheader)
     {
-      const string zsName = "ZS_ADC_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr);
-      m_ZeroSuppressionADC = _tower_params.get_double_param(zsName);
+      event = evtheader->get_EvtSequence();
     }
-
-    if (m_pedestalFile == true)
+    else if (m_EventCounter == 0)
     {
-      const string pedCentralName = "PedCentral_ADC_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr);
-      m_PedestalCentralADC = _tower_params.get_double_param(pedCentralName);
-      const string pedWidthName = "PedWidth_ADC_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr);
-      m_PedestalWidthADC = _tower_params.get_double_param(pedWidthName);
+      cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+           << " no EventHeader, the batch random numbers are keyed on the events seen by this module" << endl;
     }
-
-    if (m_TowerType >= 0)
+    m_EventCounter++;
+    if (batch_digitization(event, deadChanEnergy) != Fun4AllReturnCodes::EVENT_OK)
     {
-      // Skip towers that don't match the type we are supposed to digitize
-      if (m_TowerType != it->second->get_tower_type())
-      {
-        continue;
-      }
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  }
+  else if (m_SparseNoise)
+  {
+    if (sparse_digitization(deadChanEnergy) != Fun4AllReturnCodes::EVENT_OK)
+    {
+      return Fun4AllReturnCodes::ABORTRUN;
     }
+  }
+  else
+  {
+    // loop over all possible towers, even empty ones. The digitization can add towers containing
+    // pedestals
+    RawTowerZDCGeomContainer::ConstRange all_towers = m_RawTowerGeom->get_tower_geometries();
 
-    RawTowerZDC *sim_tower = m_SimTowers->getTower(key);
-    if (m_DeadMap)
+    for (RawTowerZDCGeomContainer::ConstIterator it = all_towers.first;
+         it != all_towers.second; ++it)
     {
-      if (m_DeadMap->isDeadTower(key))
+      const RawTowerZDCDefs::keytype key = it->second->get_id();
+      //    RawTowerZDCDefs::CalorimeterId caloid = RawTowerZDCDefs::decode_caloid(key);
+      const int eta = it->second->get_bineta();
+      const int phi = it->second->get_binphi();
+      const int twr = it->second->get_binl();
+
+      if (m_ZeroSuppressionFile == true)
       {
-        if (sim_tower) deadChanEnergy += sim_tower->get_energy();
+        const string zsName = "ZS_ADC_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr);
+        m_ZeroSuppressionADC = _tower_params.get_double_param(zsName);
+      }
 
-        sim_tower = nullptr;
+      if (m_pedestalFile == true)
+      {
+        const string pedCentralName = "PedCentral_ADC_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr);
+        m_PedestalCentralADC = _tower_params.get_double_param(pedCentralName);
+        const string pedWidthName = "PedWidth_ADC_eta" + to_string(eta) + "_phi" + to_string(phi) + "_twr" + to_string(twr);
+        m_PedestalWidthADC = _tower_params.get_double_param(pedWidthName);
+      }
 
-        if (Verbosity() >= VERBOSITY_MORE)
+      if (m_TowerType >= 0)
+      {
+        // Skip towers that don't match the type we are supposed to digitize
+        if (m_TowerType != it->second->get_tower_type())
         {
-          cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
-               << " apply dead tower " << key << endl;
+          continue;
         }
       }
-    }
 
-    RawTowerZDC *digi_tower = nullptr;
-
-    if (m_DigiAlgorithm == kNo_digitization)
-    {
-      // for no digitization just copy existing towers
-      if (sim_tower)
+      RawTowerZDC *sim_tower = m_SimTowers->getTower(key);
+      if (m_DeadMap)
       {
-        digi_tower = new RawTowerZDCv1(*sim_tower);
-      }
-    }
-    else if (m_DigiAlgorithm == kSimple_photon_digitization)
-    {
-      // for photon digitization towers can be created if sim_tower is null pointer
-      digi_tower = simple_photon_digitization(sim_tower);
-    }
-    else if (m_DigiAlgorithm == kSiPM_photon_digitization)
-    {
-      // for photon digitization towers can be created if sim_tower is null pointer
-      digi_tower = sipm_photon_digitization(sim_tower);
-    }
-    else
-    {
-      cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
-           << " invalid digitization algorithm #" << m_DigiAlgorithm
-           << endl;
+        if (m_DeadMap->isDeadTower(key))
+        {
+          if (sim_tower) deadChanEnergy += sim_tower->get_energy();
 
-      return Fun4AllReturnCodes::ABORTRUN;
-    }
+          sim_tower = nullptr;
 
-    if (digi_tower)
-    {
-      m_RawTowers->AddTower(key, digi_tower);
+          if (Verbosity() >= VERBOSITY_MORE)
+          {
+            cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+                 << " apply dead tower " << key << endl;
+          }
+        }
+      }
 
-      if (Verbosity() >= VERBOSITY_MORE)
+      RawTowerZDC *digi_tower = nullptr;
+
+      if (m_DigiAlgorithm == kNo_digitization)
+      {
+        // for no digitization just copy existing towers
+        if (sim_tower)
+        {
+          digi_tower = new RawTowerZDCv1(*sim_tower);
+        }
+      }
+      else if (m_DigiAlgorithm == kSimple_photon_digitization)
+      {
+        // for photon digitization towers can be created if sim_tower is null pointer
+        digi_tower = simple_photon_digitization(sim_tower);
+      }
+      else if (m_DigiAlgorithm == kSiPM_photon_digitization)
+      {
+        // for photon digitization towers can be created if sim_tower is null pointer
+        digi_tower = sipm_photon_digitization(sim_tower);
+      }
+      else
       {
         cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
-             << " output tower:"
+             << " invalid digitization algorithm #" << m_DigiAlgorithm
              << endl;
-        digi_tower->identify();
+
+        return Fun4AllReturnCodes::ABORTRUN;
+      }
+
+      if (digi_tower)
+      {
+        m_RawTowers->AddTower(key, digi_tower);
+
+        if (Verbosity() >= VERBOSITY_MORE)
+        {
+          cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+               << " output tower:"
+               << endl;
+          digi_tower->identify();
+        }
       }
     }
   }
@@ -358,6 +485,256 @@ RawTowerZDCDigitizer::sipm_photon_digitization(RawTowerZDC *sim_tower)
   return digi_tower;
 }
 
+int RawTowerZDCDigitizer::sparse_digitization(double &deadChanEnergy)
+{
+  if (m_DigiAlgorithm != kNo_digitization && m_DigiAlgorithm != kSimple_photon_digitization && m_DigiAlgorithm != kSiPM_photon_digitization)
+  {
+    cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+         << " invalid digitization algorithm #" << m_DigiAlgorithm
+         << endl;
+
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  // new stamp for this event
+  if (++m_EventStamp == 0)
+  {
+    m_NoiseStamp.assign(m_NoiseCandidates.size(), 0);
+    m_EventStamp = 1;
+  }
+
+  // towers with signal are digitized one by one
+  unsigned int nempty = m_NoiseCandidates.size();
+  RawTowerZDCContainer::ConstRange begin_end = m_SimTowers->getTowers();
+  for (RawTowerZDCContainer::ConstIterator it = begin_end.first; it != begin_end.second; ++it)
+  {
+    const RawTowerZDCDefs::keytype key = it->first;
+    RawTowerZDC *sim_tower = it->second;
+
+    // towers without geometry or of another tower type are not digitized
+    std::vector<RawTowerZDCDefs::keytype>::const_iterator candidate = lower_bound(m_NoiseCandidates.begin(), m_NoiseCandidates.end(), key);
+    if (candidate == m_NoiseCandidates.end() || *candidate != key)
+    {
+      continue;
+    }
+
+    // dead towers stay empty and can get pedestal noise like any other empty tower
+    if (m_DeadMap && m_DeadMap->isDeadTower(key))
+    {
+      deadChanEnergy += sim_tower->get_energy();
+
+      if (Verbosity() >= VERBOSITY_MORE)
+      {
+        cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+             << " apply dead tower " << key << endl;
+      }
+      continue;
+    }
+
+    m_NoiseStamp[candidate - m_NoiseCandidates.begin()] = m_EventStamp;
+    nempty--;
+
+    RawTowerZDC *digi_tower = nullptr;
+    if (m_DigiAlgorithm == kNo_digitization)
+    {
+      digi_tower = new RawTowerZDCv1(*sim_tower);
+    }
+    else if (m_DigiAlgorithm == kSimple_photon_digitization)
+    {
+      digi_tower = simple_photon_digitization(sim_tower);
+    }
+    else
+    {
+      digi_tower = sipm_photon_digitization(sim_tower);
+    }
+
+    if (digi_tower)
+    {
+      m_RawTowers->AddTower(key, digi_tower);
+
+      if (Verbosity() >= VERBOSITY_MORE)
+      {
+        cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+             << " output tower:"
+             << endl;
+        digi_tower->identify();
+      }
+    }
+  }
+
+  if (m_DigiAlgorithm == kNo_digitization || nempty == 0 || !(m_NoiseProbability > 0))
+  {
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+
+  // every empty tower passes zero suppression independently with the same probability
+  const unsigned int npass = (m_NoiseProbability >= 1) ? nempty : gsl_ran_binomial(m_RandomGenerator, m_NoiseProbability, nempty);
+
+  if (2 * npass > nempty)
+  {
+    // most empty towers pass, select them in one pass over the candidates (selection sampling)
+    unsigned int needed = npass;
+    unsigned int left = nempty;
+    for (unsigned int i = 0; i < m_NoiseCandidates.size() && needed > 0; i++)
+    {
+      if (m_NoiseStamp[i] == m_EventStamp)
+      {
+        continue;
+      }
+      if (gsl_rng_uniform(m_RandomGenerator) * left < needed)
+      {
+        m_RawTowers->AddTower(m_NoiseCandidates[i], sparse_noise_tower());
+        needed--;
+      }
+      left--;
+    }
+  }
+  else
+  {
+    // pick random towers, skipping the ones with signal or already picked
+    unsigned int picked = 0;
+    while (picked < npass)
+    {
+      const unsigned int i = gsl_rng_uniform_int(m_RandomGenerator, m_NoiseCandidates.size());
+      if (m_NoiseStamp[i] == m_EventStamp)
+      {
+        continue;
+      }
+      m_NoiseStamp[i] = m_EventStamp;
+      m_RawTowers->AddTower(m_NoiseCandidates[i], sparse_noise_tower());
+      picked++;
+    }
+  }
+
+  if (Verbosity() >= 2)
+  {
+    cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+         << " " << npass << " of " << nempty << " empty towers passed zero suppression" << endl;
+  }
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+RawTowerZDC *
+RawTowerZDCDigitizer::sparse_noise_tower()
+{
+  // pedestal under the condition that it passes zero suppression, the upper gaussian tail above m_NoiseThreshold
+  const double pedestal = m_PedestalCentralADC + ((m_PedestalWidthADC > 0) ? gsl_ran_gaussian_tail(m_RandomGenerator, m_NoiseThreshold - m_PedestalCentralADC, m_PedestalWidthADC) : 0);
+  const int sum_ADC = (int) pedestal;
+
+  RawTowerZDC *digi_tower = new RawTowerZDCv1();
+  digi_tower->set_energy((double) sum_ADC);
+  return digi_tower;
+}
+
+int RawTowerZDCDigitizer::batch_digitization(const unsigned long long event, double &deadChanEnergy)
+{
+  if (m_DigiAlgorithm != kNo_digitization && m_DigiAlgorithm != kSimple_photon_digitization && m_DigiAlgorithm != kSiPM_photon_digitization)
+  {
+    cout << Name() << "::" << m_Detector << "::" << __PRETTY_FUNCTION__
+         << " invalid digitization algorithm #" << m_DigiAlgorithm
+         << endl;
+
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  const unsigned long long event_stream = counter_hash(m_Seed, event);
+  const unsigned int ntowers = m_NoiseCandidates.size();
+
+  // gather the sim towers into the tower arrays, dead towers stay empty
+  std::fill(m_BatchEnergy.begin(), m_BatchEnergy.end(), 0.);
+  std::fill(m_BatchSimTower.begin(), m_BatchSimTower.end(), nullptr);
+  if (m_DeadMap)
+  {
+    m_DeadMap->maskDeadTowers(m_NoiseCandidates, m_BatchDead);
+  }
+  else
+  {
+    m_BatchDead.assign(ntowers, 0);
+  }
+  RawTowerZDCContainer::ConstRange begin_end = m_SimTowers->getTowers();
+  for (RawTowerZDCContainer::ConstIterator it = begin_end.first; it != begin_end.second; ++it)
+  {
+    std::vector<RawTowerZDCDefs::keytype>::const_iterator candidate = lower_bound(m_NoiseCandidates.begin(), m_NoiseCandidates.end(), it->first);
+    if (candidate == m_NoiseCandidates.end() || *candidate != it->first)
+    {
+      continue;
+    }
+    const unsigned int i = candidate - m_NoiseCandidates.begin();
+    if (m_BatchDead[i])
+    {
+      deadChanEnergy += it->second->get_energy();
+      continue;
+    }
+    m_BatchEnergy[i] = it->second->get_energy();
+    m_BatchSimTower[i] = it->second;
+  }
+
+  if (m_DigiAlgorithm == kNo_digitization)
+  {
+    for (unsigned int i = 0; i < ntowers; i++)
+    {
+      if (m_BatchSimTower[i])
+      {
+        m_RawTowers->AddTower(m_NoiseCandidates[i], new RawTowerZDCv1(*m_BatchSimTower[i]));
+      }
+    }
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+
+  // photon statistics, only for towers with energy. The generator is reseeded from
+  // (seed, event, tower key) so every tower gets its own reproducible sequence
+  for (unsigned int i = 0; i < ntowers; i++)
+  {
+    m_BatchSignal[i] = 0;
+    if (m_BatchEnergy[i] <= 0)
+    {
+      continue;
+    }
+    gsl_rng_set(m_BatchGenerator, counter_hash(event_stream, m_NoiseCandidates[i]));
+    const double photon_count_mean = m_BatchEnergy[i] * m_PhotonElecYieldVisibleGeV;
+    if (m_DigiAlgorithm == kSimple_photon_digitization)
+    {
+      const int photon_count = gsl_ran_poisson(m_BatchGenerator, photon_count_mean);
+      m_BatchSignal[i] = floor(photon_count / m_PhotonElecADC);
+    }
+    else
+    {
+      const double poission_param_per_pixel = photon_count_mean / m_SiPMEffectivePixel;
+      const double prob_activated_per_pixel = gsl_cdf_poisson_Q(0, poission_param_per_pixel);
+      const double active_pixel = gsl_ran_binomial(m_BatchGenerator, prob_activated_per_pixel, m_SiPMEffectivePixel);
+      m_BatchSignal[i] = floor(active_pixel / m_PhotonElecADC);
+    }
+  }
+
+  // pedestals for all towers, a branch free Box-Muller loop over the arrays (vectorizable with a vector math library)
+  const double *ped_central = m_BatchPedCentral.data();
+  const double *ped_width = m_BatchPedWidth.data();
+  const RawTowerZDCDefs::keytype *keys = m_NoiseCandidates.data();
+  double *pedestal = m_BatchPedestal.data();
+  for (unsigned int i = 0; i < ntowers; i++)
+  {
+    const unsigned long long tower_stream = counter_hash(event_stream, keys[i]);
+    const double u1 = counter_uniform(tower_stream, 0);
+    const double u2 = counter_uniform(tower_stream, 1);
+    pedestal[i] = ped_central[i] + ped_width[i] * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+  }
+
+  // ADC sum and zero suppression
+  for (unsigned int i = 0; i < ntowers; i++)
+  {
+    const int sum_ADC = m_BatchSignal[i] + (int) m_BatchPedestal[i];
+    if (sum_ADC > m_BatchZeroSuppression[i])
+    {
+      RawTowerZDC *digi_tower = (m_BatchSimTower[i]) ? new RawTowerZDCv1(*m_BatchSimTower[i]) : new RawTowerZDCv1();
+      digi_tower->set_energy((double) sum_ADC);
+      m_RawTowers->AddTower(m_NoiseCandidates[i], digi_tower);
+    }
+  }
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
 void RawTowerZDCDigitizer::CreateNodes(PHCompositeNode *topNode)
 {
   PHNodeIterator iter(topNode);
@@ -1,11 +1,14 @@
 #ifndef EICZDCRECO_RAWTOWERZDCDIGITIZER_H
 #define EICZDCRECO_RAWTOWERZDCDIGITIZER_H
 
+#include <eiczdcbase/RawTowerZDCDefs.h>
+
 #include <fun4all/SubsysReco.h>
 
 #include <phparameter/PHParameters.h>
 
 #include <string>
+#include <vector>
 
 class PHCompositeNode;
 class RawTowerZDCContainer;
@@ -29,6 +32,8 @@ class RawTowerZDCDigitizer : public SubsysReco
   int process_event(PHCompositeNode *topNode) override;
   void Detector(const std::string &d) { m_Detector = d; _tower_params.set_name(d);}
   void TowerType(const int type) { m_TowerType = type; }
+  //! seed of the random numbers. In batch digitization it is combined with the event number
+  //! from the EventHeader (the events seen by this module if there is none) and the tower key
   void set_seed(const unsigned int iseed);
   unsigned int get_seed() const { return m_Seed; }
   enum enu_digi_algorithm
@@ -163,6 +168,19 @@ class RawTowerZDCDigitizer : public SubsysReco
   // ! SiPM effective pixel per tower, only used with kSiPM_photon_digitalization
   unsigned int get_sipm_effective_pixel() { return m_SiPMEffectivePixel; }
 
+  //! sparse pedestal noise: only towers with signal are digitized one by one, the number of
+  //! empty towers passing zero suppression is drawn from the pedestal tail probability and
+  //! these towers are picked at random. Same output distribution as the loop over all towers,
+  //! not available with pedestal or zero suppression from file
+  void set_sparse_noise(const bool value) { m_SparseNoise = value; }
+  bool get_sparse_noise() const { return m_SparseNoise; }
+
+  //! batch digitization: all towers of the event are digitized in arrays, with random numbers
+  //! derived from (seed, event number, tower key) instead of one shared generator, so the result does
+  //! not depend on the tower order. Takes precedence over the sparse noise mode
+  void set_batch_digitization(const bool value) { m_BatchDigitization = value; }
+  bool get_batch_digitization() const { return m_BatchDigitization; }
+
  private:
   void CreateNodes(PHCompositeNode *topNode);
 
@@ -175,6 +193,15 @@ class RawTowerZDCDigitizer : public SubsysReco
   //! this function use the effective pixel to count for the effect that the sipm is not evenly lit
   RawTowerZDC *sipm_photon_digitization(RawTowerZDC *sim_tower);
 
+  //! sparse mode of process_event, the cost scales with the number of towers with signal
+  int sparse_digitization(double &deadChanEnergy);
+
+  //! pedestal only tower for an empty tower which passed zero suppression
+  RawTowerZDC *sparse_noise_tower();
+
+  //! batch mode of process_event
+  int batch_digitization(const unsigned long long event, double &deadChanEnergy);
+
   enu_digi_algorithm m_DigiAlgorithm;
 
   RawTowerZDCContainer *m_SimTowers;
@@ -219,6 +246,40 @@ class RawTowerZDCDigitizer : public SubsysReco
   PHParameters _tower_params;
 
   gsl_rng *m_RandomGenerator;
+
+  //! sparse pedestal noise
+  bool m_SparseNoise;
+
+  //! towers to digitize (geometry towers of the selected type), sorted by key
+  std::vector<RawTowerZDCDefs::keytype> m_NoiseCandidates;
+
+  //! event stamp per candidate, set when the tower got signal or noise in this event
+  std::vector<unsigned int> m_NoiseStamp;
+  unsigned int m_EventStamp;
+
+  //! the pedestal of an empty tower passes zero suppression above this value, with this probability
+  double m_NoiseThreshold;
+  double m_NoiseProbability;
+
+  //! batch digitization
+  bool m_BatchDigitization;
+
+  //! events seen by this module, key of the batch random numbers in place of the event number without EventHeader
+  unsigned long long m_EventCounter;
+
+  //! generator for the photon statistics of one tower, reseeded from (seed, event, tower key)
+  gsl_rng *m_BatchGenerator;
+
+  //! per tower arrays in the order of m_NoiseCandidates (the towers to digitize)
+  std::vector<double> m_BatchPedCentral;
+  std::vector<double> m_BatchPedWidth;
+  std::vector<double> m_BatchZeroSuppression;
+  std::vector<double> m_BatchEnergy;
+  std::vector<double> m_BatchPedestal;
+  std::vector<int> m_BatchSignal;
+  std::vector<RawTowerZDC *> m_BatchSimTower;
+  //! dead tower mask from m_DeadMap
+  std::vector<char> m_BatchDead;
 };
 
 #endif /* G4CALO_RAWTOWERDIGITIZER_H */